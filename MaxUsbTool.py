@@ -12,10 +12,18 @@ Main Functions:
 - compare_binary_files():    Compare two binary files byte-by-byte
 - parse_rpi_hat_eeprom():    Read and parse RPi HAT EEPROM (Python parser)
 - parse_rpi_hat_eeprom_dll():Read and parse RPi HAT EEPROM (C DLL parser - faster)
+- identify_rpi_hat_eeprom(): Read only as much EEPROM as needed to identify the board
+- verify_eeprom_integrity(): Check every atom CRC of the programmed image from one read
+- read_and_parse_eeprom():   Read and parse with I2C reads overlapped with parsing
+- auto_tune_clock():         Pick the fastest I2C clock/latency timer that probes clean
+- get_transfer_stats():      Native transfer counters (polls, retries, wait vs transfer time)
+- program_eeprom_async():    Start program+verify on a native worker thread (pollable/awaitable)
+- MaxUsbGang:                Program/verify the EEPROMs on all MPSSE channels in parallel
 """
 
 
 import ctypes
+import json
 import time
 import os
 from enum import Enum
@@ -32,10 +40,19 @@ NO_ADDRESS                  = 0x40
 I2C_DISABLE_3PHASE_CLOCKING = 0x01
 I2C_ENABLE_DRIVE_ONLY_ZERO  = 0x02
 
+#Default channel settings and auto-tune steps (ClockRate in Hz, LatencyTimer in ms), fastest first
+DEFAULT_CLOCK_RATE          = 400000
+DEFAULT_LATENCY_TIMER       = 25
+AUTO_TUNE_STEPS             = [(1000000, 1), (400000, 1), (400000, 25), (100000, 25)]
+AUTO_TUNE_CACHE_FILE        = 'i2c_tuning_cache.json'
+DEFAULT_EEPROM_PART         = '24C32'
+VERIFY_MISMATCH_STATUS      = -13   # XFER_ERROR_VERIFY_MISMATCH, also used without the native engine
+
 class Channel():
 	def __init__(self, name, index):
 		self.name = name
 		self.index = index
+		self.serial = ''
 		self.handle = ctypes.c_void_p()
 
 		
@@ -86,9 +103,30 @@ class FT_STATUS(Enum):
 def status(code):
 	return FT_STATUS(code).name
 
+def transfer_status(code):
+	"""Name an FT_STATUS or a native transfer engine (XFER_ERROR_*) code."""
+	if code >= 0:
+		return status(code)
+	from rpihatparser.i2c_transfer_wrapper import get_transfer_error_message
+	return get_transfer_error_message(code)
+
 class MaxUsbTool:
-	def __init__(self):
+	def __init__(self, auto_tune=False, eeprom_part=DEFAULT_EEPROM_PART):
+		"""
+		Open channel A and find the EEPROM.
+		
+		Args:
+			auto_tune: Pick the channel clock and latency timer with auto_tune_clock()
+			           instead of the fixed 400 kHz / 25 ms defaults
+			eeprom_part: EEPROM part from the native geometry table (e.g. '24C256'), see set_eeprom_part()
+		"""
 		script_dir = os.path.dirname(os.path.abspath(__file__))
+		self.tuning_cache_path = os.path.join(script_dir, AUTO_TUNE_CACHE_FILE)
+		self.clock_rate = DEFAULT_CLOCK_RATE
+		self.latency_timer = DEFAULT_LATENCY_TIMER
+		self.eeprom_part = DEFAULT_EEPROM_PART
+		self.page_size = 32  # 24C32 EEPROM has 32-byte pages
+		self.eeprom_capacity = 4096
 		dll_path = os.path.join(script_dir, 'libmpsse.dll')
 		self.libMPSSE = ctypes.cdll.LoadLibrary(dll_path)
 		self.slave_address = 0x0
@@ -129,19 +167,234 @@ class MaxUsbTool:
 		print(f'Getting info for channel with index {self.channel.index}...')
 		ret = self.libMPSSE.I2C_GetChannelInfo(self.channel.index, ctypes.byref(channel_info))
 		print(f'Channel description: {channel_info.Description.decode()} (status {status(ret)})')
+		self.channel.serial = channel_info.SerialNumber.decode()
 		ret = self.libMPSSE.I2C_OpenChannel(self.channel.index, ctypes.byref(self.channel.handle))
 		print(f'Channel {self.channel.name} opened with handle: 0x{self.channel.handle.value:x} (status {status(ret)})')
-		channel_conf = ChannelConfig(400000, 25, 0)
-		ret = self.libMPSSE.I2C_InitChannel(self.channel.handle, ctypes.byref(channel_conf))
+		ret = self._init_channel(DEFAULT_CLOCK_RATE, DEFAULT_LATENCY_TIMER)
 		print(f'InitChannel() {self.channel.name} (status {status(ret)})')
 		
 		time.sleep(0.1)
 
+		self.native = self._load_native_engine(dll_path)
+
 		self.slave_address = self.scan_eeprom_devices()
 		if self.slave_address is None:
 			self.libMPSSE.I2C_CloseChannel(self.channel.handle)
 			raise RuntimeError('ERROR: No EEPROM found in range 0x50-0x57. Please check connections and ensure EEPROM is powered.')
 
+		if self.native is not None:
+			self.native.slave_address = self.slave_address
+
+		if eeprom_part != DEFAULT_EEPROM_PART:
+			self.set_eeprom_part(eeprom_part)
+
+		if auto_tune:
+			self.auto_tune_clock()
+
+	def set_eeprom_part(self, part):
+		"""
+		Select the EEPROM geometry (page size, address width, capacity, tWR).
+		
+		Writes then use the largest page the part allows, e.g. 64-byte pages
+		on a 24C256 and 256-byte pages on a 24CM02. Needs the native transfer
+		engine for anything other than the 24C32 defaults.
+		
+		Args:
+			part: Part family such as '24C32', '24C64', '24C256' or '24CM02'
+		
+		Returns:
+			int: 0 on success, error code on failure
+		"""
+		if self.native is None:
+			if part.upper() == DEFAULT_EEPROM_PART:
+				return 0
+			print(f'Error: EEPROM part {part} needs the native transfer engine')
+			return -1
+
+		ret = self.native.set_geometry(part)
+		if ret != 0:
+			print(f'Error: Unknown EEPROM part {part}')
+			return ret
+
+		self.eeprom_part = part.upper()
+		self.page_size = self.native.page_size
+		self.eeprom_capacity = self.native.capacity
+		print(f'EEPROM part {self.eeprom_part}: {self.eeprom_capacity} bytes, {self.page_size}-byte pages')
+		return 0
+
+	def _init_channel(self, clock_rate, latency_timer):
+		"""(Re)initialize the open channel with a clock rate and latency timer; returns FT_STATUS."""
+		channel_conf = ChannelConfig(clock_rate, latency_timer, 0)
+		ret = self.libMPSSE.I2C_InitChannel(self.channel.handle, ctypes.byref(channel_conf))
+		if ret == 0:
+			self.clock_rate = clock_rate
+			self.latency_timer = latency_timer
+		return ret
+
+	def probe_link(self, start_addr=0x00, length=256, rounds=8):
+		"""
+		Check that the current channel settings read the EEPROM reliably.
+		
+		Reads the same block several times; every read must succeed and
+		return identical data. If the block holds a HAT image, every atom
+		that is complete inside the block must also pass its CRC check.
+		
+		Args:
+			start_addr: EEPROM address of the probe block
+			length: Probe block size in bytes
+			rounds: Number of reads
+		
+		Returns:
+			bool: True if the probe saw no errors
+		"""
+		reference = None
+		for _ in range(rounds):
+			ret, data = self._read_block(start_addr, length)
+			if ret != 0 or data is None or len(data) != length:
+				return False
+			data = bytes(data)
+			if reference is None:
+				reference = data
+			elif data != reference:
+				return False
+
+		if reference[:4] == b'R-Pi' and length >= 12:
+			try:
+				from rpihatparser import IncrementalParser, PARSE_FLAG_VERIFY_CRC, STREAM_NEED_MORE, STREAM_COMPLETE
+			except (ImportError, OSError, AttributeError):
+				return True
+			# Sized for the whole image, so the atoms inside the block are checked and the
+			# rest just reads as not yet fed; an eeplen beyond the part fails the header
+			eeplen = int.from_bytes(reference[8:12], 'little')
+			parser = IncrementalParser(max(length, min(eeplen, self.eeprom_capacity)), flags=PARSE_FLAG_VERIFY_CRC)
+			if parser.feed(reference) not in (STREAM_NEED_MORE, STREAM_COMPLETE):
+				return False
+			if parser.integrity.atoms_failed:
+				return False
+
+		return True
+
+	def _load_tuning_cache(self):
+		try:
+			with open(self.tuning_cache_path, 'r') as f:
+				return json.load(f)
+		except (OSError, ValueError):
+			return {}
+
+	def _save_tuning_cache(self, cache):
+		try:
+			with open(self.tuning_cache_path, 'w') as f:
+				json.dump(cache, f, indent=4, sort_keys=True)
+		except OSError as e:
+			print(f'  Could not save tuning cache: {e}')
+
+	def auto_tune_clock(self, use_cache=True):
+		"""
+		Select the fastest channel settings that pass probe_link().
+		
+		Walks AUTO_TUNE_STEPS from 1 MHz with a 1 ms latency timer downwards
+		and stops at the first step whose probe is clean. The result is
+		cached per channel serial number in AUTO_TUNE_CACHE_FILE; later runs
+		start from the cached step and only step further down if the probe
+		now fails. If no step passes, the 400 kHz / 25 ms defaults are restored.
+		
+		Args:
+			use_cache: Start from the cached step for this adapter if there is one
+		
+		Returns:
+			tuple: (clock_rate, latency_timer) in use
+		"""
+		cache = self._load_tuning_cache()
+		serial = self.channel.serial
+		steps = list(AUTO_TUNE_STEPS)
+
+		cached = cache.get(serial) if (use_cache and serial) else None
+		if cached is not None:
+			cached_step = (cached.get('clock_rate'), cached.get('latency_timer'))
+			if cached_step in steps:
+				steps = steps[steps.index(cached_step):]
+			else:
+				steps.insert(0, cached_step)
+
+		print(f'\nAuto-tuning I2C clock for adapter {serial or "(no serial)"}...')
+		self._wait_ready(0.01)
+
+		for clock_rate, latency_timer in steps:
+			ret = self._init_channel(clock_rate, latency_timer)
+			if ret == 0 and self.probe_link():
+				print(f'  Using {clock_rate // 1000} kHz, latency timer {latency_timer} ms')
+				if serial and cached != {'clock_rate': clock_rate, 'latency_timer': latency_timer}:
+					cache[serial] = {'clock_rate': clock_rate, 'latency_timer': latency_timer}
+					self._save_tuning_cache(cache)
+				return (clock_rate, latency_timer)
+			print(f'  {clock_rate // 1000} kHz, latency timer {latency_timer} ms: errors, stepping down')
+
+		print('  No setting probed clean, keeping the defaults')
+		self._init_channel(DEFAULT_CLOCK_RATE, DEFAULT_LATENCY_TIMER)
+		return (self.clock_rate, self.latency_timer)
+
+	def _load_native_engine(self, libmpsse_path):
+		"""
+		Load the native transfer engine from the rpihatparser DLL.
+		
+		Returns:
+			NativeEeprom bound to the open channel, or None to use the ctypes path
+		"""
+		try:
+			from rpihatparser.i2c_transfer_wrapper import NativeEeprom, load_mpsse, XFER_OK
+		except (ImportError, OSError, AttributeError) as e:
+			print(f'Native transfer engine unavailable ({e}), using ctypes transfers')
+			return None
+
+		if load_mpsse(libmpsse_path) != XFER_OK:
+			print('Native transfer engine could not bind libMPSSE, using ctypes transfers')
+			return None
+
+		print('Using native transfer engine')
+		return NativeEeprom(self.channel.handle, self.slave_address)
+
+	def _wait_ready(self, fallback_delay):
+		"""
+		Wait until the EEPROM is idle before a read.
+		
+		ACK-polls with the native engine (returning as soon as any write cycle
+		completes); without it, sleeps for the fixed fallback_delay in seconds.
+		"""
+		if self.native is not None:
+			return self.native.wait_ready()
+		time.sleep(fallback_delay)
+		return 0
+
+	def enable_transfer_stats(self, enabled=True):
+		"""
+		Start or stop collecting native transfer counters and latency histograms.
+		
+		Returns:
+			bool: True if the native engine is in use (ctypes transfers are not counted)
+		"""
+		if self.native is None:
+			return False
+		self.native.enable_stats(enabled)
+		return True
+
+	def get_transfer_stats(self):
+		"""
+		Transfer counters since enable_transfer_stats().
+		
+		Returns:
+			dict: transactions, bytes, ACK polls, retries, wait vs transfer time
+			and latency histograms, or None when not enabled
+		"""
+		if self.native is None:
+			return None
+		return self.native.stats()
+
+	def _read_block(self, start_addr, num_bytes):
+		"""Read a block with the native engine when available, else read_register_16bit()."""
+		if self.native is not None:
+			return self.native.read(start_addr, num_bytes)
+		return self.read_register_16bit(start_addr, num_bytes)
+
 	def __del__(self):
 		if hasattr(self, 'channel'):
 			ret = self.libMPSSE.I2C_CloseChannel(self.channel.handle)
@@ -158,6 +411,14 @@ class MaxUsbTool:
 			int: First EEPROM address found, or None if no device found
 		"""
 		print('\nScanning for EEPROM devices (0x50-0x57)...')
+
+		found = self._scan_native(0x50, 0x57)
+		if found is not None:
+			if found:
+				print(f'Using EEPROM at address 0x{found[0]:02x}\n')
+				return found[0]
+			print('No EEPROM devices found in range 0x50-0x57\n')
+			return None
 		
 		for addr in range(0x50, 0x58):
 			test_buf = (ctypes.c_ubyte * 1)()
@@ -184,6 +445,8 @@ class MaxUsbTool:
 		
 		if 0x00 <= address <= 0x7F:
 			self.slave_address = address
+			if getattr(self, 'native', None) is not None:
+				self.native.slave_address = address
 			print(f'Slave address set to 0x{self.slave_address:02x}')
 		else:
 			print(f'Error: Invalid I2C address 0x{address:02x}. Must be 0x00-0x7F')
@@ -255,6 +518,22 @@ class MaxUsbTool:
 		data = list(read_buf[:bytes_read.value])
 		return (ret, data)
 
+	def _scan_native(self, first_addr, last_addr):
+		"""
+		Probe an address range with one call into the native engine.
+		
+		Returns:
+			list: Addresses that ACKed, or None if the native engine is not loaded
+		"""
+		if getattr(self, 'native', None) is None:
+			return None
+
+		from rpihatparser.i2c_transfer_wrapper import bus_scan, bitmap_addresses
+		ret, bitmap = bus_scan(self.channel.handle, first_addr, last_addr)
+		if ret != 0:
+			return None
+		return bitmap_addresses(bitmap)
+
 	def scan_i2c_devices(self):
 		"""
 		Scan for I2C devices on the bus.
@@ -263,17 +542,21 @@ class MaxUsbTool:
 			list: List of I2C addresses where devices were found
 		"""
 		print(f'\nScanning for I2C devices on channel {self.channel.name}...')
-		devices_found = []
-
-		for addr in range(0x08, 0x78):
-			test_buf = (ctypes.c_ubyte * 1)()
-			transferred = ctypes.c_ulong()
-			test_mode = START_BIT | STOP_BIT
-			ret = self.libMPSSE.I2C_DeviceRead(self.channel.handle, addr, 1, test_buf, 
-										ctypes.byref(transferred), test_mode)
-			if ret == 0:
-				devices_found.append(addr)
-				print(f'  Found device at address 0x{addr:02x} (decimal {addr})')
+		devices_found = self._scan_native(0x08, 0x77)
+
+		if devices_found is None:
+			devices_found = []
+			for addr in range(0x08, 0x78):
+				test_buf = (ctypes.c_ubyte * 1)()
+				transferred = ctypes.c_ulong()
+				test_mode = START_BIT | STOP_BIT
+				ret = self.libMPSSE.I2C_DeviceRead(self.channel.handle, addr, 1, test_buf, 
+											ctypes.byref(transferred), test_mode)
+				if ret == 0:
+					devices_found.append(addr)
+
+		for addr in devices_found:
+			print(f'  Found device at address 0x{addr:02x} (decimal {addr})')
 
 		if not devices_found:
 			print('  No I2C devices found on the bus')
@@ -303,8 +586,8 @@ class MaxUsbTool:
 
 		max_attempts = 6
 		for attempt in range(max_attempts):
-			time.sleep(0.2)
-			ret, data_list = self.read_register_16bit(start_addr, read_size)
+			self._wait_ready(0.2)
+			ret, data_list = self._read_block(start_addr, read_size)
 			
 			if ret == 0 and data_list is not None and len(data_list) >= 4:
 				signature = bytes(data_list[0:4])
@@ -383,20 +666,33 @@ class MaxUsbTool:
 			print(f'\n[ERROR] Found {len(mismatches)} byte differences out of {min_len} bytes')
 			print(f'Match rate: {((min_len - len(mismatches)) / min_len * 100):.1f}%')
 
-	def write_eeprom_from_file(self, start_addr, filename):
+	def write_eeprom_from_file(self, start_addr, filename, differential=False, verify=False):
 		"""
 		Write data from a binary file to EEPROM.
-		Uses 16-bit addressing and page writes for efficiency.
+		Uses page writes with the geometry of the selected part
+		(eeprom_part, see set_eeprom_part): its page size, address width and
+		capacity. The default 24C32 has 4 KB, 32-byte pages and 16-bit addresses.
 		
-		IMPORTANT: For 24C32 EEPROM (4KB, 32-byte pages):
-		- Page size: 32 bytes
-		- Write cycle time: 5ms typical, 10ms max
+		IMPORTANT:
+		- Write cycle time: the part's tWR (5ms typical, 10ms max on the 24C32)
 		- WP pin must be LOW to allow writes
-		- If WP pin is HIGH, upper half (0x800-0xFFF) is write-protected
+		- If WP pin is HIGH, the protected range depends on the part (upper half,
+		  0x800-0xFFF, on the 24C32)
+		
+		Differential mode (native engine only) skips the erase, reads the current
+		contents once and rewrites only the pages that differ from the
+		image. Reflashing a board where only a custom atom changed then touches
+		a few pages instead of the whole EEPROM.
+		
+		With verify, the native engine reads each page back as soon as its
+		write cycle completes and rewrites only the pages that differ, so no
+		separate verify_eeprom_write() pass is needed.
 		
 		Args:
 			start_addr: Starting register address (usually 0x00)
 			filename: Input filename containing binary data to write
+			differential: Rewrite only the pages that differ from the EEPROM
+			verify: Check the written image (status VERIFY_MISMATCH_STATUS if it differs)
 		
 		Returns:
 			tuple: (status_code, bytes_written)
@@ -408,18 +704,73 @@ class MaxUsbTool:
 			print(f'Error: File "{filename}" not found')
 			return (1, 0)
 
+		return self.write_eeprom_data(start_addr, data, differential, source=filename, verify=verify)
+
+	def write_eeprom_data(self, start_addr, data, differential=False, source='memory', verify=False):
+		"""
+		Write an in-memory image to EEPROM (see write_eeprom_from_file()).
+		
+		Args:
+			start_addr: Starting register address (usually 0x00)
+			data: Image bytes
+			differential: Rewrite only the pages that differ from the EEPROM
+			source: Label used in progress messages
+			verify: Check the written image (see write_eeprom_from_file())
+		
+		Returns:
+			tuple: (status_code, bytes_written)
+		"""
 		original_size = len(data)
 		padded_size = max(256, ((original_size + 255) // 256) * 256)
+		padded_size = max(original_size, min(padded_size, self.eeprom_capacity - start_addr))
 		if padded_size > original_size:
-			data = data + bytes([0xFF] * (padded_size - original_size))
-			print(f'\nWriting {original_size} bytes (padded to {padded_size} bytes) from {filename} to EEPROM at address 0x{self.slave_address:02x}...')
+			data = bytes(data) + bytes([0xFF] * (padded_size - original_size))
+			print(f'\nWriting {original_size} bytes (padded to {padded_size} bytes) from {source} to EEPROM at address 0x{self.slave_address:02x}...')
 		else:
-			print(f'\nWriting {len(data)} bytes from {filename} to EEPROM at address 0x{self.slave_address:02x}...')
+			print(f'\nWriting {len(data)} bytes from {source} to EEPROM at address 0x{self.slave_address:02x}...')
 
-		page_size = 32  # 24C32 EEPROM has 32-byte pages
+		page_size = self.page_size
 		total_written = 0
 
+		if differential and self.native is None:
+			print('  [INFO] Differential write needs the native transfer engine, writing the full image')
+		elif differential:
+			ret, pages_written = self.native.write_diff(start_addr, data)
+			if ret != 0:
+				print(f'\n  Error writing EEPROM (status {transfer_status(ret)})')
+				return (ret, 0)
+			total_pages = (start_addr % page_size + len(data) + page_size - 1) // page_size
+			print(f'  Rewrote {pages_written} of {total_pages} pages, {total_pages - pages_written} already matched')
+			if verify and not self.verify_eeprom_data(start_addr, data):
+				return (VERIFY_MISMATCH_STATUS, original_size)
+			return (0, original_size)
+
 		self.erase_evb_eeprom(padded_size)
+
+		if self.native is not None and verify:
+			ret, failed_pages, pages_retried, mismatches = self.native.program_verify(start_addr, data)
+			if pages_retried:
+				print(f'  Rewrote {pages_retried} pages that failed their readback')
+			if ret == VERIFY_MISMATCH_STATUS:
+				pages = [page for page in range(failed_pages.bit_length()) if failed_pages >> page & 1]
+				print(f'[ERROR] Verification failed! {mismatches} bytes differ in pages {pages}')
+				return (ret, original_size)
+			if ret != 0:
+				print(f'\n  Error writing EEPROM (status {transfer_status(ret)})')
+				return (ret, 0)
+			print(f'  Progress: 100.0%')
+			print(f'[OK] Wrote and verified {original_size} bytes (padded to {len(data)} bytes), page by page')
+			return (0, original_size)
+
+		if self.native is not None:
+			ret = self.native.write(start_addr, data)
+			if ret != 0:
+				print(f'\n  Error writing EEPROM (status {transfer_status(ret)})')
+				return (ret, 0)
+			print(f'  Progress: 100.0%')
+			print(f'  Successfully wrote {original_size} bytes to EEPROM (padded to {len(data)} bytes)')
+			return (0, original_size)
+
 		time.sleep(0.1)
 
 		addr = start_addr
@@ -464,31 +815,66 @@ class MaxUsbTool:
 
 		print(f'  Progress: 100.0%')
 		print(f'  Successfully wrote {original_size} bytes to EEPROM (padded to {len(data)} bytes)')
+
+		if verify and not self.verify_eeprom_data(start_addr, data):
+			return (VERIFY_MISMATCH_STATUS, original_size)
 		
 		return (0, original_size)
 
 
-	def verify_eeprom_write(self, start_addr, filename):
+	def verify_eeprom_write(self, start_addr, filename=None):
 		"""
 		Verify that EEPROM contents match the file.
 		
+		Without a filename, the image is instead checked against its own atom
+		CRCs from a single read (see verify_eeprom_integrity()).
+		
 		Args:
 			start_addr: Starting address
-			filename: File to compare against
+			filename: File to compare against, or None for a CRC integrity check
 		
 		Returns:
 			bool: True if verification passed, False otherwise
 		"""
+		if filename is None:
+			ret, _ = self.verify_eeprom_integrity(start_addr)
+			return ret == 0
+
 		try:
 			with open(filename, 'rb') as f:
 				original_data = f.read()
 		except FileNotFoundError:
 			print(f'Error: File "{filename}" not found')
 			return False
+
+		return self.verify_eeprom_data(start_addr, original_data)
+
+	def verify_eeprom_data(self, start_addr, original_data):
+		"""
+		Verify that EEPROM contents match an in-memory image.
 		
+		Returns:
+			bool: True if verification passed, False otherwise
+		"""
 		print(f'\nVerifying {len(original_data)} bytes...')
 
 		max_attempts = 6
+		if self.native is not None:
+			for attempt in range(max_attempts):
+				self._wait_ready(1.0)
+				ret, mismatch_count, first_mismatch = self.native.verify(start_addr, original_data)
+				if ret == 0:
+					print(f'[OK] Verification passed! All {len(original_data)} bytes match.')
+					return True
+				if attempt < max_attempts - 1:
+					print(f'  Read attempt {attempt + 1} failed (status {transfer_status(ret)}), retrying...')
+
+			if mismatch_count:
+				print(f'[ERROR] Verification failed! {mismatch_count} bytes differ, first at address 0x{start_addr + first_mismatch:04x}')
+			else:
+				print(f'  Error reading EEPROM (status {transfer_status(ret)})')
+			return False
+
 		for attempt in range(max_attempts):
 			time.sleep(1.0)
 			
@@ -522,22 +908,134 @@ class MaxUsbTool:
 			return False
 
 
-	def erase_evb_eeprom(self, bytes_to_erase=256):
+	def program_eeprom_async(self, start_addr, data, verify=True, differential=False, callback=None):
+		"""
+		Start programming (and verifying) an image without blocking.
+		
+		The image is padded with 0xFF like write_eeprom_data(), so the padding
+		takes the place of the separate erase. The write and the ACK-polled
+		readback run on a native worker thread; drive many fixtures from one
+		asyncio loop with `status, job, _ = await tool.program_eeprom_async(...)`.
+		Do not use this tool for other transfers until the operation completes.
+		
+		Args:
+			start_addr: Starting address
+			data: Image bytes
+			verify: Read the image back after programming
+			differential: Rewrite only the pages that differ from the EEPROM
+			callback: Called with the transfer on the worker thread when it completes
+		
+		Returns:
+			AsyncTransfer (see rpihatparser.i2c_transfer_wrapper), or None without the native engine
+		"""
+		if self.native is None:
+			print('Error: Asynchronous programming needs the native transfer engine')
+			return None
+
+		original_size = len(data)
+		padded_size = max(256, ((original_size + 255) // 256) * 256)
+		padded_size = max(original_size, min(padded_size, self.eeprom_capacity - start_addr))
+		if padded_size > original_size:
+			data = bytes(data) + bytes([0xFF] * (padded_size - original_size))
+		return self.native.program_async(start_addr, data, verify, differential, callback=callback)
+
+	def read_eeprom_async(self, start_addr, size, callback=None):
+		"""
+		Start reading a range without blocking.
+		
+		Returns:
+			AsyncTransfer whose result is (status, job, data), or None without the native engine
+		"""
+		if self.native is None:
+			print('Error: Asynchronous reads need the native transfer engine')
+			return None
+		return self.native.read_async(start_addr, size, callback=callback)
+
+	def verify_eeprom_integrity(self, start_addr=0x00, size=4096):
+		"""
+		Check a programmed RPi HAT image against its own atom CRCs.
+		
+		Waits for any write cycle to finish, reads the 12-byte header to learn
+		eeplen, reads the rest of the image once and has the DLL parser verify
+		every atom's CRC16. No source file or repeated readback is needed.
+		
+		Args:
+			start_addr: Starting register address (usually 0x00)
+			size: Upper bound on the image size (EEPROM size)
+		
+		Returns:
+			tuple: (status_code, ParseIntegrity or None); 0 means every atom passed
+		"""
+		try:
+			from rpihatparser import (parse_rpi_hat_eeprom_ex, PARSE_OK, PARSE_ERROR_CRC_MISMATCH,
+									  get_parse_error_message)
+		except (ImportError, OSError, AttributeError) as e:
+			print(f'Error: Could not import DLL parser: {e}')
+			return (-1, None)
+
+		self._wait_ready(1.0)
+
+		ret, header = self._read_block(start_addr, 12)
+		if ret != 0 or len(header) < 12:
+			print(f'Error reading EEPROM header (status {transfer_status(ret)})')
+			return (ret if ret != 0 else 1, None)
+
+		eeplen = int.from_bytes(bytes(header[8:12]), 'little')
+		image_len = min(max(eeplen, 12), size)
+		ret, body = self._read_block(start_addr + 12, image_len - 12) if image_len > 12 else (0, b'')
+		if ret != 0:
+			print(f'Error reading EEPROM (status {transfer_status(ret)})')
+			return (ret, None)
+
+		status_code, result, integrity = parse_rpi_hat_eeprom_ex(bytes(header) + bytes(body))
+		if status_code not in (PARSE_OK, PARSE_ERROR_CRC_MISMATCH):
+			print(f'[ERROR] {get_parse_error_message(status_code)}')
+			return (status_code, integrity)
+
+		for atom in range(integrity.atoms_checked):
+			if not integrity.atom_ok(atom):
+				print(f'  Atom {atom}: CRC mismatch')
+
+		if status_code == PARSE_OK:
+			print(f'[OK] Integrity check passed! All {integrity.atoms_checked} atoms have valid CRCs ({image_len} bytes read).')
+		else:
+			print(f'[ERROR] Integrity check failed! {integrity.atoms_failed} of {integrity.atoms_checked} atoms have bad CRCs.')
+		return (status_code, integrity)
+
+
+	def erase_evb_eeprom(self, bytes_to_erase=256, skip_blank=True):
 		"""
 		Erase EEPROM by writing 0xFF to all bytes.
 		
+		With the native engine each page is one transaction from a static
+		0xFF page, and with skip_blank the range is read first so pages that
+		are already blank are not rewritten.
+		
 		Args:
-			bytes_to_erase: Number of bytes to erase (default: 256)
+			bytes_to_erase: Number of bytes to erase (default: 256), 0 = whole part
+			skip_blank: Skip pages that already read back as all 0xFF (native engine only)
 		
 		Returns:
 			int: 0 on success, error code on failure
 		"""
+		if bytes_to_erase == 0:
+			bytes_to_erase = self.eeprom_capacity
 		print(f'\nErasing {bytes_to_erase} bytes of EEPROM at address 0x{self.slave_address:02x}...')
+
+		if self.native is not None:
+			ret, pages_written = self.native.erase(0x00, bytes_to_erase, skip_blank)
+			if ret != 0:
+				print(f'\n  Error erasing EEPROM (status {transfer_status(ret)})')
+				return ret
+			total_pages = (bytes_to_erase + self.page_size - 1) // self.page_size
+			print(f'[OK] Successfully erased {bytes_to_erase} bytes ({pages_written} of {total_pages} pages written)')
+			return 0
 		
-		erase_data = bytes([0xFF] * bytes_to_erase)
-		
-		page_size = 32
+		page_size = self.page_size
 		total_written = 0
+
+		# One 0xFF page buffer for the whole erase; only the address bytes change
+		write_buf = (ctypes.c_ubyte * (2 + page_size))(*([0] * 2 + [0xFF] * page_size))
 		
 		addr = 0x00
 		while addr < bytes_to_erase:
@@ -548,11 +1046,8 @@ class MaxUsbTool:
 			bytes_remaining_total = bytes_to_erase - addr
 			bytes_to_write = min(bytes_remaining_in_page, bytes_remaining_total)
 
-			write_buf = (ctypes.c_ubyte * (2 + bytes_to_write))()
 			write_buf[0] = (addr >> 8) & 0xFF
 			write_buf[1] = addr & 0xFF
-			for i in range(bytes_to_write):
-				write_buf[2 + i] = 0xFF
 
 			bytes_written = ctypes.c_ulong()
 			ret = self.libMPSSE.I2C_DeviceWrite(
@@ -616,6 +1111,21 @@ class MaxUsbTool:
 			print(f'Error reading EEPROM (status {status(ret)})')
 			return ret
 
+		return self.parse_rpi_hat_image(eeprom_data)
+
+
+	@staticmethod
+	def parse_rpi_hat_image(eeprom_data):
+		"""
+		Parse and display a Raspberry Pi HAT EEPROM image already in memory.
+		
+		Args:
+			eeprom_data: EEPROM contents (list, bytes or bytearray)
+		
+		Returns:
+			int: status_code (0 for success, -1 for an unsupported version)
+		"""
+		ret = 0
 		signature = bytes(eeprom_data[0:4])
 		print(f'EEPROM Signature: {signature}')
 
@@ -733,18 +1243,22 @@ class MaxUsbTool:
 		"""
 		try:
 			from rpihatparser import parse_and_print_eeprom, PARSE_OK, get_parse_error_message
-		except ImportError as e:
+		except (ImportError, OSError, AttributeError) as e:
 			print(f'Error: Could not import DLL parser: {e}')
-			print('Make sure the rpihatparser folder with rpi_hat_parser.dll is in the same directory.')
+			print('Make sure the rpihatparser folder with the built rpi_hat_parser library is in the same directory.')
 			print('Falling back to Python parser...\n')
 			return self.parse_rpi_hat_eeprom(start_addr, size)
 		
-		# Read EEPROM data
-		ret, eeprom_data = self.read_eeprom_to_file(start_addr, size, should_save=False)
+		# Read EEPROM data (pipelined with parsing and CRC checks when the native engine is loaded)
+		ret, _, integrity, eeprom_data = self.read_and_parse_eeprom(start_addr, size)
 		
-		if ret != 0:
-			print(f'Error reading EEPROM (status {status(ret)})')
+		# Positive FT_STATUS and XFER_ERROR_* codes are read failures; parse errors are reported below
+		if ret > 0 or ret <= -10:
+			print(f'Error reading EEPROM (status {transfer_status(ret)})')
 			return ret
+
+		if integrity is not None and integrity.atoms_failed:
+			print(f'Warning: {integrity.atoms_failed} of {integrity.atoms_checked} atoms failed their CRC check')
 		
 		# Parse using the DLL
 		status_code = parse_and_print_eeprom(eeprom_data)
@@ -754,3 +1268,192 @@ class MaxUsbTool:
 			print(f'\n{error_msg}')
 		
 		return status_code
+
+
+	def read_and_parse_eeprom(self, start_addr=0x00, size=4096, block_size=256):
+		"""
+		Read a HAT image and parse it with atom CRC checks.
+		
+		With the native engine the next block is read over I2C while the
+		previous one is parsed and CRC-checked, and reading stops at the
+		header's eeplen, so the total time is about the I/O time alone.
+		Without it the image is read first and parsed afterwards.
+		
+		Args:
+			start_addr: Starting register address (usually 0x00)
+			size: Upper bound on the number of bytes to read (EEPROM size)
+			block_size: Bytes per I2C read in the pipeline
+		
+		Returns:
+			tuple: (status_code, ParsedEeprom or None, ParseIntegrity or None, bytes read)
+		"""
+		if self.native is not None:
+			self._wait_ready(0.2)
+			ret, data, result, integrity = self.native.read_parse(start_addr, size, block_size)
+			return (ret, result, integrity, data)
+
+		ret, data = self.read_eeprom_to_file(start_addr, size, should_save=False)
+		if ret != 0:
+			return (ret, None, None, b'')
+
+		try:
+			from rpihatparser import parse_rpi_hat_eeprom_ex
+		except (ImportError, OSError, AttributeError):
+			return (0, None, None, data)
+
+		ret, result, integrity = parse_rpi_hat_eeprom_ex(data)
+		return (ret, result, integrity, data)
+
+
+	def identify_rpi_hat_eeprom(self, start_addr=0x00, size=4096, min_chunk=16):
+		"""
+		Identify a Raspberry Pi HAT board by reading only the bytes that are needed.
+		
+		Feeds the EEPROM to the DLL's streaming parser one chunk at a time and
+		stops as soon as the vendor info and device tree overlay atoms are
+		complete, instead of reading a full 256-byte-rounded block first.
+		
+		Args:
+			start_addr: Starting register address (usually 0x00)
+			size: Upper bound on the number of bytes to read (EEPROM size)
+			min_chunk: Smallest read issued per I2C transaction
+		
+		Returns:
+			tuple: (status_code, ParsedEeprom or None, bytes_read)
+		"""
+		try:
+			from rpihatparser import (IncrementalParser, PARSE_OK, STREAM_NEED_MORE,
+									  STREAM_WANT_VENDOR_INFO, STREAM_WANT_DT_OVERLAY,
+									  get_parse_error_message)
+		except (ImportError, OSError, AttributeError) as e:
+			print(f'Error: Could not import DLL parser: {e}')
+			return (-1, None, 0)
+
+		parser = IncrementalParser(size, STREAM_WANT_VENDOR_INFO | STREAM_WANT_DT_OVERLAY)
+		state = STREAM_NEED_MORE
+		addr = start_addr
+
+		while state == STREAM_NEED_MORE and parser.bytes_fed < size:
+			chunk_size = min(max(parser.bytes_needed(), min_chunk), size - parser.bytes_fed)
+			ret, chunk = self.read_register_16bit(addr, chunk_size)
+			if ret != 0 or not chunk:
+				print(f'Error reading EEPROM at 0x{addr:04x} (status {status(ret)})')
+				return (ret if ret != 0 else 1, None, parser.bytes_fed)
+			state = parser.feed(chunk)
+			addr += len(chunk)
+
+		status_code = parser.finish()
+		if status_code != PARSE_OK:
+			print(f'{get_parse_error_message(status_code)}')
+			return (status_code, None, parser.bytes_fed)
+
+		result = parser.result
+		print(f'Identified board after reading {parser.bytes_fed} bytes')
+		if result.has_vendor_info:
+			print(f'  Vendor: {result.vendor_info.vendor.decode("utf-8")}')
+			print(f'  Board: {result.vendor_info.product.decode("utf-8")}')
+			print(f'  Product ID: {result.vendor_info.product_id}')
+			print(f'  Product Version: {result.vendor_info.product_version}')
+		if result.has_dt_overlay:
+			print(f'  Overlay: {result.dt_overlay.decode("utf-8")}')
+
+		return (0, result, parser.bytes_fed)
+
+
+class MaxUsbGang:
+	"""
+	Gang programmer for several FTDI adapters (one EEPROM per MPSSE channel).
+	
+	The native engine opens every selected channel and runs the job on a
+	separate thread per channel, so the channels progress concurrently
+	instead of one after another under the GIL. Do not hold a MaxUsbTool
+	instance open on the same channels.
+	"""
+
+	def __init__(self, clock_rate=400000, latency_timer=25, eeprom_part=None, collect_stats=False):
+		script_dir = os.path.dirname(os.path.abspath(__file__))
+		dll_path = os.path.join(script_dir, 'libmpsse.dll')
+		self.libMPSSE = ctypes.cdll.LoadLibrary(dll_path)
+		self.libMPSSE.Init_libMPSSE()
+		self.clock_rate = clock_rate
+		self.latency_timer = latency_timer
+		self.eeprom_part = eeprom_part
+		self.collect_stats = collect_stats
+
+		from rpihatparser import i2c_transfer_wrapper
+		self.engine = i2c_transfer_wrapper
+		if self.engine.load_mpsse(dll_path) != self.engine.XFER_OK:
+			raise RuntimeError('Native transfer engine could not bind libMPSSE')
+
+		ret, self.channel_count = self.engine.multi_channel_count()
+		print(f'Found {self.channel_count} channels (status {transfer_status(ret)})')
+
+	def _run(self, operations, images=None, length=0, start_addr=0x00, channels=None, differential=False):
+		if channels is None:
+			channels = list(range(min(self.channel_count, self.engine.MULTI_MAX_CHANNELS)))
+
+		ret, jobs, data = self.engine.run_multi_channel(channels, operations, images=images, length=length,
+														start_addr=start_addr, clock_rate=self.clock_rate,
+														latency_timer=self.latency_timer,
+														differential=differential, part=self.eeprom_part,
+														collect_stats=self.collect_stats)
+		for job in jobs:
+			result = 'OK' if job.status == 0 else transfer_status(job.status)
+			details = f'{job.elapsed_us / 1000:.1f} ms'
+			if differential and operations & self.engine.MULTI_OP_PROGRAM:
+				details += f', {job.pages_written} pages rewritten'
+			if job.mismatches:
+				details += f', {job.mismatches} bytes differ'
+			if job.stats:
+				stats = job.stats.contents
+				details += (f', {stats.transfer_us / 1000:.1f} ms transfer / {stats.wait_us / 1000:.1f} ms waiting,'
+							f' {stats.poll_retries} poll retries')
+			print(f'  Channel {job.channel_index} (0x{job.slave_address:02x}): {result} ({details})')
+		return (ret, jobs, data)
+
+	def program(self, images, start_addr=0x00, verify=True, differential=False, channels=None):
+		"""
+		Program an image (or one image per channel) on every channel concurrently.
+		
+		Images are padded with 0xFF to a 256-byte multiple like
+		MaxUsbTool.write_eeprom_from_file().
+		
+		Returns:
+			tuple: (status_code, list of ChannelJob results)
+		"""
+		capacity = None
+		if self.eeprom_part is not None:
+			geometry = self.engine.find_geometry(self.eeprom_part)
+			capacity = geometry.contents.capacity - start_addr if geometry else None
+
+		def pad(image):
+			padded_size = max(256, ((len(image) + 255) // 256) * 256)
+			if capacity is not None:
+				padded_size = max(len(image), min(padded_size, capacity))
+			return bytes(image) + bytes([0xFF] * (padded_size - len(image)))
+
+		if isinstance(images, (list, tuple)):
+			images = [pad(image) for image in images]
+		else:
+			images = pad(images)
+
+		operations = self.engine.MULTI_OP_PROGRAM
+		if verify:
+			operations |= self.engine.MULTI_OP_VERIFY
+
+		print(f'\nProgramming {"differentially " if differential else ""}on all channels...')
+		ret, jobs, _ = self._run(operations, images=images, start_addr=start_addr, channels=channels,
+								 differential=differential)
+		return (ret, jobs)
+
+	def verify(self, images, start_addr=0x00, channels=None):
+		"""Verify every channel against an image (or one image per channel); returns (status_code, jobs)."""
+		print('\nVerifying all channels...')
+		ret, jobs, _ = self._run(self.engine.MULTI_OP_VERIFY, images=images, start_addr=start_addr,
+								 channels=channels)
+		return (ret, jobs)
+
+	def read(self, size, start_addr=0x00, channels=None):
+		"""Read size bytes from every channel; returns (status_code, jobs, list of data)."""
+		print(f'\nReading {size} bytes from all channels...')
+		return self._run(self.engine.MULTI_OP_READ, length=size, start_addr=start_addr, channels=channels)
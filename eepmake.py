@@ -17,6 +17,17 @@ import uuid
 import re
 import json
 
+try:
+	from rpihatparser.rpi_hat_parser_wrapper import crc16 as native_crc16
+except (ImportError, OSError, AttributeError):
+	native_crc16 = None
+
+try:
+	from rpihatparser.rpi_hat_builder_wrapper import build_hat_image as native_build_image, ImageTemplate
+	from rpihatparser.rpi_hat_parser_wrapper import find_json_value_span
+except (ImportError, OSError, AttributeError):
+	native_build_image = None
+
 #CONSTANTS
 CRC_LEN = 2
 EEPLEN_INDEX = 8
@@ -582,6 +593,9 @@ class EepMake:
 
 	def calculate_crc16(self, data: bytes) -> int:
 		"""Calculate CRC16 checksum for data using the same algorithm as the C code."""
+		if native_crc16 is not None:
+			return native_crc16(data)
+
 		CRC16_POLY = 0x8005
 		crc_state = 0
 
@@ -674,10 +688,42 @@ class EepMake:
 		"""Write variable data atom."""
 		self.write_complete_atom(fp, atom_type, blob.data)
 
+	def build_image(self) -> bytes:
+		"""Serialize the image in memory with the native builder (requires the rpihatparser DLL)."""
+		if native_build_image is None:
+			raise RuntimeError("Native image builder is not available")
+
+		gpio_bank0 = None
+		if self.has_gpio_bank0:
+			gpio_bank0 = (self.gpiomap_bank0.flags, self.gpiomap_bank0.power, self.gpiomap_bank0.pins)
+		gpio_bank1 = None
+		if self.has_gpio_bank1:
+			gpio_bank1 = (self.gpiomap_bank1.flags, self.gpiomap_bank1.power, self.gpiomap_bank1.pins)
+
+		return native_build_image(self.hat_format, self.vinf.serial, self.vinf.pid, self.vinf.pver,
+								  self.vinf.vstr.encode('utf-8'), self.vinf.pstr.encode('utf-8'),
+								  gpio_bank0=gpio_bank0,
+								  dt_overlay=self.dt_blob.data if self.has_dt else None,
+								  custom_blobs=[blob.data for blob in self.custom_blobs],
+								  gpio_bank1=gpio_bank1,
+								  current_supply_ma=self.power_supply.current_supply if self.has_power_supply else None)
+
 	def write_binary(self, filename: str) -> int:
 		"""Write the binary EEPROM file."""
 		print(f"Writing binary file '{filename}'")
 
+		if native_build_image is not None:
+			if self.has_dt:
+				print("Writing out DT...")
+			try:
+				image = self.build_image()
+				with open(filename, 'wb') as fp:
+					fp.write(image)
+			except Exception as e:
+				print(f"Error writing file {filename}: {e}")
+				return -1
+			return 0
+
 		self.atom_count = 0
 
 		try:
@@ -729,3 +775,66 @@ class EepMake:
 			return -1
 			
 		return 0
+
+
+class EepTemplate:
+	"""
+	Compiled image template for per-board programming.
+
+	The settings text (and optional custom JSON) is parsed and built once.
+	Each board then only needs its UUID patched in place and the vendor
+	atom CRC recomputed; programming through the differential writer
+	rewrites just the EEPROM pages that changed. Requires the rpihatparser
+	DLL.
+	"""
+
+	def __init__(self, settings_file: str, custom_json: Optional[str] = None):
+		if native_build_image is None:
+			raise RuntimeError("EepTemplate needs the native image builder (rpihatparser DLL)")
+
+		self.eep = EepMake()
+		if self.eep.read_text(settings_file):
+			raise ValueError(f"Error reading and parsing {settings_file}")
+		if custom_json is not None and self.eep.read_json_custom_data(custom_json):
+			raise ValueError(f"Error reading custom data from {custom_json}")
+
+		self.template = ImageTemplate(self.eep.build_image())
+
+	@property
+	def image(self) -> bytes:
+		return self.template.image
+
+	def new_board(self, board_uuid: Optional[uuid.UUID] = None) -> bytes:
+		"""Patch in a UUID (random if None) and return the board image."""
+		if board_uuid is None:
+			board_uuid = uuid.uuid4()
+		self.template.set_uuid(board_uuid.bytes)
+		self.eep.vinf.serial = list(struct.unpack('<4I', board_uuid.bytes))
+		return self.template.image
+
+	def set_custom_value(self, key: str, value, blob_index: int = 0):
+		"""
+		Change one top-level field of a JSON custom atom.
+
+		A value whose JSON text has the same length is patched in place
+		(only that atom's CRC is recomputed); anything else rebuilds the
+		template from the stored settings, keeping the current UUID.
+		"""
+		new_text = json.dumps(value, separators=(',', ':')).encode('utf-8')
+		blob = self.eep.custom_blobs[blob_index]
+		span = find_json_value_span(bytes(blob.data), key)
+
+		if span is not None and span[1] == len(new_text):
+			custom_atoms = [i for i, atom in enumerate(self.template.atoms) if atom.type == AtomType.CUSTOM]
+			self.template.patch(custom_atoms[blob_index], span[0], new_text)
+			blob.data[span[0]:span[0] + span[1]] = new_text
+			return
+
+		fields = json.loads(bytes(blob.data).decode('utf-8'))
+		fields[key] = value
+		blob.data = bytearray(json.dumps(fields, separators=(',', ':')).encode('utf-8'))
+		self.template = ImageTemplate(self.eep.build_image())
+
+	def program(self, tool, start_addr: int = 0x00):
+		"""Write the current board image with MaxUsbTool's differential writer; returns (status, bytes_written)."""
+		return tool.write_eeprom_data(start_addr, self.template.image, differential=True)
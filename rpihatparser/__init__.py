@@ -7,33 +7,83 @@ The parser can be used standalone or integrated with MaxUsbTool for I2C EEPROM r
 
 from .rpi_hat_parser_wrapper import (
     parse_rpi_hat_eeprom,
+    parse_rpi_hat_eeprom_ex,
     parse_and_print_eeprom,
+    format_rpi_hat_eeprom,
+    ReportFormatter,
+    index_rpi_hat_eeprom,
+    get_custom_atom_view,
+    find_json_value,
+    get_custom_json_value,
+    IncrementalParser,
+    BatchParser,
     get_parse_error_message,
+    crc16,
     print_parsed_eeprom,
     ParsedEeprom,
     VendorInfo,
     CustomData,
     RpiHatHeader,
+    AtomView,
+    ParseIntegrity,
+    EepromSummary,
     PARSE_OK,
     PARSE_ERROR_INVALID_SIG,
     PARSE_ERROR_INVALID_DATA,
     PARSE_ERROR_BUFFER_TOO_SMALL,
     PARSE_ERROR_UNSUPPORTED_VERSION,
+    PARSE_ERROR_CRC_MISMATCH,
+    PARSE_ERROR_NOT_FOUND,
+    PARSE_FLAG_VERIFY_CRC,
+    REPORT_TEXT,
+    REPORT_JSON,
+    STREAM_NEED_MORE,
+    STREAM_COMPLETE,
+    STREAM_WANT_ALL,
+    STREAM_WANT_VENDOR_INFO,
+    STREAM_WANT_GPIO_MAP,
+    STREAM_WANT_DT_OVERLAY,
+    STREAM_WANT_CUSTOM,
 )
 
 __version__ = '1.0.0'
 __all__ = [
     'parse_rpi_hat_eeprom',
+    'parse_rpi_hat_eeprom_ex',
     'parse_and_print_eeprom',
+    'format_rpi_hat_eeprom',
+    'ReportFormatter',
+    'index_rpi_hat_eeprom',
+    'get_custom_atom_view',
+    'find_json_value',
+    'get_custom_json_value',
+    'IncrementalParser',
+    'BatchParser',
     'get_parse_error_message',
+    'crc16',
     'print_parsed_eeprom',
     'ParsedEeprom',
     'VendorInfo',
     'CustomData',
     'RpiHatHeader',
+    'AtomView',
+    'ParseIntegrity',
+    'EepromSummary',
     'PARSE_OK',
     'PARSE_ERROR_INVALID_SIG',
     'PARSE_ERROR_INVALID_DATA',
     'PARSE_ERROR_BUFFER_TOO_SMALL',
     'PARSE_ERROR_UNSUPPORTED_VERSION',
+    'PARSE_ERROR_CRC_MISMATCH',
+    'PARSE_ERROR_NOT_FOUND',
+    'PARSE_FLAG_VERIFY_CRC',
+    'REPORT_TEXT',
+    'REPORT_JSON',
+    'STREAM_NEED_MORE',
+    'STREAM_COMPLETE',
+    'STREAM_WANT_ALL',
+    'STREAM_WANT_VENDOR_INFO',
+    'STREAM_WANT_GPIO_MAP',
+    'STREAM_WANT_DT_OVERLAY',
+    'STREAM_WANT_CUSTOM',
 ]
@@ -0,0 +1,119 @@
+"""
+Benchmark of the ctypes DLL parser against the pure-Python parser
+
+Times MaxUsbTool's Python parser (parse_rpi_hat_image) and the DLL wrapper
+on the same images, and separates the cost of passing the image to the DLL
+(a pointer for bytes and buffers, a conversion for lists) from the parse itself.
+
+Usage: python bench_parser.py [image.bin ...]
+(defaults to ../original.bin and ../eeprom_settings_ad4080.bin)
+"""
+
+import sys
+import os
+import io
+import ctypes
+import contextlib
+import time
+
+# Add parent directory to path to import MaxUsbTool and eepmake
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from MaxUsbTool import MaxUsbTool
+import eepmake
+from rpihatparser import rpi_hat_parser_wrapper as parser
+
+MIN_BENCH_SECONDS = 0.2
+BATCH_IMAGES = 1024
+
+
+def run_bench(func):
+    """Double the iteration count until one run takes MIN_BENCH_SECONDS; returns seconds per call."""
+    iterations = 1
+    while True:
+        start = time.perf_counter()
+        for _ in range(iterations):
+            func()
+        elapsed = time.perf_counter() - start
+        if elapsed >= MIN_BENCH_SECONDS:
+            return elapsed / iterations
+        iterations *= 2
+
+
+def report(what, image, seconds, size):
+    mb_per_s = size / seconds / 1e6 if seconds > 0 else 0.0
+    print(f'  {what:<34} {image:<28} {seconds * 1e9:12.1f} ns {mb_per_s:10.1f} MB/s')
+
+
+def bench_image(name, data):
+    data_list = list(data)
+    data_array = (ctypes.c_uint8 * len(data))(*data)
+    result = parser.ParsedEeprom()
+
+    def python_parser():
+        with contextlib.redirect_stdout(io.StringIO()):
+            MaxUsbTool.parse_rpi_hat_image(data_list)
+
+    def marshal_only():
+        parser._data_buffer(data)
+
+    def marshal_list():
+        parser._data_buffer(data_list)
+
+    def raw_call():
+        parser.parser_lib.parse_rpi_hat_eeprom(data_array, len(data), ctypes.byref(result))
+
+    def print_callback():
+        parser.parse_and_print_eeprom(data, lambda line: None)
+
+    report('Python parse_rpi_hat_image', name, run_bench(python_parser), len(data))
+    report('wrapper parse_rpi_hat_eeprom', name, run_bench(lambda: parser.parse_rpi_hat_eeprom(data)), len(data))
+    report('  reused result object', name, run_bench(lambda: parser.parse_rpi_hat_eeprom(data, result)), len(data))
+    report('  list input', name, run_bench(lambda: parser.parse_rpi_hat_eeprom(data_list)), len(data))
+    report('  marshalling only (bytes)', name, run_bench(marshal_only), len(data))
+    report('  marshalling only (list)', name, run_bench(marshal_list), len(data))
+    report('  DLL call only', name, run_bench(raw_call), len(data))
+    report('wrapper parse_and_print_eeprom', name, run_bench(print_callback), len(data))
+    formatter = parser.ReportFormatter()
+    report('ReportFormatter (text)', name, run_bench(lambda: formatter.format(data)), len(data))
+    report('ReportFormatter (JSON)', name, run_bench(lambda: formatter.format(data, parser.REPORT_JSON)), len(data))
+
+    batch = [data] * BATCH_IMAGES
+    batch_parser = parser.BatchParser()
+    seconds = run_bench(lambda: batch_parser.parse(batch))
+    report(f'BatchParser ({len(batch)} per call)', name, seconds / len(batch), len(data))
+
+
+def bench_crc():
+    data = bytes(range(256)) * 16
+    maker = eepmake.EepMake()
+    native = eepmake.native_crc16
+
+    eepmake.native_crc16 = None
+    try:
+        report('eepmake calculate_crc16 (Python)', '4 KB', run_bench(lambda: maker.calculate_crc16(data)), len(data))
+    finally:
+        eepmake.native_crc16 = native
+    report('wrapper crc16', '4 KB', run_bench(lambda: parser.crc16(data)), len(data))
+
+
+def main():
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    paths = sys.argv[1:] or [os.path.join(root, 'original.bin'), os.path.join(root, 'eeprom_settings_ad4080.bin')]
+
+    print('Parser (per image)')
+    for path in paths:
+        try:
+            with open(path, 'rb') as f:
+                data = f.read()
+        except OSError as e:
+            print(f'Skipping {path}: {e}')
+            continue
+        bench_image(os.path.basename(path), data)
+
+    print('\nCRC16')
+    bench_crc()
+
+
+if __name__ == '__main__':
+    main()
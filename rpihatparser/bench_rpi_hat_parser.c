@@ -0,0 +1,388 @@
+/**
+ * bench_rpi_hat_parser.c
+ *
+ * Benchmark for the parser, CRC and batch paths of rpi_hat_parser.dll
+ * Usage: bench_rpi_hat_parser [image.bin ...]
+ * (defaults to ../original.bin and ../eeprom_settings_ad4080.bin)
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "rpi_hat_parser.h"
+#include "rpi_hat_builder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MIN_BENCH_NS       200000000ull   // Run each measurement for at least 0.2 s
+#define CRC_BUFFER_SIZE    (1u << 20)
+#define BATCH_IMAGES       1024
+#define MAX_BENCH_IMAGES   8
+#define SYNTH_MANY_ATOMS   32
+#define SYNTH_SMALL_BLOB   48
+#define SYNTH_LARGE_BLOB   (60u * 1024u)
+
+typedef struct {
+	const char* name;
+	uint8_t* data;
+	uint32_t size;
+} BenchImage;
+
+typedef struct {
+	const uint8_t* data;
+	uint32_t size;
+	uint32_t flags;
+	uint16_t (*crc)(uint16_t, const uint8_t*, uint32_t);
+	const EepromImage* images;
+	EepromSummary* results;
+	char* arena;
+	uint32_t arena_size;
+	uint32_t num_threads;
+} BenchContext;
+
+typedef void (*BenchFunc)(BenchContext* ctx);
+
+static volatile uint32_t bench_sink;
+
+static uint64_t now_ns(void) {
+#ifdef _WIN32
+	LARGE_INTEGER freq, counter;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / freq.QuadPart) * 1000000000u +
+		   (uint64_t)(counter.QuadPart % freq.QuadPart) * 1000000000u / (uint64_t)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// Doubles the iteration count until one run takes MIN_BENCH_NS; returns ns per call
+static double run_bench(BenchFunc func, BenchContext* ctx) {
+	uint64_t iterations = 1;
+
+	for (;;) {
+		uint64_t start = now_ns();
+		for (uint64_t i = 0; i < iterations; i++)
+			func(ctx);
+		uint64_t elapsed = now_ns() - start;
+
+		if (elapsed >= MIN_BENCH_NS)
+			return (double)elapsed / (double)iterations;
+
+		iterations *= 2;
+	}
+}
+
+static void report(const char* what, const char* image, double ns_per_call, double bytes_per_call) {
+	double mb_per_s = (ns_per_call > 0.0) ? bytes_per_call * 1000.0 / ns_per_call : 0.0;
+	printf("  %-34s %-28s %12.1f ns %10.1f MB/s\n", what, image, ns_per_call, mb_per_s);
+}
+
+static void bench_parse(BenchContext* ctx) {
+	ParsedEeprom result;
+	bench_sink += (uint32_t)parse_rpi_hat_eeprom(ctx->data, ctx->size, &result);
+	bench_sink += result.header.numatoms;
+}
+
+static void bench_parse_ex(BenchContext* ctx) {
+	ParsedEeprom result;
+	ParseIntegrity integrity;
+	bench_sink += (uint32_t)parse_rpi_hat_eeprom_ex(ctx->data, ctx->size, ctx->flags, &result, &integrity);
+	bench_sink += integrity.atoms_checked;
+}
+
+static void discard_output(const char* message) {
+	bench_sink += (uint32_t)message[0];
+}
+
+static void bench_parse_and_print(BenchContext* ctx) {
+	bench_sink += (uint32_t)parse_and_print_eeprom(ctx->data, ctx->size, discard_output);
+}
+
+static char report_buffer[64 * 1024];
+
+static void bench_format(BenchContext* ctx) {
+	uint32_t length = 0;
+	bench_sink += (uint32_t)format_rpi_hat_eeprom(ctx->data, ctx->size, ctx->flags, report_buffer,
+												  sizeof(report_buffer), &length, NULL);
+	bench_sink += length;
+}
+
+static void bench_crc(BenchContext* ctx) {
+	bench_sink += ctx->crc(CRC16_INIT, ctx->data, ctx->size);
+}
+
+static void bench_batch(BenchContext* ctx) {
+	uint32_t used = 0;
+	if (ctx->num_threads == 0) {
+		bench_sink += (uint32_t)parse_rpi_hat_eeprom_batch(ctx->images, BATCH_IMAGES, ctx->results,
+														   ctx->arena, ctx->arena_size, &used);
+	} else {
+		bench_sink += (uint32_t)parse_rpi_hat_eeprom_batch_mt(ctx->images, BATCH_IMAGES, ctx->results,
+															  ctx->arena, ctx->arena_size, &used,
+															  ctx->num_threads);
+	}
+}
+
+static int load_image(const char* path, BenchImage* image) {
+	FILE* f = fopen(path, "rb");
+	if (f == NULL)
+		return -1;
+
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	if (size <= 0) {
+		fclose(f);
+		return -1;
+	}
+
+	image->data = (uint8_t*)malloc((size_t)size);
+	if (image->data == NULL || fread(image->data, 1, (size_t)size, f) != (size_t)size) {
+		free(image->data);
+		fclose(f);
+		return -1;
+	}
+
+	fclose(f);
+	image->size = (uint32_t)size;
+
+	const char* base = strrchr(path, '/');
+	const char* base_win = strrchr(path, '\\');
+	if (base_win > base)
+		base = base_win;
+	image->name = base ? base + 1 : path;
+	return 0;
+}
+
+// Vendor atom plus num_blobs custom atoms of blob_size bytes
+static int build_synthetic(const char* name, uint32_t num_blobs, uint32_t blob_size, BenchImage* image) {
+	static const char vendor[] = "Benchmark Vendor";
+	static const char product[] = "Synthetic HAT";
+
+	ByteView* blobs = (ByteView*)calloc(num_blobs, sizeof(ByteView));
+	uint8_t* payload = (uint8_t*)malloc(blob_size);
+	if (blobs == NULL || payload == NULL) {
+		free(blobs);
+		free(payload);
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < blob_size; i++)
+		payload[i] = (uint8_t)('a' + i % 26);
+
+	for (uint32_t i = 0; i < num_blobs; i++) {
+		blobs[i].data = payload;
+		blobs[i].length = blob_size;
+	}
+
+	HatImageSpec spec;
+	memset(&spec, 0, sizeof(spec));
+	spec.format_version = HAT_FORMAT_HATPLUS;
+	spec.vendor.product_id = 1;
+	spec.vendor.product_version = 1;
+	spec.vendor.vendor = vendor;
+	spec.vendor.vendor_len = (uint8_t)(sizeof(vendor) - 1);
+	spec.vendor.product = product;
+	spec.vendor.product_len = (uint8_t)(sizeof(product) - 1);
+	spec.custom_blobs = blobs;
+	spec.num_custom_blobs = num_blobs;
+
+	image->size = hat_image_size(&spec);
+	image->data = (uint8_t*)malloc(image->size);
+	image->name = name;
+
+	int ret = (image->data != NULL) ? build_hat_image(&spec, image->data, image->size, NULL) : PARSE_ERROR_BUFFER_TOO_SMALL;
+
+	free(blobs);
+	free(payload);
+	return (ret == PARSE_OK) ? 0 : -1;
+}
+
+static void bench_image(const BenchImage* image) {
+	BenchContext ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.data = image->data;
+	ctx.size = image->size;
+
+	report("parse_rpi_hat_eeprom", image->name, run_bench(bench_parse, &ctx), image->size);
+
+	ctx.flags = PARSE_FLAG_VERIFY_CRC;
+	report("parse_rpi_hat_eeprom_ex (CRC)", image->name, run_bench(bench_parse_ex, &ctx), image->size);
+
+	report("parse_and_print_eeprom", image->name, run_bench(bench_parse_and_print, &ctx), image->size);
+
+	ctx.flags = REPORT_TEXT;
+	report("format_rpi_hat_eeprom (text)", image->name, run_bench(bench_format, &ctx), image->size);
+	ctx.flags = REPORT_JSON;
+	report("format_rpi_hat_eeprom (JSON)", image->name, run_bench(bench_format, &ctx), image->size);
+
+	// Same image with its layout registered, so parse takes the fixed-offset path
+	uint32_t layout_id;
+	if (hat_layout_register(image->data, image->size, &layout_id) == PARSE_OK) {
+		report("parse_rpi_hat_eeprom (layout)", image->name, run_bench(bench_parse, &ctx), image->size);
+		report("parse_rpi_hat_eeprom_ex (layout, CRC)", image->name, run_bench(bench_parse_ex, &ctx), image->size);
+		hat_layout_clear();
+	}
+}
+
+// Images a blank or corrupted part reads back: each is rejected from its header or first atom
+static void bench_malformed(const BenchImage* image) {
+	static const char* names[] = { "blank 0xFF", "numatoms 0xFFFF", "dlen 0xFFFFFFF0" };
+	uint8_t* data = (uint8_t*)malloc(image->size);
+	if (data == NULL || image->size < FIRST_ATOM_OFFSET + ATOM_HEADER_SIZE) {
+		free(data);
+		return;
+	}
+
+	BenchContext ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.data = data;
+	ctx.size = image->size;
+
+	for (uint32_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		memcpy(data, image->data, image->size);
+		if (i == 0) {
+			memset(data, 0xFF, image->size);
+		} else if (i == 1) {
+			data[6] = data[7] = 0xFF;
+		} else {
+			static const uint8_t huge_dlen[4] = { 0xF0, 0xFF, 0xFF, 0xFF };
+			memcpy(&data[FIRST_ATOM_OFFSET + 4], huge_dlen, sizeof(huge_dlen));
+		}
+		report("parse_rpi_hat_eeprom (reject)", names[i], run_bench(bench_parse, &ctx), image->size);
+	}
+
+	free(data);
+}
+
+static void bench_batches(const BenchImage* image) {
+	EepromImage* images = (EepromImage*)malloc(BATCH_IMAGES * sizeof(EepromImage));
+	EepromSummary* results = (EepromSummary*)malloc(BATCH_IMAGES * sizeof(EepromSummary));
+	uint32_t arena_size = BATCH_IMAGES * 2 * MAX_STRING_LENGTH;
+	char* arena = (char*)malloc(arena_size);
+
+	if (images == NULL || results == NULL || arena == NULL) {
+		printf("  Out of memory for batch benchmark\n");
+		free(images);
+		free(results);
+		free(arena);
+		return;
+	}
+
+	for (uint32_t i = 0; i < BATCH_IMAGES; i++) {
+		images[i].data = image->data;
+		images[i].size = image->size;
+	}
+
+	BenchContext ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.images = images;
+	ctx.results = results;
+	ctx.arena = arena;
+	ctx.arena_size = arena_size;
+
+	double ns = run_bench(bench_batch, &ctx);
+	report("parse_rpi_hat_eeprom_batch", image->name, ns / BATCH_IMAGES, image->size);
+
+	static const uint32_t thread_counts[] = { 1, 2, 4, 8 };
+	for (uint32_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+		char label[64];
+		snprintf(label, sizeof(label), "parse_rpi_hat_eeprom_batch_mt x%u", (unsigned)thread_counts[i]);
+		ctx.num_threads = thread_counts[i];
+		ns = run_bench(bench_batch, &ctx);
+		report(label, image->name, ns / BATCH_IMAGES, image->size);
+	}
+
+	free(images);
+	free(results);
+	free(arena);
+}
+
+static void bench_crc_variants(void) {
+	uint8_t* buffer = (uint8_t*)malloc(CRC_BUFFER_SIZE);
+	if (buffer == NULL)
+		return;
+
+	uint32_t state = 0x12345678u;
+	for (uint32_t i = 0; i < CRC_BUFFER_SIZE; i++) {
+		state = state * 1103515245u + 12345u;
+		buffer[i] = (uint8_t)(state >> 24);
+	}
+
+	static const struct {
+		const char* name;
+		uint16_t (*crc)(uint16_t, const uint8_t*, uint32_t);
+	} variants[] = {
+		{ "crc16_update_bitwise", crc16_update_bitwise },
+		{ "crc16_update_table", crc16_update_table },
+		{ "crc16_update_slice4", crc16_update_slice4 },
+		{ "crc16_update_slice8", crc16_update_slice8 },
+		{ "crc16_update", crc16_update },
+	};
+
+	BenchContext ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.data = buffer;
+	ctx.size = CRC_BUFFER_SIZE;
+
+	for (uint32_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+		ctx.crc = variants[i].crc;
+		report(variants[i].name, "1 MB random", run_bench(bench_crc, &ctx), CRC_BUFFER_SIZE);
+	}
+
+	free(buffer);
+}
+
+int main(int argc, char** argv) {
+	static const char* default_images[] = { "../original.bin", "../eeprom_settings_ad4080.bin" };
+	const char** paths = (argc > 1) ? (const char**)&argv[1] : default_images;
+	int num_paths = (argc > 1) ? argc - 1 : (int)(sizeof(default_images) / sizeof(default_images[0]));
+
+	BenchImage images[MAX_BENCH_IMAGES];
+	uint32_t num_images = 0;
+
+	for (int i = 0; i < num_paths && num_images < MAX_BENCH_IMAGES - 2; i++) {
+		if (load_image(paths[i], &images[num_images]) == 0)
+			num_images++;
+		else
+			printf("Skipping %s (cannot read file)\n", paths[i]);
+	}
+
+	if (build_synthetic("synthetic 32 atoms", SYNTH_MANY_ATOMS, SYNTH_SMALL_BLOB, &images[num_images]) == 0)
+		num_images++;
+	if (build_synthetic("synthetic 60 KB blob", 1, SYNTH_LARGE_BLOB, &images[num_images]) == 0)
+		num_images++;
+
+	printf("Parser (per image)\n");
+	for (uint32_t i = 0; i < num_images; i++)
+		bench_image(&images[i]);
+
+	if (num_images > 0) {
+		printf("\nMalformed (%s)\n", images[0].name);
+		bench_malformed(&images[0]);
+	}
+
+	printf("\nBatch (per image, %u images per call)\n", (unsigned)BATCH_IMAGES);
+	for (uint32_t i = 0; i < num_images; i++)
+		bench_batches(&images[i]);
+
+	printf("\nCRC16\n");
+	bench_crc_variants();
+
+	for (uint32_t i = 0; i < num_images; i++)
+		free(images[i].data);
+
+	return 0;
+}
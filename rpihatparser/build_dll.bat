@@ -11,10 +11,38 @@ if %ERRORLEVEL% NEQ 0 (
     exit /b 1
 )
 
+gcc -Wall -Wextra -O2 -std=c99 -c i2c_transfer.c -o i2c_transfer.o
+
+if %ERRORLEVEL% NEQ 0 (
+    echo Compilation failed!
+    exit /b 1
+)
+
+gcc -Wall -Wextra -O2 -std=c99 -c rpi_hat_builder.c -o rpi_hat_builder.o
+
+if %ERRORLEVEL% NEQ 0 (
+    echo Compilation failed!
+    exit /b 1
+)
+
+gcc -Wall -Wextra -O2 -std=c99 -c rpi_hat_archive.c -o rpi_hat_archive.o
+
+if %ERRORLEVEL% NEQ 0 (
+    echo Compilation failed!
+    exit /b 1
+)
+
+gcc -Wall -Wextra -O2 -std=c99 -c rpi_hat_pack.c -o rpi_hat_pack.o
+
+if %ERRORLEVEL% NEQ 0 (
+    echo Compilation failed!
+    exit /b 1
+)
+
 echo Compilation successful, linking DLL...
 
 REM
-gcc -shared -o rpi_hat_parser.dll rpi_hat_parser.o
+gcc -shared -o rpi_hat_parser.dll rpi_hat_parser.o i2c_transfer.o rpi_hat_builder.o rpi_hat_archive.o rpi_hat_pack.o
 
 if %ERRORLEVEL% NEQ 0 (
     echo Linking failed!
@@ -23,5 +51,23 @@ if %ERRORLEVEL% NEQ 0 (
 
 echo Successfully built rpi_hat_parser.dll
 
+echo Building bench_rpi_hat_parser.exe...
+
+gcc -Wall -Wextra -O2 -std=c99 bench_rpi_hat_parser.c rpi_hat_parser.c rpi_hat_builder.c -o bench_rpi_hat_parser.exe
+
+if %ERRORLEVEL% NEQ 0 (
+    echo Benchmark compilation failed!
+    exit /b 1
+)
+
+echo Building fuzz_rpi_hat_parser.exe...
+
+gcc -Wall -Wextra -O2 -std=c99 fuzz_rpi_hat_parser.c rpi_hat_parser.c rpi_hat_builder.c -o fuzz_rpi_hat_parser.exe
+
+if %ERRORLEVEL% NEQ 0 (
+    echo Fuzz suite compilation failed!
+    exit /b 1
+)
+
 REM
-del rpi_hat_parser.o
+del rpi_hat_parser.o i2c_transfer.o rpi_hat_builder.o rpi_hat_archive.o rpi_hat_pack.o
@@ -0,0 +1,119 @@
+/**
+ * file_map.h
+ *
+ * Read-only file mapping shim (Win32 file mappings or POSIX mmap) used inside the DLL
+ * Internal header, not part of the DLL interface
+ */
+
+#ifndef FILE_MAP_H
+#define FILE_MAP_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    const uint8_t* data;    // NULL for an empty file
+    uint64_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} file_map_t;
+
+/**
+ * Map a whole file read-only
+ *
+ * @param map: Mapping to fill in
+ * @param path: File to map
+ * @return: 0 on success, -1 if the file cannot be opened or mapped
+ */
+static int file_map_open(file_map_t* map, const char* path) {
+    memset(map, 0, sizeof(file_map_t));
+
+#ifdef _WIN32
+    map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (map->file == INVALID_HANDLE_VALUE)
+        return -1;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(map->file, &size)) {
+        CloseHandle(map->file);
+        return -1;
+    }
+    map->size = (uint64_t)size.QuadPart;
+
+    if (map->size == 0)
+        return 0;
+
+    map->mapping = CreateFileMappingA(map->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (map->mapping == NULL) {
+        CloseHandle(map->file);
+        return -1;
+    }
+
+    map->data = (const uint8_t*)MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (map->data == NULL) {
+        CloseHandle(map->mapping);
+        CloseHandle(map->file);
+        return -1;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return -1;
+    }
+    map->size = (uint64_t)st.st_size;
+
+    if (map->size > 0) {
+        void* data = mmap(NULL, (size_t)map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        map->data = (const uint8_t*)data;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+
+    return 0;
+}
+
+/**
+ * Unmap a file mapped with file_map_open
+ *
+ * @param map: Mapping to release
+ */
+static void file_map_close(file_map_t* map) {
+#ifdef _WIN32
+    if (map->data != NULL)
+        UnmapViewOfFile((LPCVOID)map->data);
+    if (map->mapping != NULL)
+        CloseHandle(map->mapping);
+    if (map->file != NULL && map->file != INVALID_HANDLE_VALUE)
+        CloseHandle(map->file);
+#else
+    if (map->data != NULL)
+        munmap((void*)map->data, (size_t)map->size);
+#endif
+
+    memset(map, 0, sizeof(file_map_t));
+}
+
+#endif // FILE_MAP_H
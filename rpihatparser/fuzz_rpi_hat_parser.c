@@ -0,0 +1,904 @@
+/**
+ * fuzz_rpi_hat_parser.c
+ *
+ * Robustness and throughput regression suite for the parser paths of rpi_hat_parser.dll
+ * Usage: fuzz_rpi_hat_parser [-n mutants] [-s seed] [-b baseline.txt] [-u] [-t tolerance_pct] [image.bin ...]
+ *
+ * Builds a corpus of synthetic images (many atoms, maximum-length strings,
+ * custom blobs larger than MAX_CUSTOM_DATA_SIZE, truncated chains) plus any
+ * dumps given on the command line, and random mutants of all of them. Every
+ * image goes through the generic parser, the layout path, the streaming
+ * parser (fed in random chunks), the zero-copy index and the multithreaded
+ * batch parser, and their results must agree. Throughput of each path is
+ * then measured on the unmutated corpus; with -b, a path slower than the
+ * baseline by more than the tolerance fails the run, and -u rewrites the
+ * baseline. Exit status is 0 only if every check passed.
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "rpi_hat_parser.h"
+#include "rpi_hat_builder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MIN_MEASURE_NS      200000000ull   // Time each path for at least 0.2 s
+#define DEFAULT_MUTANTS     20000
+#define DEFAULT_SEED        0x5EED1234u
+#define DEFAULT_TOLERANCE   25.0           // Percent below baseline that counts as a regression
+#define MAX_INDEX_ATOMS     512
+#define MAX_REPORTED        20             // Mismatches printed in full
+#define FUZZ_THREADS        4
+#define MAX_STREAM_CHUNK    64
+#define MAX_NAME_LENGTH     64
+
+#define SYNTH_MANY_ATOMS    200
+#define SYNTH_LARGE_BLOB    (MAX_CUSTOM_DATA_SIZE + 1904)
+#define SYNTH_HUGE_BLOB     (60u * 1024u)
+
+typedef struct {
+	char name[MAX_NAME_LENGTH];
+	uint8_t* data;
+	uint32_t size;
+} FuzzImage;
+
+typedef struct {
+	FuzzImage* images;
+	uint32_t count;
+	uint32_t capacity;
+} Corpus;
+
+// Reference results of one image from the generic parser
+typedef struct {
+	int status;                 // parse_rpi_hat_eeprom_ex with PARSE_FLAG_VERIFY_CRC
+	int walk_status;            // Same without CRC checks: what index and batch must return
+	ParsedEeprom result;
+	ParseIntegrity integrity;
+} FuzzReference;
+
+typedef struct {
+	const char* name;
+	double mb_per_s;
+} Throughput;
+
+static uint32_t mismatches;
+static volatile uint32_t fuzz_sink;
+
+static uint64_t now_ns(void) {
+#ifdef _WIN32
+	LARGE_INTEGER freq, counter;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / freq.QuadPart) * 1000000000u +
+		   (uint64_t)(counter.QuadPart % freq.QuadPart) * 1000000000u / (uint64_t)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// xorshift32: the same seed gives the same corpus on every platform
+static uint32_t next_random(uint32_t* state) {
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+static void mismatch(const FuzzImage* image, const char* what, int expected, int actual) {
+	if (mismatches++ < MAX_REPORTED)
+		printf("  MISMATCH %-40s %-26s expected %d, got %d\n", image->name, what, expected, actual);
+}
+
+static int corpus_add(Corpus* corpus, const char* name, const uint8_t* data, uint32_t size) {
+	if (corpus->count == corpus->capacity) {
+		uint32_t capacity = corpus->capacity ? corpus->capacity * 2 : 256;
+		FuzzImage* images = (FuzzImage*)realloc(corpus->images, capacity * sizeof(FuzzImage));
+		if (images == NULL)
+			return -1;
+		corpus->images = images;
+		corpus->capacity = capacity;
+	}
+
+	FuzzImage* image = &corpus->images[corpus->count];
+	image->data = (uint8_t*)malloc(size ? size : 1);
+	if (image->data == NULL)
+		return -1;
+
+	memcpy(image->data, data, size);
+	image->size = size;
+	snprintf(image->name, sizeof(image->name), "%s", name);
+	corpus->count++;
+	return 0;
+}
+
+static void corpus_free(Corpus* corpus) {
+	for (uint32_t i = 0; i < corpus->count; i++)
+		free(corpus->images[i].data);
+	free(corpus->images);
+	memset(corpus, 0, sizeof(Corpus));
+}
+
+static int load_image(Corpus* corpus, const char* path) {
+	FILE* f = fopen(path, "rb");
+	if (f == NULL)
+		return -1;
+
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	uint8_t* data = (size > 0) ? (uint8_t*)malloc((size_t)size) : NULL;
+	int ret = -1;
+	if (data != NULL && fread(data, 1, (size_t)size, f) == (size_t)size) {
+		const char* base = strrchr(path, '/');
+		const char* base_win = strrchr(path, '\\');
+		if (base_win > base)
+			base = base_win;
+		ret = corpus_add(corpus, base ? base + 1 : path, data, (uint32_t)size);
+	}
+
+	free(data);
+	fclose(f);
+	return ret;
+}
+
+static int add_built(Corpus* corpus, const char* name, const HatImageSpec* spec) {
+	uint32_t size = hat_image_size(spec);
+	uint8_t* data = (uint8_t*)malloc(size);
+	int ret = -1;
+
+	if (data != NULL && build_hat_image(spec, data, size, NULL) == PARSE_OK)
+		ret = corpus_add(corpus, name, data, size);
+
+	free(data);
+	return ret;
+}
+
+// Synthetic images that stress sizes and limits, all valid
+static int build_synthetic(Corpus* corpus) {
+	static const char vendor[] = "Fuzz Vendor";
+	static const char adi_vendor[] = "Analog Devices Inc.";
+	static const char product[] = "Synthetic HAT";
+	static const char overlay[] = "fuzz-overlay";
+	char long_vendor[255], long_product[255], long_overlay[2 * MAX_STRING_LENGTH];
+
+	memset(long_vendor, 'V', sizeof(long_vendor));
+	memset(long_product, 'P', sizeof(long_product));
+	memset(long_overlay, 'o', sizeof(long_overlay));
+
+	uint8_t* payload = (uint8_t*)malloc(SYNTH_HUGE_BLOB);
+	ByteView* blobs = (ByteView*)calloc(SYNTH_MANY_ATOMS, sizeof(ByteView));
+	if (payload == NULL || blobs == NULL) {
+		free(payload);
+		free(blobs);
+		return -1;
+	}
+
+	// JSON-looking start so the is_json path is covered on the large blobs
+	payload[0] = '{';
+	for (uint32_t i = 1; i < SYNTH_HUGE_BLOB; i++)
+		payload[i] = (uint8_t)(' ' + i % 95);
+
+	HatGpioSpec gpio;
+	memset(&gpio, 0, sizeof(gpio));
+	gpio.pins[4] = 0x81;
+
+	HatImageSpec spec;
+	memset(&spec, 0, sizeof(spec));
+	spec.format_version = HAT_FORMAT_HATPLUS;
+	spec.vendor.serial[0] = 0x12345678u;
+	spec.vendor.product_id = 0x0101;
+	spec.vendor.product_version = 2;
+	spec.vendor.vendor = vendor;
+	spec.vendor.vendor_len = (uint8_t)(sizeof(vendor) - 1);
+	spec.vendor.product = product;
+	spec.vendor.product_len = (uint8_t)(sizeof(product) - 1);
+	spec.gpio_bank0 = &gpio;
+	spec.has_dt_overlay = 1;
+	spec.dt_overlay.data = (const uint8_t*)overlay;
+	spec.dt_overlay.length = sizeof(overlay) - 1;
+
+	int ret = add_built(corpus, "synthetic plain", &spec);
+
+	for (uint32_t i = 0; i < SYNTH_MANY_ATOMS; i++) {
+		blobs[i].data = payload + i;
+		blobs[i].length = 16 + i % 48;
+	}
+	spec.custom_blobs = blobs;
+	spec.num_custom_blobs = SYNTH_MANY_ATOMS;
+	ret |= add_built(corpus, "synthetic many atoms", &spec);
+
+	spec.num_custom_blobs = 3;
+	spec.vendor.vendor = adi_vendor;
+	spec.vendor.vendor_len = (uint8_t)(sizeof(adi_vendor) - 1);
+	ret |= add_built(corpus, "synthetic ADI skip custom", &spec);
+
+	spec.vendor.vendor = long_vendor;
+	spec.vendor.vendor_len = (uint8_t)sizeof(long_vendor);
+	spec.vendor.product = long_product;
+	spec.vendor.product_len = (uint8_t)sizeof(long_product);
+	spec.dt_overlay.data = (const uint8_t*)long_overlay;
+	spec.dt_overlay.length = sizeof(long_overlay);
+	ret |= add_built(corpus, "synthetic max strings", &spec);
+
+	blobs[0].data = payload;
+	blobs[0].length = SYNTH_LARGE_BLOB;
+	spec.num_custom_blobs = 1;
+	ret |= add_built(corpus, "synthetic blob > MAX_CUSTOM", &spec);
+
+	blobs[0].length = SYNTH_HUGE_BLOB;
+	spec.gpio_bank0 = NULL;
+	spec.has_dt_overlay = 0;
+	ret |= add_built(corpus, "synthetic 60 KB blob", &spec);
+
+	free(payload);
+	free(blobs);
+	return ret;
+}
+
+static void write_le16(uint8_t* data, uint32_t offset, uint16_t value) {
+	data[offset] = (uint8_t)value;
+	data[offset + 1] = (uint8_t)(value >> 8);
+}
+
+static void write_le32(uint8_t* data, uint32_t offset, uint32_t value) {
+	for (uint32_t i = 0; i < 4; i++)
+		data[offset + i] = (uint8_t)(value >> (8 * i));
+}
+
+// Truncated variants of every valid seed: cut mid-atom, and chains that claim one atom too many
+static void add_truncated(Corpus* corpus, uint32_t num_seeds) {
+	char name[MAX_NAME_LENGTH];
+
+	for (uint32_t s = 0; s < num_seeds; s++) {
+		RpiHatHeader header;
+		AtomView atoms[MAX_INDEX_ATOMS];
+		uint32_t num_atoms;
+		const FuzzImage* seed = &corpus->images[s];
+
+		if (index_rpi_hat_eeprom(seed->data, seed->size, &header, atoms, MAX_INDEX_ATOMS, &num_atoms) != PARSE_OK ||
+			num_atoms == 0 || num_atoms > MAX_INDEX_ATOMS)
+			continue;
+
+		uint32_t seed_size = seed->size;
+		uint8_t* data = (uint8_t*)malloc(seed_size);
+		if (data == NULL)
+			return;
+
+		const AtomView* last = &atoms[num_atoms - 1];
+		uint32_t cut = last->offset + last->dlen / 2;
+
+		memcpy(data, corpus->images[s].data, seed_size);
+		snprintf(name, sizeof(name), "%.40s /cut", corpus->images[s].name);
+		corpus_add(corpus, name, data, cut);
+
+		write_le32(data, 8, cut);
+		snprintf(name, sizeof(name), "%.40s /eeplen cut", corpus->images[s].name);
+		corpus_add(corpus, name, data, seed_size);
+
+		memcpy(data, corpus->images[s].data, seed_size);
+		write_le16(data, 6, (uint16_t)(header.numatoms + 1));
+		snprintf(name, sizeof(name), "%.40s /extra atom", corpus->images[s].name);
+		corpus_add(corpus, name, data, seed_size);
+
+		free(data);
+	}
+}
+
+// Random damage to a copy of a seed, biased towards the header and the atom lengths in atoms
+static void mutate(uint8_t* data, uint32_t* size, const AtomView* atoms, uint32_t num_atoms, uint32_t* rng) {
+	uint32_t edits = 1 + next_random(rng) % 4;
+
+	for (uint32_t e = 0; e < edits && *size > 0; e++) {
+		uint32_t kind = next_random(rng) % 8;
+		uint32_t offset = next_random(rng) % *size;
+
+		switch (kind) {
+			case 0:
+				data[offset] ^= (uint8_t)(1u << (next_random(rng) % 8));
+				break;
+			case 1:
+				data[offset] = (next_random(rng) & 1) ? 0xFF : 0x00;
+				break;
+			case 2:
+				if (*size >= FIRST_ATOM_OFFSET)
+					write_le16(data, 6, (uint16_t)next_random(rng));
+				break;
+			case 3:
+				if (*size >= FIRST_ATOM_OFFSET)
+					write_le32(data, 8, next_random(rng) % (*size + 64));
+				break;
+			case 4:
+				// Off-by-a-few or extreme dlen on a real atom
+				if (num_atoms > 0) {
+					static const uint32_t lengths[] = { 0, 1, 2, 3, 0x7FFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFF8u };
+					const AtomView* atom = &atoms[next_random(rng) % num_atoms];
+					uint32_t pick = next_random(rng) % 12;
+					uint32_t dlen = (pick < sizeof(lengths) / sizeof(lengths[0])) ? lengths[pick]
+																				  : atom->dlen + pick - 9;
+					if (atom->offset <= *size)
+						write_le32(data, atom->offset - 4, dlen);
+				}
+				break;
+			case 5:
+				*size = offset;
+				break;
+			case 6:
+				memset(&data[offset], 0xFF, *size - offset);
+				break;
+			default:
+				data[offset] = (uint8_t)next_random(rng);
+				break;
+		}
+	}
+}
+
+static void add_mutants(Corpus* corpus, uint32_t num_seeds, uint32_t count, uint32_t seed) {
+	uint32_t rng = seed ? seed : DEFAULT_SEED;
+	uint32_t max_size = 0;
+	char name[MAX_NAME_LENGTH];
+
+	for (uint32_t s = 0; s < num_seeds; s++) {
+		if (corpus->images[s].size > max_size)
+			max_size = corpus->images[s].size;
+	}
+
+	uint8_t* data = (uint8_t*)malloc(max_size ? max_size : 1);
+	AtomView* atoms = (AtomView*)malloc(MAX_INDEX_ATOMS * sizeof(AtomView));
+	if (data == NULL || atoms == NULL) {
+		free(data);
+		free(atoms);
+		return;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		const FuzzImage* source = &corpus->images[next_random(&rng) % num_seeds];
+		uint32_t size = source->size;
+		uint32_t num_atoms = 0;
+		if (index_rpi_hat_eeprom(source->data, size, NULL, atoms, MAX_INDEX_ATOMS, &num_atoms) != PARSE_OK ||
+			num_atoms > MAX_INDEX_ATOMS)
+			num_atoms = 0;
+
+		memcpy(data, source->data, size);
+		mutate(data, &size, atoms, num_atoms, &rng);
+
+		snprintf(name, sizeof(name), "%.40s /mutant %u", source->name, (unsigned)i);
+		corpus_add(corpus, name, data, size);
+	}
+
+	free(data);
+	free(atoms);
+}
+
+static void compare_parsed(const FuzzImage* image, const char* what, const FuzzReference* ref,
+						   const ParsedEeprom* result, const ParseIntegrity* integrity) {
+	if (memcmp(&ref->result, result, sizeof(ParsedEeprom)) != 0)
+		mismatch(image, what, 0, 1);
+	if (integrity != NULL && memcmp(&ref->integrity, integrity, sizeof(ParseIntegrity)) != 0)
+		mismatch(image, what, (int)ref->integrity.atoms_failed, (int)integrity->atoms_failed);
+}
+
+// Streaming parser fed in random chunk sizes must end where the one-shot parser does
+static void check_stream(const FuzzImage* image, const FuzzReference* ref, uint32_t* rng) {
+	if (image->size < FIRST_ATOM_OFFSET)
+		return;
+
+	uint8_t* buffer = (uint8_t*)malloc(image->size);
+	ParsedEeprom* result = (ParsedEeprom*)malloc(sizeof(ParsedEeprom));
+	StreamParser ctx;
+
+	if (buffer == NULL || result == NULL ||
+		stream_parser_init_ex(&ctx, buffer, image->size, STREAM_WANT_ALL, PARSE_FLAG_VERIFY_CRC, result) != PARSE_OK) {
+		mismatch(image, "stream init", PARSE_OK, -1);
+		free(buffer);
+		free(result);
+		return;
+	}
+
+	uint32_t fed = 0;
+	int state = STREAM_NEED_MORE;
+	while (state == STREAM_NEED_MORE && fed < image->size) {
+		uint32_t chunk = 1 + next_random(rng) % MAX_STREAM_CHUNK;
+		if (chunk > image->size - fed)
+			chunk = image->size - fed;
+		state = stream_parser_feed(&ctx, image->data + fed, chunk);
+		fed += chunk;
+	}
+
+	int status = (state < 0) ? state : stream_parser_finish(&ctx);
+	if (status != ref->status)
+		mismatch(image, "stream status", ref->status, status);
+	else if (status == PARSE_OK || status == PARSE_ERROR_CRC_MISMATCH)
+		compare_parsed(image, "stream result", ref, result, &ctx.integrity);
+
+	free(buffer);
+	free(result);
+}
+
+static uint32_t expected_custom_length(const AtomView* view) {
+	uint32_t length = view->dlen - 2;
+	return (length > MAX_CUSTOM_DATA_SIZE) ? MAX_CUSTOM_DATA_SIZE : length;
+}
+
+// Zero-copy index and custom view must describe the same atoms the parser decoded
+static void check_index(const FuzzImage* image, const FuzzReference* ref, AtomView* atoms) {
+	RpiHatHeader header;
+	uint32_t num_atoms = 0;
+	int status = index_rpi_hat_eeprom(image->data, image->size, &header, atoms, MAX_INDEX_ATOMS, &num_atoms);
+
+	if (status != ref->walk_status) {
+		mismatch(image, "index status", ref->walk_status, status);
+		return;
+	}
+
+	ByteView view;
+	int view_status = get_custom_atom_view(image->data, image->size, 0, &view);
+	if (status != PARSE_OK) {
+		if (view_status == PARSE_OK && image->size >= FIRST_ATOM_OFFSET &&
+			(status == PARSE_ERROR_INVALID_SIG || status == PARSE_ERROR_UNSUPPORTED_VERSION))
+			mismatch(image, "custom view on bad header", status, view_status);
+		return;
+	}
+
+	if (memcmp(&header, &ref->result.header, sizeof(RpiHatHeader)) != 0)
+		mismatch(image, "index header", 0, 1);
+	if (num_atoms != header.numatoms)
+		mismatch(image, "index atom count", header.numatoms, (int)num_atoms);
+
+	uint32_t indexed = (num_atoms < MAX_INDEX_ATOMS) ? num_atoms : MAX_INDEX_ATOMS;
+	const AtomView* vendor = find_atom_view(atoms, indexed, ATOM_TYPE_VENDOR_INFO);
+	if ((vendor != NULL) != (ref->result.has_vendor_info != 0))
+		mismatch(image, "index vendor atom", ref->result.has_vendor_info, vendor != NULL);
+
+	const AtomView* first_custom = find_atom_view(atoms, indexed, ATOM_TYPE_CUSTOM);
+	if ((first_custom != NULL) != (view_status == PARSE_OK))
+		mismatch(image, "custom view presence", first_custom != NULL, view_status == PARSE_OK);
+	else if (first_custom != NULL && view.data != image->data + first_custom->offset)
+		mismatch(image, "custom view offset", (int)first_custom->offset, (int)(view.data - image->data));
+
+	// The parser keeps the last custom atom; only compare when no vendor rule can hide one
+	const AtomView* last_custom = NULL;
+	int adi = ref->result.has_vendor_info && strcmp(ref->result.vendor_info.vendor, "Analog Devices Inc.") == 0;
+	for (uint32_t i = 0; i < indexed; i++) {
+		if (atoms[i].type == ATOM_TYPE_CUSTOM)
+			last_custom = &atoms[i];
+	}
+
+	if (!adi && last_custom != NULL && indexed == num_atoms) {
+		const CustomData* custom = &ref->result.custom_data;
+		if (!ref->result.has_custom_data || custom->data_length != expected_custom_length(last_custom) ||
+			memcmp(custom->data, image->data + last_custom->offset, custom->data_length) != 0)
+			mismatch(image, "index custom payload", (int)custom->data_length, (int)expected_custom_length(last_custom));
+	}
+}
+
+static int arena_string_equal(const char* arena, uint32_t offset, const char* expected) {
+	return offset != ARENA_OFFSET_NONE && strcmp(arena + offset, expected) == 0;
+}
+
+static void check_summary(const FuzzImage* image, const FuzzReference* ref, const EepromSummary* summary,
+						  const char* arena) {
+	if (summary->status != ref->walk_status) {
+		mismatch(image, "batch status", ref->walk_status, summary->status);
+		return;
+	}
+
+	if (summary->status != PARSE_OK)
+		return;
+
+	const ParsedEeprom* result = &ref->result;
+	if (memcmp(&summary->header, &result->header, sizeof(RpiHatHeader)) != 0 ||
+		summary->has_vendor_info != result->has_vendor_info ||
+		summary->has_custom_data != result->has_custom_data ||
+		summary->has_dt_overlay != result->has_dt_overlay) {
+		mismatch(image, "batch atoms", 0, 1);
+		return;
+	}
+
+	if (result->has_vendor_info &&
+		(memcmp(summary->uuid, result->vendor_info.uuid, 16) != 0 ||
+		 summary->product_id != result->vendor_info.product_id ||
+		 summary->product_version != result->vendor_info.product_version ||
+		 !arena_string_equal(arena, summary->vendor_offset, result->vendor_info.vendor) ||
+		 !arena_string_equal(arena, summary->product_offset, result->vendor_info.product)))
+		mismatch(image, "batch vendor info", 0, 1);
+
+	if (result->has_custom_data) {
+		uint32_t length = (summary->custom_data_length > MAX_CUSTOM_DATA_SIZE) ? MAX_CUSTOM_DATA_SIZE
+																			 : summary->custom_data_length;
+		if (length != result->custom_data.data_length || summary->custom_is_json != result->custom_data.is_json ||
+			memcmp(image->data + summary->custom_data_offset, result->custom_data.data, length) != 0)
+			mismatch(image, "batch custom data", (int)result->custom_data.data_length, (int)length);
+	}
+
+	if (result->has_dt_overlay && !arena_string_equal(arena, summary->dt_overlay_offset, result->dt_overlay))
+		mismatch(image, "batch dt overlay", 0, 1);
+}
+
+static void reference_parse(const FuzzImage* image, FuzzReference* ref) {
+	ref->status = parse_rpi_hat_eeprom_ex(image->data, image->size, PARSE_FLAG_VERIFY_CRC | PARSE_FLAG_GENERIC,
+										  &ref->result, &ref->integrity);
+	ref->walk_status = (ref->status == PARSE_ERROR_CRC_MISMATCH) ? PARSE_OK : ref->status;
+}
+
+static void check_corpus(const Corpus* corpus, uint32_t seed) {
+	FuzzReference* ref = (FuzzReference*)malloc(sizeof(FuzzReference));
+	ParsedEeprom* result = (ParsedEeprom*)malloc(sizeof(ParsedEeprom));
+	AtomView* atoms = (AtomView*)malloc(MAX_INDEX_ATOMS * sizeof(AtomView));
+	EepromImage* images = (EepromImage*)malloc(corpus->count * sizeof(EepromImage));
+	EepromSummary* summaries = (EepromSummary*)malloc(corpus->count * sizeof(EepromSummary));
+	uint32_t arena_size = corpus->count * 64;
+	char* arena = (char*)malloc(arena_size);
+	uint32_t rng = seed ? seed : DEFAULT_SEED;
+
+	if (ref == NULL || result == NULL || atoms == NULL || images == NULL || summaries == NULL || arena == NULL) {
+		printf("  Out of memory\n");
+		mismatches++;
+		goto done;
+	}
+
+	for (uint32_t i = 0; i < corpus->count; i++) {
+		images[i].data = corpus->images[i].data;
+		images[i].size = corpus->images[i].size;
+	}
+
+	// Whole corpus through the thread pool first, as a batch worker would see it
+	uint32_t arena_used = 0;
+	int batch_status = parse_rpi_hat_eeprom_batch_mt(images, corpus->count, summaries, arena, arena_size,
+													 &arena_used, FUZZ_THREADS);
+	if (batch_status == PARSE_ERROR_BUFFER_TOO_SMALL) {
+		char* larger = (char*)realloc(arena, arena_used);
+		if (larger != NULL) {
+			arena = larger;
+			arena_size = arena_used;
+			batch_status = parse_rpi_hat_eeprom_batch_mt(images, corpus->count, summaries, arena, arena_size,
+														 &arena_used, FUZZ_THREADS);
+		}
+	}
+	if (batch_status != PARSE_OK) {
+		printf("  Batch parse failed: %s\n", get_parse_error_message(batch_status));
+		mismatches++;
+	}
+
+	uint32_t status_counts[8] = { 0 };
+
+	for (uint32_t i = 0; i < corpus->count; i++) {
+		const FuzzImage* image = &corpus->images[i];
+		reference_parse(image, ref);
+		status_counts[(ref->status <= 0 && ref->status >= -6) ? -ref->status : 7]++;
+
+		// Default flags take the layout path when a registered layout matches
+		ParseIntegrity integrity;
+		int status = parse_rpi_hat_eeprom_ex(image->data, image->size, PARSE_FLAG_VERIFY_CRC, result, &integrity);
+		if (status != ref->status)
+			mismatch(image, "layout parse status", ref->status, status);
+		else if (status == PARSE_OK || status == PARSE_ERROR_CRC_MISMATCH)
+			compare_parsed(image, "layout parse result", ref, result, &integrity);
+
+		status = parse_rpi_hat_eeprom(image->data, image->size, result);
+		if (status != ref->walk_status)
+			mismatch(image, "parse status", ref->walk_status, status);
+
+		check_stream(image, ref, &rng);
+		check_index(image, ref, atoms);
+		if (batch_status == PARSE_OK)
+			check_summary(image, ref, &summaries[i], arena);
+	}
+
+	printf("  %u images: %u OK, %u CRC mismatch, %u invalid data, %u bad signature, %u too small, %u bad version\n",
+		   (unsigned)corpus->count, (unsigned)status_counts[0], (unsigned)status_counts[5], (unsigned)status_counts[2],
+		   (unsigned)status_counts[1], (unsigned)status_counts[3], (unsigned)status_counts[4]);
+
+done:
+	free(ref);
+	free(result);
+	free(atoms);
+	free(images);
+	free(summaries);
+	free(arena);
+}
+
+typedef struct {
+	const Corpus* corpus;
+	uint32_t first;         // Images first .. first + count - 1 of the corpus are timed
+	uint32_t count;
+	ParsedEeprom* result;
+	AtomView* atoms;
+	uint8_t* stream_buffer;
+	EepromImage* images;
+	EepromSummary* summaries;
+	char* arena;
+	uint32_t arena_size;
+} MeasureContext;
+
+typedef void (*MeasureFunc)(MeasureContext* ctx);
+
+static void measure_parse(MeasureContext* ctx) {
+	for (uint32_t i = ctx->first; i < ctx->first + ctx->count; i++)
+		fuzz_sink += (uint32_t)parse_rpi_hat_eeprom_ex(ctx->corpus->images[i].data, ctx->corpus->images[i].size,
+													   PARSE_FLAG_GENERIC, ctx->result, NULL);
+}
+
+// Default flags: registered layouts are used
+static void measure_parse_layout(MeasureContext* ctx) {
+	for (uint32_t i = ctx->first; i < ctx->first + ctx->count; i++)
+		fuzz_sink += (uint32_t)parse_rpi_hat_eeprom(ctx->corpus->images[i].data, ctx->corpus->images[i].size,
+													ctx->result);
+}
+
+static void measure_parse_crc(MeasureContext* ctx) {
+	for (uint32_t i = ctx->first; i < ctx->first + ctx->count; i++)
+		fuzz_sink += (uint32_t)parse_rpi_hat_eeprom_ex(ctx->corpus->images[i].data, ctx->corpus->images[i].size,
+													   PARSE_FLAG_GENERIC | PARSE_FLAG_VERIFY_CRC, ctx->result, NULL);
+}
+
+static void measure_stream(MeasureContext* ctx) {
+	for (uint32_t i = ctx->first; i < ctx->first + ctx->count; i++) {
+		const FuzzImage* image = &ctx->corpus->images[i];
+		StreamParser stream;
+		if (stream_parser_init(&stream, ctx->stream_buffer, image->size, STREAM_WANT_ALL, ctx->result) != PARSE_OK)
+			continue;
+		for (uint32_t fed = 0; fed < image->size && stream.status == STREAM_NEED_MORE; fed += MAX_STREAM_CHUNK) {
+			uint32_t chunk = (image->size - fed < MAX_STREAM_CHUNK) ? image->size - fed : MAX_STREAM_CHUNK;
+			stream_parser_feed(&stream, image->data + fed, chunk);
+		}
+		fuzz_sink += (uint32_t)stream_parser_finish(&stream);
+	}
+}
+
+static void measure_index(MeasureContext* ctx) {
+	for (uint32_t i = ctx->first; i < ctx->first + ctx->count; i++) {
+		uint32_t num_atoms;
+		fuzz_sink += (uint32_t)index_rpi_hat_eeprom(ctx->corpus->images[i].data, ctx->corpus->images[i].size, NULL,
+													ctx->atoms, MAX_INDEX_ATOMS, &num_atoms);
+		fuzz_sink += num_atoms;
+	}
+}
+
+static void measure_batch(MeasureContext* ctx) {
+	fuzz_sink += (uint32_t)parse_rpi_hat_eeprom_batch_mt(ctx->images + ctx->first, ctx->count, ctx->summaries, ctx->arena,
+														 ctx->arena_size, NULL, FUZZ_THREADS);
+}
+
+// MB/s over the context's images, run until MIN_MEASURE_NS has passed
+static double measure(MeasureFunc func, MeasureContext* ctx) {
+	uint64_t bytes = 0;
+	for (uint32_t i = ctx->first; i < ctx->first + ctx->count; i++)
+		bytes += ctx->corpus->images[i].size;
+
+	uint64_t iterations = 1;
+	for (;;) {
+		uint64_t start = now_ns();
+		for (uint64_t i = 0; i < iterations; i++)
+			func(ctx);
+		uint64_t elapsed = now_ns() - start;
+
+		if (elapsed >= MIN_MEASURE_NS)
+			return (double)(bytes * iterations) * 1000.0 / (double)elapsed;
+
+		iterations *= 2;
+	}
+}
+
+static int load_baseline(const char* path, const char* name, double* mb_per_s) {
+	FILE* f = fopen(path, "r");
+	if (f == NULL)
+		return -1;
+
+	char line[128];
+	int found = -1;
+	while (found != 0 && fgets(line, sizeof(line), f) != NULL) {
+		char* sep = strrchr(line, ' ');
+		size_t name_len = strlen(name);
+		if (sep != NULL && (size_t)(sep - line) == name_len && strncmp(line, name, name_len) == 0) {
+			*mb_per_s = strtod(sep + 1, NULL);
+			found = 0;
+		}
+	}
+
+	fclose(f);
+	return found;
+}
+
+static int save_baseline(const char* path, const Throughput* results, uint32_t count) {
+	FILE* f = fopen(path, "w");
+	if (f == NULL)
+		return -1;
+
+	for (uint32_t i = 0; i < count; i++)
+		fprintf(f, "%s %.1f\n", results[i].name, results[i].mb_per_s);
+
+	fclose(f);
+	return 0;
+}
+
+// Time every path on the seeds (first num_seeds images) and the parser on the rest; returns the number of regressions
+static uint32_t check_throughput(const Corpus* corpus, uint32_t num_seeds, const char* baseline, int update,
+								 double tolerance) {
+	static const struct {
+		const char* name;
+		MeasureFunc func;
+		int mutants;        // Time the truncated and mutated images instead of the seeds
+		int layouts;        // Register the seed layouts first
+	} paths[] = {
+		{ "parse_generic", measure_parse, 0, 0 },
+		{ "parse_generic_crc", measure_parse_crc, 0, 0 },
+		{ "parse_layout", measure_parse_layout, 0, 1 },
+		{ "stream_64b_chunks", measure_stream, 0, 0 },
+		{ "index", measure_index, 0, 0 },
+		{ "batch_mt", measure_batch, 0, 0 },
+		{ "parse_generic_mutants", measure_parse, 1, 0 },
+	};
+	const uint32_t num_paths = sizeof(paths) / sizeof(paths[0]);
+
+	uint32_t max_size = 0;
+	for (uint32_t i = 0; i < corpus->count; i++) {
+		if (corpus->images[i].size > max_size)
+			max_size = corpus->images[i].size;
+	}
+
+	MeasureContext ctx;
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.corpus = corpus;
+	ctx.result = (ParsedEeprom*)malloc(sizeof(ParsedEeprom));
+	ctx.atoms = (AtomView*)malloc(MAX_INDEX_ATOMS * sizeof(AtomView));
+	ctx.stream_buffer = (uint8_t*)malloc(max_size);
+	ctx.images = (EepromImage*)malloc(corpus->count * sizeof(EepromImage));
+	ctx.summaries = (EepromSummary*)malloc(corpus->count * sizeof(EepromSummary));
+	ctx.arena_size = num_seeds * 1024;
+	ctx.arena = (char*)malloc(ctx.arena_size);
+
+	Throughput results[sizeof(paths) / sizeof(paths[0])];
+	uint32_t num_results = 0;
+	uint32_t regressions = 0;
+
+	if (ctx.result == NULL || ctx.atoms == NULL || ctx.stream_buffer == NULL || ctx.images == NULL ||
+		ctx.summaries == NULL || ctx.arena == NULL) {
+		printf("  Out of memory\n");
+		regressions = 1;
+		goto done;
+	}
+
+	for (uint32_t i = 0; i < corpus->count; i++) {
+		ctx.images[i].data = corpus->images[i].data;
+		ctx.images[i].size = corpus->images[i].size;
+	}
+
+	for (uint32_t p = 0; p < num_paths; p++) {
+		ctx.first = paths[p].mutants ? num_seeds : 0;
+		ctx.count = paths[p].mutants ? corpus->count - num_seeds : num_seeds;
+		if (ctx.count == 0)
+			continue;
+
+		if (paths[p].layouts) {
+			uint32_t layout_id;
+			for (uint32_t i = 0; i < num_seeds; i++)
+				hat_layout_register(corpus->images[i].data, corpus->images[i].size, &layout_id);
+		}
+
+		Throughput* result = &results[num_results++];
+		result->name = paths[p].name;
+		result->mb_per_s = measure(paths[p].func, &ctx);
+		hat_layout_clear();
+
+		double expected = 0.0;
+		int have_baseline = (baseline != NULL && !update && load_baseline(baseline, result->name, &expected) == 0);
+		int regressed = have_baseline && result->mb_per_s < expected * (1.0 - tolerance / 100.0);
+		regressions += regressed ? 1 : 0;
+
+		if (have_baseline)
+			printf("  %-24s %10.1f MB/s   baseline %10.1f MB/s%s\n", result->name, result->mb_per_s, expected,
+				   regressed ? "   REGRESSION" : "");
+		else
+			printf("  %-24s %10.1f MB/s\n", result->name, result->mb_per_s);
+	}
+
+	if (baseline != NULL && update) {
+		if (save_baseline(baseline, results, num_results) == 0)
+			printf("  Baseline written to %s\n", baseline);
+		else
+			printf("  Cannot write baseline %s\n", baseline);
+	}
+
+done:
+	free(ctx.result);
+	free(ctx.atoms);
+	free(ctx.stream_buffer);
+	free(ctx.images);
+	free(ctx.summaries);
+	free(ctx.arena);
+	return regressions;
+}
+
+int main(int argc, char** argv) {
+	static const char* default_images[] = { "../original.bin", "../eeprom_settings_ad4080.bin" };
+	uint32_t num_mutants = DEFAULT_MUTANTS;
+	uint32_t seed = DEFAULT_SEED;
+	const char* baseline = NULL;
+	int update = 0;
+	double tolerance = DEFAULT_TOLERANCE;
+	const char* paths[64];
+	uint32_t num_paths = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			num_mutants = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+			seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+			baseline = argv[++i];
+		else if (strcmp(argv[i], "-u") == 0)
+			update = 1;
+		else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+			tolerance = strtod(argv[++i], NULL);
+		else if (argv[i][0] == '-') {
+			printf("Usage: %s [-n mutants] [-s seed] [-b baseline.txt] [-u] [-t tolerance_pct] [image.bin ...]\n", argv[0]);
+			return 2;
+		} else if (num_paths < sizeof(paths) / sizeof(paths[0]))
+			paths[num_paths++] = argv[i];
+	}
+
+	if (num_paths == 0) {
+		for (uint32_t i = 0; i < sizeof(default_images) / sizeof(default_images[0]); i++)
+			paths[num_paths++] = default_images[i];
+	}
+
+	Corpus corpus;
+	memset(&corpus, 0, sizeof(corpus));
+
+	for (uint32_t i = 0; i < num_paths; i++) {
+		if (load_image(&corpus, paths[i]) != 0)
+			printf("Skipping %s (cannot read file)\n", paths[i]);
+	}
+
+	if (build_synthetic(&corpus) != 0) {
+		printf("Cannot build the synthetic images\n");
+		corpus_free(&corpus);
+		return 1;
+	}
+
+	// Seeds are timed as the valid corpus; truncations and mutants only go through the checks
+	uint32_t num_seeds = corpus.count;
+	add_truncated(&corpus, num_seeds);
+	add_mutants(&corpus, num_seeds, num_mutants, seed);
+
+	// Register every seed's layout so mutants that still match one exercise the fixed-offset path
+	uint32_t layout_id;
+	for (uint32_t i = 0; i < num_seeds; i++)
+		hat_layout_register(corpus.images[i].data, corpus.images[i].size, &layout_id);
+
+	printf("Consistency (%u seeds, %u mutants, seed 0x%08X)\n", (unsigned)num_seeds, (unsigned)num_mutants,
+		   (unsigned)seed);
+	check_corpus(&corpus, seed);
+	hat_layout_clear();
+
+	uint32_t failed_checks = mismatches;
+	printf("  %u mismatch%s\n", (unsigned)failed_checks, failed_checks == 1 ? "" : "es");
+
+	printf("\nThroughput (%u valid images, %u threads for batch_mt)\n", (unsigned)num_seeds, (unsigned)FUZZ_THREADS);
+	uint32_t regressions = check_throughput(&corpus, num_seeds, baseline, update, tolerance);
+
+	corpus_free(&corpus);
+
+	if (failed_checks > 0 || regressions > 0) {
+		printf("\nFAILED: %u mismatch(es), %u throughput regression(s)\n", (unsigned)failed_checks,
+			   (unsigned)regressions);
+		return 1;
+	}
+
+	printf("\nPASSED\n");
+	return 0;
+}
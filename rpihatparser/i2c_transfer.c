@@ -0,0 +1,1241 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "i2c_transfer.h"
+#include "thread_compat.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <time.h>
+#endif
+
+#define VERIFY_CHUNK_SIZE 256
+#define ERASE_SCAN_BLOCK 1024   // Multiple of every page size, so scan blocks end on page boundaries
+
+#define FF_8   0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+#define FF_64  FF_8, FF_8, FF_8, FF_8, FF_8, FF_8, FF_8, FF_8
+
+static const uint8_t erased_page[I2C_EEPROM_MAX_PAGE_SIZE] = { FF_64, FF_64, FF_64, FF_64 };
+
+static const EepromGeometry eeprom_geometries[] = {
+	// name      capacity page addr block tWR
+	{ "24C01",     128,     8,   1,   0,    5 },
+	{ "24C02",     256,     8,   1,   0,    5 },
+	{ "24C04",     512,    16,   1,   1,    5 },
+	{ "24C08",    1024,    16,   1,   2,    5 },
+	{ "24C16",    2048,    16,   1,   3,    5 },
+	{ "24C32",    4096,    32,   2,   0,    5 },
+	{ "24C64",    8192,    32,   2,   0,    5 },
+	{ "24C128",  16384,    64,   2,   0,    5 },
+	{ "24C256",  32768,    64,   2,   0,    5 },
+	{ "24C512",  65536,   128,   2,   0,    5 },
+	{ "24CM01", 131072,   256,   2,   1,    5 },
+	{ "24CM02", 262144,   256,   2,   2,   10 },
+};
+
+#define NUM_EEPROM_GEOMETRIES (sizeof(eeprom_geometries) / sizeof(eeprom_geometries[0]))
+
+typedef uint32_t (*I2C_DeviceRead_t)(void* handle, uint32_t device_address, uint32_t size_to_transfer,
+									 uint8_t* buffer, uint32_t* size_transferred, uint32_t options);
+typedef uint32_t (*I2C_DeviceWrite_t)(void* handle, uint32_t device_address, uint32_t size_to_transfer,
+									  uint8_t* buffer, uint32_t* size_transferred, uint32_t options);
+
+typedef uint32_t (*I2C_GetNumChannels_t)(uint32_t* num_channels);
+typedef uint32_t (*I2C_OpenChannel_t)(uint32_t index, void** handle);
+typedef uint32_t (*I2C_InitChannel_t)(void* handle, MpsseChannelConfig* config);
+typedef uint32_t (*I2C_CloseChannel_t)(void* handle);
+
+static I2C_DeviceRead_t mpsse_device_read = NULL;
+static I2C_DeviceWrite_t mpsse_device_write = NULL;
+static I2C_GetNumChannels_t mpsse_get_num_channels = NULL;
+static I2C_OpenChannel_t mpsse_open_channel = NULL;
+static I2C_InitChannel_t mpsse_init_channel = NULL;
+static I2C_CloseChannel_t mpsse_close_channel = NULL;
+
+static void* load_symbol(void* module, const char* name) {
+#ifdef _WIN32
+	return (void*)GetProcAddress((HMODULE)module, name);
+#else
+	return dlsym(module, name);
+#endif
+}
+
+static uint64_t now_us(void) {
+#ifdef _WIN32
+	LARGE_INTEGER freq, counter;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / freq.QuadPart) * 1000000u +
+		   (uint64_t)(counter.QuadPart % freq.QuadPart) * 1000000u / (uint64_t)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
+
+static uint32_t stats_bucket(uint64_t us) {
+	uint32_t bucket = 0;
+	while (us > 0 && bucket < I2C_STATS_BUCKETS - 1) {
+		us >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+static void stats_record_transfer(I2cStats* stats, uint64_t elapsed_us, uint32_t ret) {
+	stats->transactions++;
+	stats->transfer_us += elapsed_us;
+	stats->transfer_hist[stats_bucket(elapsed_us)]++;
+	if (elapsed_us > stats->max_transfer_us)
+		stats->max_transfer_us = (uint32_t)elapsed_us;
+	if (ret != 0)
+		stats->errors++;
+}
+
+// All data transfers go through these two so an attached I2cStats sees every byte
+static uint32_t device_read(I2cEepromDevice* dev, uint32_t device, uint32_t size, uint8_t* buffer,
+							uint32_t* transferred, uint32_t options) {
+	I2cStats* stats = dev->stats;
+	if (stats == NULL)
+		return mpsse_device_read(dev->handle, device, size, buffer, transferred, options);
+
+	uint64_t start = now_us();
+	uint32_t ret = mpsse_device_read(dev->handle, device, size, buffer, transferred, options);
+	stats_record_transfer(stats, now_us() - start, ret);
+	stats->bytes_read += *transferred;
+	return ret;
+}
+
+static uint32_t device_write(I2cEepromDevice* dev, uint32_t device, uint32_t size, uint8_t* buffer,
+							 uint32_t* transferred, uint32_t options) {
+	I2cStats* stats = dev->stats;
+	if (stats == NULL)
+		return mpsse_device_write(dev->handle, device, size, buffer, transferred, options);
+
+	uint64_t start = now_us();
+	uint32_t ret = mpsse_device_write(dev->handle, device, size, buffer, transferred, options);
+	stats_record_transfer(stats, now_us() - start, ret);
+	stats->bytes_written += *transferred;
+	return ret;
+}
+
+int i2c_transfer_load(const char* libmpsse_path) {
+	if (libmpsse_path == NULL) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+#ifdef _WIN32
+	void* module = (void*)LoadLibraryA(libmpsse_path);
+#else
+	void* module = dlopen(libmpsse_path, RTLD_NOW);
+#endif
+	if (module == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	mpsse_device_read = (I2C_DeviceRead_t)load_symbol(module, "I2C_DeviceRead");
+	mpsse_device_write = (I2C_DeviceWrite_t)load_symbol(module, "I2C_DeviceWrite");
+
+	if (mpsse_device_read == NULL || mpsse_device_write == NULL) {
+		mpsse_device_read = NULL;
+		mpsse_device_write = NULL;
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	// Channel management is only needed by the multi-channel runner
+	mpsse_get_num_channels = (I2C_GetNumChannels_t)load_symbol(module, "I2C_GetNumChannels");
+	mpsse_open_channel = (I2C_OpenChannel_t)load_symbol(module, "I2C_OpenChannel");
+	mpsse_init_channel = (I2C_InitChannel_t)load_symbol(module, "I2C_InitChannel");
+	mpsse_close_channel = (I2C_CloseChannel_t)load_symbol(module, "I2C_CloseChannel");
+
+	return XFER_OK;
+}
+
+void i2c_eeprom_init(I2cEepromDevice* dev, void* handle, uint32_t slave_address) {
+	if (dev == NULL)
+		return;
+
+	memset(dev, 0, sizeof(I2cEepromDevice));
+	dev->handle = handle;
+	dev->slave_address = slave_address;
+	dev->page_size = I2C_EEPROM_DEFAULT_PAGE_SIZE;
+	dev->write_timeout_ms = I2C_EEPROM_DEFAULT_WRITE_TIMEOUT_MS;
+	dev->address_bytes = 2;
+}
+
+uint32_t eeprom_geometry_count(void) {
+	return (uint32_t)NUM_EEPROM_GEOMETRIES;
+}
+
+const EepromGeometry* eeprom_geometry_get(uint32_t index) {
+	if (index >= NUM_EEPROM_GEOMETRIES)
+		return NULL;
+	return &eeprom_geometries[index];
+}
+
+static int names_equal(const char* a, const char* b) {
+	for (; *a && *b; a++, b++) {
+		char ca = (*a >= 'a' && *a <= 'z') ? (char)(*a - 'a' + 'A') : *a;
+		char cb = (*b >= 'a' && *b <= 'z') ? (char)(*b - 'a' + 'A') : *b;
+		if (ca != cb)
+			return 0;
+	}
+	return *a == *b;
+}
+
+const EepromGeometry* eeprom_geometry_find(const char* name) {
+	if (name == NULL)
+		return NULL;
+
+	for (uint32_t i = 0; i < NUM_EEPROM_GEOMETRIES; i++) {
+		if (names_equal(name, eeprom_geometries[i].name))
+			return &eeprom_geometries[i];
+	}
+
+	return NULL;
+}
+
+int i2c_eeprom_set_geometry(I2cEepromDevice* dev, const EepromGeometry* geometry) {
+	if (dev == NULL || geometry == NULL || geometry->page_size == 0 ||
+		geometry->page_size > I2C_EEPROM_MAX_PAGE_SIZE ||
+		(geometry->address_bytes != 1 && geometry->address_bytes != 2) || geometry->block_bits > 3) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	dev->page_size = geometry->page_size;
+	dev->capacity = geometry->capacity;
+	dev->address_bytes = geometry->address_bytes;
+	dev->block_bits = geometry->block_bits;
+
+	// ACK polling returns as soon as the part is ready; the timeout only bounds a dead part
+	uint32_t timeout_ms = 2u * geometry->write_cycle_ms;
+	dev->write_timeout_ms = (timeout_ms > I2C_EEPROM_DEFAULT_WRITE_TIMEOUT_MS) ? timeout_ms
+																			   : I2C_EEPROM_DEFAULT_WRITE_TIMEOUT_MS;
+	return XFER_OK;
+}
+
+static uint32_t word_address_bytes(const I2cEepromDevice* dev) {
+	return (dev->address_bytes == 1) ? 1u : 2u;
+}
+
+// Bytes addressed by the word address alone; a block boundary needs a new device address
+static uint32_t block_span(const I2cEepromDevice* dev) {
+	return 1u << (8u * word_address_bytes(dev));
+}
+
+// Split an EEPROM address into the device address and the word-address bytes
+static uint32_t encode_address(const I2cEepromDevice* dev, uint32_t addr, uint8_t* word) {
+	uint32_t word_bytes = word_address_bytes(dev);
+	uint32_t high = (addr >> (8u * word_bytes)) & ((1u << dev->block_bits) - 1u);
+
+	if (word_bytes == 1) {
+		word[0] = (uint8_t)(addr & 0xFF);
+	} else {
+		word[0] = (uint8_t)((addr >> 8) & 0xFF);
+		word[1] = (uint8_t)(addr & 0xFF);
+	}
+
+	return dev->slave_address | high;
+}
+
+static int range_ok(const I2cEepromDevice* dev, uint32_t start_addr, uint32_t length) {
+	return dev->capacity == 0 || (start_addr <= dev->capacity && length <= dev->capacity - start_addr);
+}
+
+int i2c_eeprom_wait_ready(I2cEepromDevice* dev, uint32_t timeout_ms) {
+	if (dev == NULL) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_read == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	uint64_t start = now_us();
+	uint64_t deadline = start + (uint64_t)timeout_ms * 1000u;
+	uint32_t polls = 0;
+	int result;
+
+	for (;;) {
+		// Same one-byte probe as the bus scan; a busy EEPROM NACKs its address
+		uint8_t probe = 0;
+		uint32_t transferred = 0;
+		uint32_t ret = mpsse_device_read(dev->handle, dev->slave_address, 1, &probe, &transferred,
+										 I2C_START_BIT | I2C_STOP_BIT);
+		polls++;
+		if (ret == 0) {
+			result = XFER_OK;
+			break;
+		}
+
+		if (now_us() >= deadline) {
+			result = XFER_ERROR_WRITE_TIMEOUT;
+			break;
+		}
+	}
+
+	I2cStats* stats = dev->stats;
+	if (stats != NULL) {
+		uint64_t elapsed_us = now_us() - start;
+		stats->transactions += polls;
+		stats->waits++;
+		stats->ack_polls += polls;
+		stats->poll_retries += polls - 1;
+		stats->wait_us += elapsed_us;
+		stats->wait_hist[stats_bucket(elapsed_us)]++;
+		if (elapsed_us > stats->max_wait_us)
+			stats->max_wait_us = (uint32_t)elapsed_us;
+		if (result != XFER_OK)
+			stats->timeouts++;
+	}
+
+	return result;
+}
+
+static int read_in_block(I2cEepromDevice* dev, uint32_t addr, uint8_t* buffer, uint32_t length) {
+	// Address write without STOP, then a repeated START for the sequential read
+	uint8_t addr_buf[2];
+	uint32_t device = encode_address(dev, addr, addr_buf);
+	uint32_t transferred = 0;
+
+	uint32_t ret = device_write(dev, device, word_address_bytes(dev), addr_buf, &transferred,
+								I2C_START_BIT | I2C_FAST_TRANSFER_BYTES);
+	if (ret != 0)
+		return (int)ret;
+
+	transferred = 0;
+	ret = device_read(dev, device, length, buffer, &transferred,
+					  I2C_START_BIT | I2C_STOP_BIT | I2C_FAST_TRANSFER_BYTES);
+	if (ret != 0)
+		return (int)ret;
+
+	if (transferred != length)
+		return XFER_ERROR_SHORT_TRANSFER;
+
+	return XFER_OK;
+}
+
+int i2c_eeprom_read(I2cEepromDevice* dev, uint32_t start_addr, uint8_t* buffer, uint32_t length) {
+	if (dev == NULL || (buffer == NULL && length > 0) || !range_ok(dev, start_addr, length)) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_read == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	uint32_t span = block_span(dev);
+	uint32_t offset = 0;
+
+	while (offset < length) {
+		uint32_t addr = start_addr + offset;
+		uint32_t chunk = span - (addr % span);
+		if (chunk > length - offset)
+			chunk = length - offset;
+
+		int ret = read_in_block(dev, addr, &buffer[offset], chunk);
+		if (ret != XFER_OK)
+			return ret;
+
+		offset += chunk;
+	}
+
+	return XFER_OK;
+}
+
+typedef struct {
+	I2cEepromDevice* dev;
+	uint32_t start_addr;
+	uint32_t block_size;
+	uint8_t slots[2][I2C_PIPELINE_MAX_BLOCK];
+	uint32_t slot_len[2];
+	int slot_full[2];
+	uint32_t limit;         // Bytes to read in total, lowered once eeplen is known
+	int stop;               // Parser needs no more bytes
+	int reader_done;
+	int read_status;
+	thread_mutex_t lock;
+	thread_cond_t changed;
+} ReadPipeline;
+
+static void pipeline_reader(void* arg) {
+	ReadPipeline* pipe = (ReadPipeline*)arg;
+	uint32_t offset = 0;
+	int slot = 0;
+
+	thread_mutex_lock(&pipe->lock);
+	for (;;) {
+		while (pipe->slot_full[slot] && !pipe->stop)
+			thread_cond_wait(&pipe->changed, &pipe->lock);
+
+		if (pipe->stop || offset >= pipe->limit)
+			break;
+
+		uint32_t chunk = pipe->limit - offset;
+		if (chunk > pipe->block_size)
+			chunk = pipe->block_size;
+
+		// The bus transfer runs unlocked while the parser works on the other slot
+		thread_mutex_unlock(&pipe->lock);
+		int ret = i2c_eeprom_read(pipe->dev, pipe->start_addr + offset, pipe->slots[slot], chunk);
+		thread_mutex_lock(&pipe->lock);
+
+		if (ret != XFER_OK) {
+			pipe->read_status = ret;
+			break;
+		}
+
+		pipe->slot_len[slot] = chunk;
+		pipe->slot_full[slot] = 1;
+		thread_cond_broadcast(&pipe->changed);
+
+		offset += chunk;
+		slot ^= 1;
+	}
+
+	pipe->reader_done = 1;
+	thread_cond_broadcast(&pipe->changed);
+	thread_mutex_unlock(&pipe->lock);
+}
+
+// Called with pipe->lock held after a block was fed
+static void pipeline_update_limit(ReadPipeline* pipe, const StreamParser* ctx, int state) {
+	if (state != STREAM_NEED_MORE) {
+		pipe->stop = 1;
+	} else if (ctx->header_done) {
+		uint32_t eeplen = ctx->result->header.eeplen;
+		if (eeplen >= FIRST_ATOM_OFFSET && eeplen < pipe->limit)
+			pipe->limit = eeplen;
+	}
+}
+
+static void pipeline_consume(ReadPipeline* pipe, StreamParser* ctx) {
+	int slot = 0;
+
+	thread_mutex_lock(&pipe->lock);
+	while (!pipe->stop) {
+		while (!pipe->slot_full[slot] && !pipe->reader_done)
+			thread_cond_wait(&pipe->changed, &pipe->lock);
+
+		if (!pipe->slot_full[slot])
+			break;
+
+		thread_mutex_unlock(&pipe->lock);
+		int state = stream_parser_feed(ctx, pipe->slots[slot], pipe->slot_len[slot]);
+		thread_mutex_lock(&pipe->lock);
+
+		pipe->slot_full[slot] = 0;
+		pipeline_update_limit(pipe, ctx, state);
+		thread_cond_broadcast(&pipe->changed);
+		slot ^= 1;
+	}
+	thread_mutex_unlock(&pipe->lock);
+}
+
+// Same loop without the I/O thread, used if the thread cannot be created
+static void pipeline_run_serial(ReadPipeline* pipe, StreamParser* ctx) {
+	uint32_t offset = 0;
+
+	while (!pipe->stop && offset < pipe->limit) {
+		uint32_t chunk = pipe->limit - offset;
+		if (chunk > pipe->block_size)
+			chunk = pipe->block_size;
+
+		int ret = i2c_eeprom_read(pipe->dev, pipe->start_addr + offset, pipe->slots[0], chunk);
+		if (ret != XFER_OK) {
+			pipe->read_status = ret;
+			break;
+		}
+
+		int state = stream_parser_feed(ctx, pipe->slots[0], chunk);
+		pipeline_update_limit(pipe, ctx, state);
+		offset += chunk;
+	}
+}
+
+int i2c_eeprom_read_parse(I2cEepromDevice* dev, uint32_t start_addr, uint8_t* buffer, uint32_t capacity,
+						  uint32_t block_size, uint32_t flags, ParsedEeprom* result,
+						  ParseIntegrity* integrity, uint32_t* bytes_read) {
+	if (bytes_read)
+		*bytes_read = 0;
+
+	if (dev == NULL || buffer == NULL || result == NULL || block_size > I2C_PIPELINE_MAX_BLOCK) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_read == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	StreamParser ctx;
+	int ret = stream_parser_init_ex(&ctx, buffer, capacity, STREAM_WANT_ALL, flags, result);
+	if (ret != PARSE_OK)
+		return ret;
+
+	ReadPipeline* pipe = (ReadPipeline*)malloc(sizeof(ReadPipeline));
+	if (pipe == NULL)
+		return XFER_ERROR_NO_MEMORY;
+
+	memset(pipe, 0, sizeof(ReadPipeline));
+	pipe->dev = dev;
+	pipe->start_addr = start_addr;
+	pipe->block_size = block_size ? block_size : I2C_PIPELINE_DEFAULT_BLOCK;
+	pipe->limit = (dev->capacity && dev->capacity < capacity) ? dev->capacity : capacity;
+	pipe->read_status = XFER_OK;
+	thread_mutex_init(&pipe->lock);
+	thread_cond_init(&pipe->changed);
+
+	thread_t reader;
+	if (thread_start(&reader, pipeline_reader, pipe) == 0) {
+		pipeline_consume(pipe, &ctx);
+
+		// Release the reader if it is waiting for a free slot
+		thread_mutex_lock(&pipe->lock);
+		pipe->stop = 1;
+		thread_cond_broadcast(&pipe->changed);
+		thread_mutex_unlock(&pipe->lock);
+		thread_join(&reader);
+	} else {
+		pipeline_run_serial(pipe, &ctx);
+	}
+
+	// A failed read past the end of the atom chain does not matter
+	if (pipe->read_status != XFER_OK && ctx.status == STREAM_NEED_MORE)
+		ret = pipe->read_status;
+	else
+		ret = stream_parser_finish(&ctx);
+
+	thread_cond_destroy(&pipe->changed);
+	thread_mutex_destroy(&pipe->lock);
+	free(pipe);
+
+	if (integrity)
+		*integrity = ctx.integrity;
+	if (bytes_read)
+		*bytes_read = ctx.length;
+
+	return ret;
+}
+
+// One page write (length must not cross a page) followed by ACK polling until its write cycle completes
+static int write_page(I2cEepromDevice* dev, uint32_t addr, const uint8_t* data, uint32_t length) {
+	uint8_t write_buf[2 + I2C_EEPROM_MAX_PAGE_SIZE];
+	uint32_t word_bytes = word_address_bytes(dev);
+
+	// Pages never straddle a block, so one device address covers the whole page
+	uint32_t device = encode_address(dev, addr, write_buf);
+	memcpy(&write_buf[word_bytes], data, length);
+
+	uint32_t transferred = 0;
+	uint32_t ret = device_write(dev, device, word_bytes + length, write_buf,
+								&transferred, I2C_START_BIT | I2C_STOP_BIT | I2C_FAST_TRANSFER_BYTES);
+	if (ret != 0)
+		return (int)ret;
+
+	if (transferred != word_bytes + length)
+		return XFER_ERROR_SHORT_TRANSFER;
+
+	return i2c_eeprom_wait_ready(dev, dev->write_timeout_ms);
+}
+
+static int write_args_ok(const I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* data, uint32_t length) {
+	return dev != NULL && (data != NULL || length == 0) &&
+		   dev->page_size != 0 && dev->page_size <= I2C_EEPROM_MAX_PAGE_SIZE && range_ok(dev, start_addr, length);
+}
+
+int i2c_eeprom_write(I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* data, uint32_t length) {
+	if (!write_args_ok(dev, start_addr, data, length)) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_write == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	uint32_t offset = 0;
+
+	while (offset < length) {
+		uint32_t addr = start_addr + offset;
+		uint32_t bytes_remaining_in_page = dev->page_size - (addr % dev->page_size);
+		uint32_t bytes_to_write = length - offset;
+		if (bytes_to_write > bytes_remaining_in_page)
+			bytes_to_write = bytes_remaining_in_page;
+
+		int ret = write_page(dev, addr, &data[offset], bytes_to_write);
+		if (ret != XFER_OK)
+			return ret;
+
+		offset += bytes_to_write;
+	}
+
+	return XFER_OK;
+}
+
+static int blocks_equal(const uint8_t* a, const uint8_t* b, uint32_t length) {
+	uint64_t diff = 0;
+	uint32_t i = 0;
+
+	// Branch-free 8-byte lanes; the compiler vectorizes this loop
+	for (; i + 8 <= length; i += 8) {
+		uint64_t wa, wb;
+		memcpy(&wa, a + i, 8);
+		memcpy(&wb, b + i, 8);
+		diff |= wa ^ wb;
+	}
+
+	for (; i < length; i++)
+		diff |= (uint64_t)(a[i] ^ b[i]);
+
+	return diff == 0;
+}
+
+static int block_is_blank(const uint8_t* data, uint32_t length) {
+	uint64_t all = ~(uint64_t)0;
+	uint32_t i = 0;
+
+	// Same 8-byte lanes as blocks_equal; AND-reduces to all ones only if every byte is 0xFF
+	for (; i + 8 <= length; i += 8) {
+		uint64_t word;
+		memcpy(&word, data + i, 8);
+		all &= word;
+	}
+
+	for (; i < length; i++)
+		all &= (uint64_t)data[i] | ~(uint64_t)0xFF;
+
+	return all == ~(uint64_t)0;
+}
+
+int i2c_eeprom_erase(I2cEepromDevice* dev, uint32_t start_addr, uint32_t length, uint32_t flags,
+					 uint32_t* pages_written) {
+	if (pages_written)
+		*pages_written = 0;
+
+	if (dev == NULL || dev->page_size == 0 || dev->page_size > I2C_EEPROM_MAX_PAGE_SIZE) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (length == 0) {
+		if (dev->capacity == 0 || start_addr >= dev->capacity)
+			return XFER_ERROR_INVALID_ARG;
+		length = dev->capacity - start_addr;
+	}
+
+	if (!range_ok(dev, start_addr, length))
+		return XFER_ERROR_INVALID_ARG;
+
+	uint8_t scan[ERASE_SCAN_BLOCK];
+	uint32_t written = 0;
+	uint32_t offset = 0;
+	int ret = XFER_OK;
+
+	while (ret == XFER_OK && offset < length) {
+		uint32_t addr = start_addr + offset;
+		uint32_t block = ERASE_SCAN_BLOCK - (addr % ERASE_SCAN_BLOCK);
+		if (block > length - offset)
+			block = length - offset;
+
+		if (flags & ERASE_SKIP_BLANK) {
+			ret = i2c_eeprom_read(dev, addr, scan, block);
+			if (ret != XFER_OK)
+				break;
+		}
+
+		uint32_t in_block = 0;
+		while (in_block < block) {
+			uint32_t page_addr = addr + in_block;
+			uint32_t chunk = dev->page_size - (page_addr % dev->page_size);
+			if (chunk > block - in_block)
+				chunk = block - in_block;
+
+			if (!(flags & ERASE_SKIP_BLANK) || !block_is_blank(&scan[in_block], chunk)) {
+				ret = i2c_eeprom_write(dev, page_addr, erased_page, chunk);
+				if (ret != XFER_OK)
+					break;
+				written++;
+			}
+
+			in_block += chunk;
+		}
+
+		offset += block;
+	}
+
+	if (pages_written)
+		*pages_written = written;
+
+	return ret;
+}
+
+uint32_t eeprom_diff_pages(const uint8_t* current, const uint8_t* target, uint32_t length,
+						   uint32_t start_addr, uint32_t page_size, uint8_t* page_bitmap) {
+	if (current == NULL || target == NULL || page_size == 0)
+		return 0;
+
+	uint32_t offset = 0;
+	uint32_t page = 0;
+	uint32_t changed = 0;
+
+	while (offset < length) {
+		uint32_t chunk = page_size - ((start_addr + offset) % page_size);
+		if (chunk > length - offset)
+			chunk = length - offset;
+
+		if (!blocks_equal(&current[offset], &target[offset], chunk)) {
+			if (page_bitmap)
+				page_bitmap[page / 8] |= (uint8_t)(1u << (page % 8));
+			changed++;
+		} else if (page_bitmap) {
+			page_bitmap[page / 8] &= (uint8_t)~(1u << (page % 8));
+		}
+
+		offset += chunk;
+		page++;
+	}
+
+	return changed;
+}
+
+static uint32_t count_differences(const uint8_t* a, const uint8_t* b, uint32_t length) {
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < length; i++)
+		count += (a[i] != b[i]);
+	return count;
+}
+
+int i2c_eeprom_program_verify(I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* data, uint32_t length,
+							  uint32_t max_retries, uint8_t* page_bitmap, uint32_t* pages_retried,
+							  uint32_t* mismatches) {
+	if (pages_retried)
+		*pages_retried = 0;
+	if (mismatches)
+		*mismatches = 0;
+
+	if (!write_args_ok(dev, start_addr, data, length)) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_read == NULL || mpsse_device_write == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	uint8_t readback[I2C_EEPROM_MAX_PAGE_SIZE];
+	uint32_t retried = 0;
+	uint32_t bad_bytes = 0;
+	uint32_t offset = 0;
+	uint32_t page = 0;
+
+	while (offset < length) {
+		uint32_t addr = start_addr + offset;
+		uint32_t chunk = dev->page_size - (addr % dev->page_size);
+		if (chunk > length - offset)
+			chunk = length - offset;
+
+		int ret = write_page(dev, addr, &data[offset], chunk);
+		int equal = 0;
+
+		for (uint32_t attempt = 0; ret == XFER_OK; attempt++) {
+			ret = read_in_block(dev, addr, readback, chunk);
+			if (ret != XFER_OK)
+				break;
+
+			equal = blocks_equal(readback, &data[offset], chunk);
+			if (equal || attempt == max_retries)
+				break;
+
+			retried++;
+			ret = write_page(dev, addr, &data[offset], chunk);
+		}
+
+		if (ret != XFER_OK) {
+			if (pages_retried)
+				*pages_retried = retried;
+			return ret;
+		}
+
+		if (!equal)
+			bad_bytes += count_differences(readback, &data[offset], chunk);
+
+		if (page_bitmap) {
+			if (equal)
+				page_bitmap[page / 8] &= (uint8_t)~(1u << (page % 8));
+			else
+				page_bitmap[page / 8] |= (uint8_t)(1u << (page % 8));
+		}
+
+		offset += chunk;
+		page++;
+	}
+
+	if (pages_retried)
+		*pages_retried = retried;
+	if (mismatches)
+		*mismatches = bad_bytes;
+
+	return (bad_bytes == 0) ? XFER_OK : XFER_ERROR_VERIFY_MISMATCH;
+}
+
+int i2c_eeprom_write_diff(I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* data, uint32_t length,
+						  uint32_t* pages_written) {
+	if (dev == NULL || (data == NULL && length > 0) ||
+		dev->page_size == 0 || dev->page_size > I2C_EEPROM_MAX_PAGE_SIZE) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (pages_written)
+		*pages_written = 0;
+
+	if (length == 0)
+		return XFER_OK;
+
+	uint8_t* current = (uint8_t*)malloc(length);
+	if (current == NULL)
+		return XFER_ERROR_NO_MEMORY;
+
+	int ret = i2c_eeprom_read(dev, start_addr, current, length);
+
+	uint32_t offset = 0;
+	uint32_t written = 0;
+
+	while (ret == XFER_OK && offset < length) {
+		uint32_t chunk = dev->page_size - ((start_addr + offset) % dev->page_size);
+		if (chunk > length - offset)
+			chunk = length - offset;
+
+		if (!blocks_equal(&current[offset], &data[offset], chunk)) {
+			ret = i2c_eeprom_write(dev, start_addr + offset, &data[offset], chunk);
+			written++;
+		}
+
+		offset += chunk;
+	}
+
+	free(current);
+
+	if (pages_written)
+		*pages_written = written;
+
+	return ret;
+}
+
+int i2c_eeprom_verify(I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* expected, uint32_t length,
+					  uint32_t* mismatches, uint32_t* first_mismatch) {
+	if (dev == NULL || (expected == NULL && length > 0)) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	uint8_t readback[VERIFY_CHUNK_SIZE];
+	uint32_t diff_count = 0;
+	uint32_t first_diff = 0;
+
+	for (uint32_t offset = 0; offset < length; offset += VERIFY_CHUNK_SIZE) {
+		uint32_t chunk = length - offset;
+		if (chunk > VERIFY_CHUNK_SIZE)
+			chunk = VERIFY_CHUNK_SIZE;
+
+		int ret = i2c_eeprom_read(dev, start_addr + offset, readback, chunk);
+		if (ret != XFER_OK)
+			return ret;
+
+		if (blocks_equal(readback, &expected[offset], chunk))
+			continue;
+
+		for (uint32_t i = 0; i < chunk; i++) {
+			if (readback[i] != expected[offset + i]) {
+				if (diff_count == 0)
+					first_diff = offset + i;
+				diff_count++;
+			}
+		}
+	}
+
+	if (mismatches)
+		*mismatches = diff_count;
+	if (first_mismatch)
+		*first_mismatch = first_diff;
+
+	return (diff_count == 0) ? XFER_OK : XFER_ERROR_VERIFY_MISMATCH;
+}
+
+static int probe_address(void* handle, uint32_t addr) {
+	uint8_t probe = 0;
+	uint32_t transferred = 0;
+	return mpsse_device_read(handle, addr, 1, &probe, &transferred, I2C_START_BIT | I2C_STOP_BIT) == 0;
+}
+
+int i2c_eeprom_find(I2cEepromDevice* dev) {
+	if (dev == NULL) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_read == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	for (uint32_t addr = I2C_EEPROM_SCAN_FIRST; addr <= I2C_EEPROM_SCAN_LAST; addr++) {
+		if (probe_address(dev->handle, addr)) {
+			dev->slave_address = addr;
+			return XFER_OK;
+		}
+	}
+
+	return XFER_ERROR_NO_DEVICE;
+}
+
+int i2c_bus_scan(void* handle, uint32_t first_addr, uint32_t last_addr, uint8_t* bitmap, uint32_t* found) {
+	if (found)
+		*found = 0;
+
+	if (bitmap == NULL || first_addr > last_addr || last_addr > 0x7F) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_read == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	memset(bitmap, 0, I2C_BUS_BITMAP_BYTES);
+	uint32_t count = 0;
+
+	for (uint32_t addr = first_addr; addr <= last_addr; addr++) {
+		if (probe_address(handle, addr)) {
+			bitmap[addr / 8] |= (uint8_t)(1u << (addr % 8));
+			count++;
+		}
+	}
+
+	if (found)
+		*found = count;
+
+	return XFER_OK;
+}
+
+int i2c_multi_channel_count(uint32_t* count) {
+	if (count == NULL) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	*count = 0;
+	if (mpsse_get_num_channels == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	return (int)mpsse_get_num_channels(count);
+}
+
+typedef struct {
+	ChannelJob* job;
+	const MultiChannelConfig* config;
+} ChannelWorker;
+
+// Clears the results and checks the buffers the operations need
+static int job_reset(ChannelJob* job) {
+	job->status = XFER_OK;
+	job->slave_address = 0;
+	job->pages_written = 0;
+	job->mismatches = 0;
+	job->elapsed_us = 0;
+
+	if (((job->operations & (MULTI_OP_PROGRAM | MULTI_OP_VERIFY)) && job->image == NULL && job->length > 0) ||
+		((job->operations & MULTI_OP_READ) && job->read_buffer == NULL && job->length > 0)) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	return XFER_OK;
+}
+
+static int run_channel_ops(I2cEepromDevice* dev, ChannelJob* job, int differential) {
+	int ret = XFER_OK;
+
+	if (job->operations & MULTI_OP_READ) {
+		ret = i2c_eeprom_read(dev, job->start_addr, job->read_buffer, job->length);
+		if (ret != XFER_OK)
+			return ret;
+	}
+
+	// Program and verify together: each page is checked right after its write cycle
+	if ((job->operations & MULTI_OP_PROGRAM) && (job->operations & MULTI_OP_VERIFY) && !differential) {
+		return i2c_eeprom_program_verify(dev, job->start_addr, job->image, job->length, I2C_PROGRAM_DEFAULT_RETRIES,
+										 NULL, &job->pages_written, &job->mismatches);
+	}
+
+	if (job->operations & MULTI_OP_PROGRAM) {
+		if (differential)
+			ret = i2c_eeprom_write_diff(dev, job->start_addr, job->image, job->length, &job->pages_written);
+		else
+			ret = i2c_eeprom_write(dev, job->start_addr, job->image, job->length);
+		if (ret != XFER_OK)
+			return ret;
+	}
+
+	if (job->operations & MULTI_OP_VERIFY) {
+		ret = i2c_eeprom_wait_ready(dev, dev->write_timeout_ms);
+		if (ret == XFER_OK)
+			ret = i2c_eeprom_verify(dev, job->start_addr, job->image, job->length, &job->mismatches, NULL);
+	}
+
+	return ret;
+}
+
+static void channel_worker(void* arg) {
+	ChannelWorker* worker = (ChannelWorker*)arg;
+	ChannelJob* job = worker->job;
+	const MultiChannelConfig* config = worker->config;
+	uint64_t start = now_us();
+
+	void* handle = NULL;
+	int ret = (int)mpsse_open_channel(job->channel_index, &handle);
+	if (ret == XFER_OK) {
+		MpsseChannelConfig channel_config = config->channel;
+		ret = (int)mpsse_init_channel(handle, &channel_config);
+
+		I2cEepromDevice dev;
+		i2c_eeprom_init(&dev, handle, config->slave_address);
+		if (ret == XFER_OK && config->geometry)
+			ret = i2c_eeprom_set_geometry(&dev, config->geometry);
+		if (config->page_size)
+			dev.page_size = config->page_size;
+		if (config->write_timeout_ms)
+			dev.write_timeout_ms = config->write_timeout_ms;
+		i2c_eeprom_attach_stats(&dev, job->stats);
+
+		if (ret == XFER_OK && config->slave_address == 0)
+			ret = i2c_eeprom_find(&dev);
+
+		job->slave_address = dev.slave_address;
+
+		if (ret == XFER_OK)
+			ret = run_channel_ops(&dev, job, config->differential);
+
+		mpsse_close_channel(handle);
+	}
+
+	job->status = ret;
+	job->elapsed_us = (uint32_t)(now_us() - start);
+}
+
+int i2c_multi_run(ChannelJob* jobs, uint32_t num_jobs, const MultiChannelConfig* config) {
+	if (jobs == NULL || config == NULL || num_jobs == 0 || num_jobs > MULTI_MAX_CHANNELS) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_read == NULL || mpsse_open_channel == NULL ||
+		mpsse_init_channel == NULL || mpsse_close_channel == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	for (uint32_t i = 0; i < num_jobs; i++) {
+		if (job_reset(&jobs[i]) != XFER_OK)
+			return XFER_ERROR_INVALID_ARG;
+	}
+
+	ChannelWorker workers[MULTI_MAX_CHANNELS];
+	thread_t threads[MULTI_MAX_CHANNELS];
+	int started[MULTI_MAX_CHANNELS];
+
+	for (uint32_t i = 0; i < num_jobs; i++) {
+		workers[i].job = &jobs[i];
+		workers[i].config = config;
+		started[i] = (thread_start(&threads[i], channel_worker, &workers[i]) == 0);
+	}
+
+	// A channel whose thread could not be created still runs, just serially
+	for (uint32_t i = 0; i < num_jobs; i++) {
+		if (started[i])
+			thread_join(&threads[i]);
+		else
+			channel_worker(&workers[i]);
+	}
+
+	for (uint32_t i = 0; i < num_jobs; i++) {
+		if (jobs[i].status != XFER_OK)
+			return jobs[i].status;
+	}
+
+	return XFER_OK;
+}
+
+struct I2cAsyncOp {
+	I2cEepromDevice* dev;
+	ChannelJob* job;
+	int differential;
+	AsyncCallback callback;
+	void* user_data;
+	thread_t thread;
+	int started;
+	thread_mutex_t lock;
+	thread_cond_t done_cond;
+	int done;
+};
+
+static void async_worker(void* arg) {
+	I2cAsyncOp* op = (I2cAsyncOp*)arg;
+	ChannelJob* job = op->job;
+	uint64_t start = now_us();
+
+	job->slave_address = op->dev->slave_address;
+	job->status = run_channel_ops(op->dev, job, op->differential);
+	job->elapsed_us = (uint32_t)(now_us() - start);
+
+	thread_mutex_lock(&op->lock);
+	op->done = 1;
+	thread_cond_broadcast(&op->done_cond);
+	thread_mutex_unlock(&op->lock);
+
+	// i2c_async_free joins this thread, so op outlives the callback. The callback may
+	// also free op itself, so nothing here touches op once it has been called.
+	if (op->callback)
+		op->callback(job, op->user_data);
+}
+
+int i2c_async_submit(I2cEepromDevice* dev, ChannelJob* job, int differential,
+					 AsyncCallback callback, void* user_data, I2cAsyncOp** op) {
+	if (op)
+		*op = NULL;
+
+	if (dev == NULL || job == NULL || op == NULL || job_reset(job) != XFER_OK) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	if (mpsse_device_read == NULL || mpsse_device_write == NULL) {
+		return XFER_ERROR_NOT_LOADED;
+	}
+
+	I2cAsyncOp* async_op = (I2cAsyncOp*)calloc(1, sizeof(I2cAsyncOp));
+	if (async_op == NULL) {
+		return XFER_ERROR_NO_MEMORY;
+	}
+
+	async_op->dev = dev;
+	async_op->job = job;
+	async_op->differential = differential;
+	async_op->callback = callback;
+	async_op->user_data = user_data;
+	thread_mutex_init(&async_op->lock);
+	thread_cond_init(&async_op->done_cond);
+
+	*op = async_op;
+
+	// The worker takes the lock before its callback, so holding it here keeps the
+	// callback from freeing op before started and the thread handle are stored
+	thread_mutex_lock(&async_op->lock);
+	int started = (thread_start(&async_op->thread, async_worker, async_op) == 0);
+	async_op->started = started;
+	thread_mutex_unlock(&async_op->lock);
+
+	// Like i2c_multi_run: without a thread the job still runs, just before returning.
+	// Either way async_op may already be freed by the callback from here on.
+	if (!started)
+		async_worker(async_op);
+
+	return XFER_OK;
+}
+
+int i2c_async_poll(I2cAsyncOp* op) {
+	if (op == NULL) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	thread_mutex_lock(&op->lock);
+	int ret = op->done ? op->job->status : XFER_PENDING;
+	thread_mutex_unlock(&op->lock);
+	return ret;
+}
+
+int i2c_async_wait(I2cAsyncOp* op, uint32_t timeout_ms) {
+	if (op == NULL) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	uint64_t deadline = now_us() + (uint64_t)timeout_ms * 1000u;
+
+	thread_mutex_lock(&op->lock);
+	while (!op->done) {
+		if (timeout_ms == I2C_ASYNC_WAIT_FOREVER) {
+			thread_cond_wait(&op->done_cond, &op->lock);
+			continue;
+		}
+
+		uint64_t now = now_us();
+		if (now >= deadline)
+			break;
+		thread_cond_timedwait(&op->done_cond, &op->lock, (uint32_t)((deadline - now + 999) / 1000));
+	}
+	int ret = op->done ? op->job->status : XFER_PENDING;
+	thread_mutex_unlock(&op->lock);
+	return ret;
+}
+
+void i2c_async_free(I2cAsyncOp* op) {
+	if (op == NULL)
+		return;
+
+	// Called from the completion callback: the job is done, and joining would wait on ourselves
+	if (op->started) {
+		if (thread_is_current(&op->thread))
+			thread_detach(&op->thread);
+		else
+			thread_join(&op->thread);
+	}
+
+	thread_cond_destroy(&op->done_cond);
+	thread_mutex_destroy(&op->lock);
+	free(op);
+}
+
+void i2c_eeprom_attach_stats(I2cEepromDevice* dev, I2cStats* stats) {
+	if (dev == NULL)
+		return;
+
+	if (stats != NULL)
+		i2c_stats_reset(stats);
+	dev->stats = stats;
+}
+
+int i2c_eeprom_get_stats(const I2cEepromDevice* dev, I2cStats* out) {
+	if (dev == NULL || dev->stats == NULL || out == NULL) {
+		return XFER_ERROR_INVALID_ARG;
+	}
+
+	memcpy(out, dev->stats, sizeof(I2cStats));
+	return XFER_OK;
+}
+
+void i2c_stats_reset(I2cStats* stats) {
+	if (stats != NULL)
+		memset(stats, 0, sizeof(I2cStats));
+}
+
+const char* get_transfer_error_message(int error_code) {
+	switch (error_code) {
+		case XFER_OK:
+			return "Success";
+		case XFER_ERROR_NOT_LOADED:
+			return "Error: libMPSSE is not loaded";
+		case XFER_ERROR_INVALID_ARG:
+			return "Error: Invalid argument or NULL pointer";
+		case XFER_ERROR_SHORT_TRANSFER:
+			return "Error: I2C transfer moved fewer bytes than requested";
+		case XFER_ERROR_VERIFY_MISMATCH:
+			return "Error: EEPROM contents do not match expected data";
+		case XFER_ERROR_WRITE_TIMEOUT:
+			return "Error: EEPROM did not ACK before the write timeout";
+		case XFER_ERROR_NO_MEMORY:
+			return "Error: Out of memory";
+		case XFER_ERROR_NO_DEVICE:
+			return "Error: No EEPROM found in range 0x50-0x57";
+		case XFER_PENDING:
+			return "Operation still in progress";
+		default:
+			if (error_code > 0)
+				return "Error: libMPSSE returned a non-zero FT_STATUS";
+			return "Error: Unknown error code";
+	}
+}
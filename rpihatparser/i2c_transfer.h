@@ -0,0 +1,488 @@
+/**
+ * i2c_transfer.h
+ *
+ * Native I2C EEPROM transfer engine on top of libMPSSE
+ * Header file for DLL interface
+ */
+
+#ifndef I2C_TRANSFER_H
+#define I2C_TRANSFER_H
+
+#include <stdint.h>
+#include "rpi_hat_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// libMPSSE I2C transfer options (same values as MaxUsbTool.py)
+#define I2C_START_BIT                0x01
+#define I2C_STOP_BIT                 0x02
+#define I2C_BREAK_ON_NACK            0x04
+#define I2C_NACK_LAST_BYTE           0x08
+#define I2C_FAST_TRANSFER_BYTES      0x10
+
+#define I2C_EEPROM_DEFAULT_PAGE_SIZE     32
+#define I2C_EEPROM_MAX_PAGE_SIZE         256
+#define I2C_EEPROM_DEFAULT_WRITE_TIMEOUT_MS 25
+#define I2C_PROGRAM_DEFAULT_RETRIES  2     // Rewrites of a page that fails its readback
+
+// Positive return values are FT_STATUS codes passed up from libMPSSE
+#define XFER_OK                       0
+#define XFER_ERROR_NOT_LOADED         -10
+#define XFER_ERROR_INVALID_ARG        -11
+#define XFER_ERROR_SHORT_TRANSFER     -12
+#define XFER_ERROR_VERIFY_MISMATCH    -13
+#define XFER_ERROR_WRITE_TIMEOUT      -14
+#define XFER_ERROR_NO_MEMORY          -15
+#define XFER_ERROR_NO_DEVICE          -16
+#define XFER_PENDING                  -17   // i2c_async_poll / i2c_async_wait: operation still running
+
+#define MULTI_MAX_CHANNELS            16
+
+// Multi-channel job operations, run in this order when combined
+#define MULTI_OP_READ                 0x01
+#define MULTI_OP_PROGRAM              0x02
+#define MULTI_OP_VERIFY               0x04
+
+// i2c_eeprom_erase flags
+#define ERASE_SKIP_BLANK              0x01
+
+#define I2C_ASYNC_WAIT_FOREVER        0xFFFFFFFFu
+
+#define I2C_PIPELINE_DEFAULT_BLOCK    256
+#define I2C_PIPELINE_MAX_BLOCK        4096
+
+#define I2C_EEPROM_SCAN_FIRST         0x50
+#define I2C_EEPROM_SCAN_LAST          0x57
+
+// Non-reserved 7-bit address range probed by a full bus scan
+#define I2C_BUS_SCAN_FIRST            0x08
+#define I2C_BUS_SCAN_LAST             0x77
+#define I2C_BUS_BITMAP_BYTES          16
+
+// Latency histogram buckets: bucket 0 counts < 1 us, bucket i counts [2^(i-1), 2^i) us, the last one everything above
+#define I2C_STATS_BUCKETS             20
+
+// Per-device instrumentation, filled in only while attached with i2c_eeprom_attach_stats
+typedef struct {
+    uint64_t transactions;      // libMPSSE read/write calls, ACK polls included
+    uint64_t bytes_written;     // Word-address and data bytes sent
+    uint64_t bytes_read;
+    uint64_t transfer_us;       // Time spent in data transfers
+    uint64_t wait_us;           // Time spent ACK-polling for the EEPROM to become ready
+    uint32_t errors;            // Data transfers that returned a non-zero FT_STATUS
+    uint32_t waits;             // i2c_eeprom_wait_ready calls (one per page write)
+    uint32_t ack_polls;         // Probes sent while waiting
+    uint32_t poll_retries;      // Probes NACKed by a busy EEPROM and repeated
+    uint32_t timeouts;          // Waits that ran into the timeout
+    uint32_t max_transfer_us;
+    uint32_t max_wait_us;
+    uint32_t transfer_hist[I2C_STATS_BUCKETS];  // Per data transfer
+    uint32_t wait_hist[I2C_STATS_BUCKETS];      // Per wait
+} I2cStats;
+
+typedef struct {
+    void* handle;               // FT_HANDLE returned by I2C_OpenChannel
+    uint32_t slave_address;     // 7-bit I2C address of the EEPROM
+    uint32_t page_size;         // Write page size in bytes
+    uint32_t write_timeout_ms;  // Longest time to ACK-poll for a page write to complete
+    uint32_t capacity;          // Size in bytes, 0 = ranges are not checked
+    uint8_t address_bytes;      // Word-address bytes sent before the data (1 or 2)
+    uint8_t block_bits;         // Address bits above the word address, carried in the low device address bits
+    I2cStats* stats;            // NULL = no instrumentation
+} I2cEepromDevice;
+
+// Part geometry from the datasheet
+typedef struct {
+    const char* name;           // Part family, e.g. "24C256"
+    uint32_t capacity;          // Size in bytes
+    uint32_t page_size;         // Largest page write in bytes
+    uint8_t address_bytes;
+    uint8_t block_bits;
+    uint16_t write_cycle_ms;    // Worst-case write cycle time (tWR)
+} EepromGeometry;
+
+// Same layout as libMPSSE's ChannelConfig
+typedef struct {
+    uint32_t clock_rate;        // I2C clock in Hz (e.g. 400000)
+    uint8_t latency_timer;      // FTDI latency timer in ms
+    uint32_t options;
+} MpsseChannelConfig;
+
+// Settings shared by every channel in a multi-channel run
+typedef struct {
+    MpsseChannelConfig channel;
+    uint32_t slave_address;     // 0 = use the first EEPROM found in 0x50-0x57
+    uint32_t page_size;         // 0 = I2C_EEPROM_DEFAULT_PAGE_SIZE
+    uint32_t write_timeout_ms;  // 0 = I2C_EEPROM_DEFAULT_WRITE_TIMEOUT_MS
+    int differential;           // MULTI_OP_PROGRAM rewrites only the pages that differ
+    const EepromGeometry* geometry; // NULL = 24C32 defaults; applied before page_size/write_timeout_ms; invalid fails each job
+} MultiChannelConfig;
+
+// One channel's work and results
+typedef struct {
+    uint32_t channel_index;     // libMPSSE channel index
+    uint32_t operations;        // MULTI_OP_* bits
+    uint32_t start_addr;
+    const uint8_t* image;       // Source for MULTI_OP_PROGRAM / MULTI_OP_VERIFY
+    uint8_t* read_buffer;       // Destination for MULTI_OP_READ
+    uint32_t length;            // Bytes to read, program or verify
+    // Results
+    int status;                 // XFER_OK or the first error on this channel
+    uint32_t slave_address;     // EEPROM address used
+    uint32_t pages_written;     // Pages rewritten (differential mode), or page rewrites after a failed readback
+    uint32_t mismatches;        // Bytes that failed verification
+    uint32_t elapsed_us;
+    I2cStats* stats;            // Optional, reset and filled in for this channel
+} ChannelJob;
+
+typedef struct I2cAsyncOp I2cAsyncOp;
+
+// Called on the operation's worker thread once its job results are filled in
+typedef void (*AsyncCallback)(ChannelJob* job, void* user_data);
+
+/**
+ * Bind the transfer engine to libMPSSE
+ *
+ * Loading the same path the caller already loaded (e.g. from ctypes) reuses
+ * that module, so channel handles opened by the caller stay valid.
+ *
+ * @param libmpsse_path: Path to libmpsse.dll (or libmpsse.so)
+ * @return: XFER_OK on success, XFER_ERROR_NOT_LOADED on failure
+ */
+int i2c_transfer_load(const char* libmpsse_path);
+
+/**
+ * Initialize an EEPROM device descriptor with 24C32 defaults
+ *
+ * @param dev: Descriptor to initialize
+ * @param handle: Open and initialized libMPSSE I2C channel handle
+ * @param slave_address: 7-bit I2C address of the EEPROM
+ */
+void i2c_eeprom_init(I2cEepromDevice* dev, void* handle, uint32_t slave_address);
+
+/**
+ * Get the number of entries in the built-in EEPROM geometry table
+ *
+ * @return: Number of entries
+ */
+uint32_t eeprom_geometry_count(void);
+
+/**
+ * Get an entry of the built-in EEPROM geometry table
+ *
+ * @param index: Entry index (0 to eeprom_geometry_count() - 1)
+ * @return: Pointer to the entry (statically allocated), or NULL if index is out of range
+ */
+const EepromGeometry* eeprom_geometry_get(uint32_t index);
+
+/**
+ * Look up a part in the built-in EEPROM geometry table
+ *
+ * @param name: Part family such as "24C32" or "24CM02" (case-insensitive)
+ * @return: Pointer to the entry (statically allocated), or NULL if the part is unknown
+ */
+const EepromGeometry* eeprom_geometry_find(const char* name);
+
+/**
+ * Configure an EEPROM device descriptor for a part geometry
+ *
+ * Sets the page size (so writes use the largest page the part allows),
+ * address width, capacity and a write timeout derived from tWR.
+ *
+ * @param dev: EEPROM device descriptor
+ * @param geometry: Part geometry (e.g. from eeprom_geometry_find)
+ * @return: XFER_OK on success, XFER_ERROR_INVALID_ARG on failure
+ */
+int i2c_eeprom_set_geometry(I2cEepromDevice* dev, const EepromGeometry* geometry);
+
+/**
+ * Read a range of EEPROM bytes
+ *
+ * Uses the descriptor's address width (16-bit by default). Ranges that
+ * cross a block addressed by the device address bits are split.
+ *
+ * @param dev: EEPROM device descriptor
+ * @param start_addr: First EEPROM address to read
+ * @param buffer: Destination buffer of at least length bytes
+ * @param length: Number of bytes to read
+ * @return: XFER_OK on success, error code on failure
+ */
+int i2c_eeprom_read(I2cEepromDevice* dev, uint32_t start_addr, uint8_t* buffer, uint32_t length);
+
+/**
+ * Read an EEPROM image and parse it while the rest is still being read
+ *
+ * An I/O thread reads block_size blocks into two alternating buffers while
+ * the calling thread feeds each finished block to the streaming parser (and
+ * checks atom CRCs with PARSE_FLAG_VERIFY_CRC), so the whole operation takes
+ * about max(I/O, parse) instead of their sum. Reading stops at the header's
+ * eeplen, at capacity or once the atom chain is complete.
+ *
+ * @param dev: EEPROM device descriptor
+ * @param start_addr: EEPROM address of the image header
+ * @param buffer: Receives the image bytes (at least capacity bytes)
+ * @param capacity: Most bytes to read (EEPROM size)
+ * @param block_size: Bytes per I2C read, 0 = I2C_PIPELINE_DEFAULT_BLOCK (at most I2C_PIPELINE_MAX_BLOCK)
+ * @param flags: PARSE_FLAG_* bits
+ * @param result: Receives the parsed EEPROM
+ * @param integrity: Optional pointer to receive per-atom CRC results
+ * @param bytes_read: Optional pointer to receive the number of bytes parsed
+ * @return: XFER_* or FT_STATUS code if a needed read failed, otherwise the
+ *          parse status (PARSE_OK, PARSE_ERROR_CRC_MISMATCH, ...)
+ */
+int i2c_eeprom_read_parse(I2cEepromDevice* dev, uint32_t start_addr, uint8_t* buffer, uint32_t capacity,
+                          uint32_t block_size, uint32_t flags, ParsedEeprom* result,
+                          ParseIntegrity* integrity, uint32_t* bytes_read);
+
+/**
+ * Write a range of EEPROM bytes as page writes
+ *
+ * Splits the range on page boundaries. After every page the device is
+ * ACK-polled until its write cycle completes, so each page costs its real
+ * tWR instead of a fixed worst-case delay.
+ *
+ * @param dev: EEPROM device descriptor
+ * @param start_addr: First EEPROM address to write
+ * @param data: Bytes to write
+ * @param length: Number of bytes to write
+ * @return: XFER_OK on success, error code on failure
+ */
+int i2c_eeprom_write(I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* data, uint32_t length);
+
+/**
+ * Write a range and verify each page as soon as its write cycle completes
+ *
+ * After every page write the device is ACK-polled, the page is read back
+ * and compared with the source while it is still in cache, and a page that
+ * differs is rewritten up to max_retries times. Pages follow EEPROM page
+ * boundaries (as in eeprom_diff_pages). No separate full-image verify pass
+ * is needed.
+ *
+ * @param dev: EEPROM device descriptor
+ * @param start_addr: First EEPROM address to write
+ * @param data: Bytes to write
+ * @param length: Number of bytes to write
+ * @param max_retries: Rewrites allowed per page after a failed readback
+ * @param page_bitmap: Optional bitmap, one bit per page (LSB first), set when the page still differs
+ * @param pages_retried: Optional pointer to receive the number of page rewrites
+ * @param mismatches: Optional pointer to receive the bytes that still differ
+ * @return: XFER_OK if every page verified, XFER_ERROR_VERIFY_MISMATCH or another error code otherwise
+ */
+int i2c_eeprom_program_verify(I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* data, uint32_t length,
+                              uint32_t max_retries, uint8_t* page_bitmap, uint32_t* pages_retried,
+                              uint32_t* mismatches);
+
+/**
+ * Write only the pages of a range that differ from the current EEPROM contents
+ *
+ * Reads the current contents once, compares them page by page with data
+ * and page-writes only the pages that differ.
+ *
+ * @param dev: EEPROM device descriptor
+ * @param start_addr: First EEPROM address to write
+ * @param data: Target contents
+ * @param length: Number of bytes in data
+ * @param pages_written: Optional pointer to receive the number of pages rewritten
+ * @return: XFER_OK on success, error code on failure
+ */
+int i2c_eeprom_write_diff(I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* data, uint32_t length,
+                          uint32_t* pages_written);
+
+/**
+ * Fill a range of EEPROM bytes with 0xFF
+ *
+ * Writes one page per transaction from a static 0xFF page using the
+ * descriptor's page size and ACK polling. With ERASE_SKIP_BLANK the range is
+ * read first and pages that are already all 0xFF are not rewritten.
+ *
+ * @param dev: EEPROM device descriptor
+ * @param start_addr: First EEPROM address to erase
+ * @param length: Number of bytes to erase, 0 = up to the end of the part (needs a geometry)
+ * @param flags: ERASE_* bits
+ * @param pages_written: Optional pointer to receive the number of pages written
+ * @return: XFER_OK on success, error code on failure
+ */
+int i2c_eeprom_erase(I2cEepromDevice* dev, uint32_t start_addr, uint32_t length, uint32_t flags,
+                     uint32_t* pages_written);
+
+/**
+ * Compare two images page by page
+ *
+ * Pages follow EEPROM page boundaries, so the first and last page of an
+ * unaligned range are partial.
+ *
+ * @param current: Current contents
+ * @param target: Target contents
+ * @param length: Number of bytes to compare
+ * @param start_addr: EEPROM address of the first byte
+ * @param page_size: EEPROM page size in bytes
+ * @param page_bitmap: Optional bitmap, one bit per page (LSB first), set when the page differs
+ * @return: Number of pages that differ
+ */
+uint32_t eeprom_diff_pages(const uint8_t* current, const uint8_t* target, uint32_t length,
+                           uint32_t start_addr, uint32_t page_size, uint8_t* page_bitmap);
+
+/**
+ * Wait for an EEPROM write cycle to complete by ACK polling
+ *
+ * The EEPROM does not acknowledge its address while an internal write is in
+ * progress; this probes the address until it ACKs.
+ *
+ * @param dev: EEPROM device descriptor
+ * @param timeout_ms: Longest time to poll before giving up
+ * @return: XFER_OK once the device ACKs, XFER_ERROR_WRITE_TIMEOUT or another error code otherwise
+ */
+int i2c_eeprom_wait_ready(I2cEepromDevice* dev, uint32_t timeout_ms);
+
+/**
+ * Read back a range of EEPROM bytes and compare it with expected data
+ *
+ * @param dev: EEPROM device descriptor
+ * @param start_addr: First EEPROM address to compare
+ * @param expected: Expected contents
+ * @param length: Number of bytes to compare
+ * @param mismatches: Optional pointer to receive the number of differing bytes
+ * @param first_mismatch: Optional pointer to receive the offset of the first difference
+ * @return: XFER_OK if all bytes match, XFER_ERROR_VERIFY_MISMATCH or another error code otherwise
+ */
+int i2c_eeprom_verify(I2cEepromDevice* dev, uint32_t start_addr, const uint8_t* expected, uint32_t length,
+                      uint32_t* mismatches, uint32_t* first_mismatch);
+
+/**
+ * Probe the usual EEPROM address range on a channel
+ *
+ * @param dev: EEPROM device descriptor (slave_address is updated on success)
+ * @return: XFER_OK if a device ACKed, XFER_ERROR_NO_DEVICE otherwise
+ */
+int i2c_eeprom_find(I2cEepromDevice* dev);
+
+/**
+ * Probe a range of 7-bit addresses and record which ones ACK
+ *
+ * The whole range is probed in one call with the same one-byte read probe
+ * MaxUsbTool.scan_i2c_devices() uses (a read cannot trigger a device
+ * action), so a scan costs one foreign call instead of one per address.
+ *
+ * @param handle: Open and initialized libMPSSE I2C channel handle
+ * @param first_addr: First address to probe
+ * @param last_addr: Last address to probe (at most 0x7F)
+ * @param bitmap: I2C_BUS_BITMAP_BYTES bytes; bit (addr % 8) of byte (addr / 8) is set if addr ACKed, all other bits are cleared
+ * @param found: Optional pointer to receive the number of devices found
+ * @return: XFER_OK on success, error code on failure
+ */
+int i2c_bus_scan(void* handle, uint32_t first_addr, uint32_t last_addr, uint8_t* bitmap, uint32_t* found);
+
+/**
+ * Get the number of MPSSE channels libMPSSE can see
+ *
+ * @param count: Receives the channel count
+ * @return: XFER_OK on success, error code on failure
+ */
+int i2c_multi_channel_count(uint32_t* count);
+
+/**
+ * Run read/program/verify jobs on several channels concurrently
+ *
+ * Each job opens and initializes its own channel, runs its operations and
+ * closes the channel on its own worker thread, so channels on different
+ * adapters proceed in parallel. Channels must not already be open.
+ *
+ * @param jobs: One job per channel (channel indices must be distinct)
+ * @param num_jobs: Number of jobs (at most MULTI_MAX_CHANNELS)
+ * @param config: Settings shared by all channels
+ * @return: XFER_OK if every job succeeded, otherwise the first failing job's status
+ */
+int i2c_multi_run(ChannelJob* jobs, uint32_t num_jobs, const MultiChannelConfig* config);
+
+/**
+ * Start a read/program/verify job on an open device without blocking
+ *
+ * The job's MULTI_OP_* operations run in order on a worker thread, exactly
+ * as in i2c_multi_run but on dev instead of a channel the worker opens
+ * (channel_index and stats are not used; attach stats to dev instead).
+ * dev, the job and its buffers belong to the operation until it completes,
+ * so a device runs one operation at a time. If the worker thread cannot be
+ * started the job runs before this call returns.
+ *
+ * @param dev: EEPROM device descriptor on an open channel
+ * @param job: Job to run; status and the other results are filled in on completion
+ * @param differential: MULTI_OP_PROGRAM rewrites only the pages that differ
+ * @param callback: Optional completion callback, run on the worker thread (it may free the operation)
+ * @param user_data: Passed to callback
+ * @param op: Receives the operation handle (release with i2c_async_free)
+ * @return: XFER_OK if the job was started, XFER_ERROR_INVALID_ARG or XFER_ERROR_NO_MEMORY otherwise
+ */
+int i2c_async_submit(I2cEepromDevice* dev, ChannelJob* job, int differential,
+                     AsyncCallback callback, void* user_data, I2cAsyncOp** op);
+
+/**
+ * Check an operation without blocking
+ *
+ * @param op: Operation handle
+ * @return: XFER_PENDING while it runs, then the job status
+ */
+int i2c_async_poll(I2cAsyncOp* op);
+
+/**
+ * Wait for an operation to complete
+ *
+ * @param op: Operation handle
+ * @param timeout_ms: Longest time to wait, or I2C_ASYNC_WAIT_FOREVER
+ * @return: The job status, or XFER_PENDING if it is still running after timeout_ms
+ */
+int i2c_async_wait(I2cAsyncOp* op, uint32_t timeout_ms);
+
+/**
+ * Wait for an operation to complete and release it
+ *
+ * From the operation's own completion callback the job is already done,
+ * so the handle is released without waiting for the worker thread to exit.
+ *
+ * @param op: Operation handle (NULL is ignored)
+ */
+void i2c_async_free(I2cAsyncOp* op);
+
+/**
+ * Attach instrumentation to a device
+ *
+ * While attached, every transfer on dev updates the counters and latency
+ * histograms in stats. A detached device only pays one pointer test per
+ * transfer. stats must not be shared between devices used on different
+ * threads.
+ *
+ * @param dev: Device
+ * @param stats: Caller-owned counters, reset here (NULL to detach)
+ */
+void i2c_eeprom_attach_stats(I2cEepromDevice* dev, I2cStats* stats);
+
+/**
+ * Copy the counters of a device
+ *
+ * @param dev: Device
+ * @param out: Receives a snapshot of the attached counters
+ * @return: XFER_OK, or XFER_ERROR_INVALID_ARG if no counters are attached
+ */
+int i2c_eeprom_get_stats(const I2cEepromDevice* dev, I2cStats* out);
+
+/**
+ * Zero a set of counters
+ *
+ * @param stats: Counters to reset
+ */
+void i2c_stats_reset(I2cStats* stats);
+
+/**
+ * Get a human-readable message for a transfer error code
+ *
+ * @param error_code: Error code returned by transfer functions
+ * @return: Pointer to error message string (statically allocated)
+ */
+const char* get_transfer_error_message(int error_code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2C_TRANSFER_H
@@ -0,0 +1,721 @@
+"""
+Python wrapper for the native I2C EEPROM transfer engine in rpi_hat_parser DLL
+"""
+
+import asyncio
+import ctypes
+import itertools
+import threading
+import weakref
+from typing import Callable, List, Optional, Tuple
+
+from .rpi_hat_parser_wrapper import dll_path, ParsedEeprom, ParseIntegrity, PARSE_FLAG_VERIFY_CRC, _data_pointer
+
+transfer_lib = ctypes.cdll.LoadLibrary(dll_path)
+
+XFER_OK = 0
+XFER_ERROR_NOT_LOADED = -10
+XFER_ERROR_INVALID_ARG = -11
+XFER_ERROR_SHORT_TRANSFER = -12
+XFER_ERROR_VERIFY_MISMATCH = -13
+XFER_ERROR_WRITE_TIMEOUT = -14
+XFER_ERROR_NO_MEMORY = -15
+XFER_ERROR_NO_DEVICE = -16
+XFER_PENDING = -17
+
+I2C_ASYNC_WAIT_FOREVER = 0xFFFFFFFF
+
+ERASE_SKIP_BLANK = 0x01
+
+I2C_BUS_SCAN_FIRST = 0x08
+I2C_BUS_SCAN_LAST = 0x77
+I2C_BUS_BITMAP_BYTES = 16
+
+I2C_PIPELINE_DEFAULT_BLOCK = 256
+I2C_PIPELINE_MAX_BLOCK = 4096
+
+MULTI_MAX_CHANNELS = 16
+MULTI_OP_READ = 0x01
+MULTI_OP_PROGRAM = 0x02
+MULTI_OP_VERIFY = 0x04
+
+I2C_EEPROM_DEFAULT_PAGE_SIZE = 32
+I2C_PROGRAM_DEFAULT_RETRIES = 2
+
+I2C_STATS_BUCKETS = 20
+
+class I2cStats(ctypes.Structure):
+	_fields_ = [
+		('transactions', ctypes.c_uint64),
+		('bytes_written', ctypes.c_uint64),
+		('bytes_read', ctypes.c_uint64),
+		('transfer_us', ctypes.c_uint64),
+		('wait_us', ctypes.c_uint64),
+		('errors', ctypes.c_uint32),
+		('waits', ctypes.c_uint32),
+		('ack_polls', ctypes.c_uint32),
+		('poll_retries', ctypes.c_uint32),
+		('timeouts', ctypes.c_uint32),
+		('max_transfer_us', ctypes.c_uint32),
+		('max_wait_us', ctypes.c_uint32),
+		('transfer_hist', ctypes.c_uint32 * I2C_STATS_BUCKETS),
+		('wait_hist', ctypes.c_uint32 * I2C_STATS_BUCKETS)
+	]
+
+class I2cEepromDevice(ctypes.Structure):
+	_fields_ = [
+		('handle', ctypes.c_void_p),
+		('slave_address', ctypes.c_uint32),
+		('page_size', ctypes.c_uint32),
+		('write_timeout_ms', ctypes.c_uint32),
+		('capacity', ctypes.c_uint32),
+		('address_bytes', ctypes.c_uint8),
+		('block_bits', ctypes.c_uint8),
+		('stats', ctypes.POINTER(I2cStats))
+	]
+
+class EepromGeometry(ctypes.Structure):
+	_fields_ = [
+		('name', ctypes.c_char_p),
+		('capacity', ctypes.c_uint32),
+		('page_size', ctypes.c_uint32),
+		('address_bytes', ctypes.c_uint8),
+		('block_bits', ctypes.c_uint8),
+		('write_cycle_ms', ctypes.c_uint16)
+	]
+
+class MpsseChannelConfig(ctypes.Structure):
+	_fields_ = [
+		('clock_rate', ctypes.c_uint32),
+		('latency_timer', ctypes.c_uint8),
+		('options', ctypes.c_uint32)
+	]
+
+class MultiChannelConfig(ctypes.Structure):
+	_fields_ = [
+		('channel', MpsseChannelConfig),
+		('slave_address', ctypes.c_uint32),
+		('page_size', ctypes.c_uint32),
+		('write_timeout_ms', ctypes.c_uint32),
+		('differential', ctypes.c_int),
+		('geometry', ctypes.POINTER(EepromGeometry))
+	]
+
+class ChannelJob(ctypes.Structure):
+	_fields_ = [
+		('channel_index', ctypes.c_uint32),
+		('operations', ctypes.c_uint32),
+		('start_addr', ctypes.c_uint32),
+		('image', ctypes.POINTER(ctypes.c_uint8)),
+		('read_buffer', ctypes.POINTER(ctypes.c_uint8)),
+		('length', ctypes.c_uint32),
+		('status', ctypes.c_int),
+		('slave_address', ctypes.c_uint32),
+		('pages_written', ctypes.c_uint32),
+		('mismatches', ctypes.c_uint32),
+		('elapsed_us', ctypes.c_uint32),
+		('stats', ctypes.POINTER(I2cStats))
+	]
+
+transfer_lib.i2c_transfer_load.argtypes = [ctypes.c_char_p]
+transfer_lib.i2c_transfer_load.restype = ctypes.c_int
+
+transfer_lib.i2c_eeprom_init.argtypes = [ctypes.POINTER(I2cEepromDevice), ctypes.c_void_p, ctypes.c_uint32]
+transfer_lib.i2c_eeprom_init.restype = None
+
+transfer_lib.i2c_eeprom_read.argtypes = [
+	ctypes.POINTER(I2cEepromDevice),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32
+]
+transfer_lib.i2c_eeprom_read.restype = ctypes.c_int
+
+transfer_lib.i2c_eeprom_write.argtypes = [
+	ctypes.POINTER(I2cEepromDevice),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32
+]
+transfer_lib.i2c_eeprom_write.restype = ctypes.c_int
+
+transfer_lib.i2c_eeprom_write_diff.argtypes = [
+	ctypes.POINTER(I2cEepromDevice),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+transfer_lib.i2c_eeprom_write_diff.restype = ctypes.c_int
+
+transfer_lib.i2c_eeprom_program_verify.argtypes = [
+	ctypes.POINTER(I2cEepromDevice),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.POINTER(ctypes.c_uint32)
+]
+transfer_lib.i2c_eeprom_program_verify.restype = ctypes.c_int
+
+transfer_lib.i2c_eeprom_erase.argtypes = [
+	ctypes.POINTER(I2cEepromDevice),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+transfer_lib.i2c_eeprom_erase.restype = ctypes.c_int
+
+transfer_lib.eeprom_diff_pages.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8)
+]
+transfer_lib.eeprom_diff_pages.restype = ctypes.c_uint32
+
+transfer_lib.i2c_eeprom_wait_ready.argtypes = [ctypes.POINTER(I2cEepromDevice), ctypes.c_uint32]
+transfer_lib.i2c_eeprom_wait_ready.restype = ctypes.c_int
+
+transfer_lib.i2c_eeprom_verify.argtypes = [
+	ctypes.POINTER(I2cEepromDevice),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.POINTER(ctypes.c_uint32)
+]
+transfer_lib.i2c_eeprom_verify.restype = ctypes.c_int
+
+transfer_lib.eeprom_geometry_count.argtypes = []
+transfer_lib.eeprom_geometry_count.restype = ctypes.c_uint32
+
+transfer_lib.eeprom_geometry_get.argtypes = [ctypes.c_uint32]
+transfer_lib.eeprom_geometry_get.restype = ctypes.POINTER(EepromGeometry)
+
+transfer_lib.eeprom_geometry_find.argtypes = [ctypes.c_char_p]
+transfer_lib.eeprom_geometry_find.restype = ctypes.POINTER(EepromGeometry)
+
+transfer_lib.i2c_eeprom_set_geometry.argtypes = [ctypes.POINTER(I2cEepromDevice), ctypes.POINTER(EepromGeometry)]
+transfer_lib.i2c_eeprom_set_geometry.restype = ctypes.c_int
+
+transfer_lib.i2c_eeprom_read_parse.argtypes = [
+	ctypes.POINTER(I2cEepromDevice),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ParsedEeprom),
+	ctypes.POINTER(ParseIntegrity),
+	ctypes.POINTER(ctypes.c_uint32)
+]
+transfer_lib.i2c_eeprom_read_parse.restype = ctypes.c_int
+
+transfer_lib.i2c_eeprom_find.argtypes = [ctypes.POINTER(I2cEepromDevice)]
+transfer_lib.i2c_eeprom_find.restype = ctypes.c_int
+
+transfer_lib.i2c_bus_scan.argtypes = [
+	ctypes.c_void_p,
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.POINTER(ctypes.c_uint32)
+]
+transfer_lib.i2c_bus_scan.restype = ctypes.c_int
+
+transfer_lib.i2c_multi_channel_count.argtypes = [ctypes.POINTER(ctypes.c_uint32)]
+transfer_lib.i2c_multi_channel_count.restype = ctypes.c_int
+
+transfer_lib.i2c_multi_run.argtypes = [ctypes.POINTER(ChannelJob), ctypes.c_uint32, ctypes.POINTER(MultiChannelConfig)]
+transfer_lib.i2c_multi_run.restype = ctypes.c_int
+
+AsyncCallback = ctypes.CFUNCTYPE(None, ctypes.POINTER(ChannelJob), ctypes.c_void_p)
+
+transfer_lib.i2c_async_submit.argtypes = [
+	ctypes.POINTER(I2cEepromDevice),
+	ctypes.POINTER(ChannelJob),
+	ctypes.c_int,
+	AsyncCallback,
+	ctypes.c_void_p,
+	ctypes.POINTER(ctypes.c_void_p)
+]
+transfer_lib.i2c_async_submit.restype = ctypes.c_int
+
+transfer_lib.i2c_async_poll.argtypes = [ctypes.c_void_p]
+transfer_lib.i2c_async_poll.restype = ctypes.c_int
+
+transfer_lib.i2c_async_wait.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+transfer_lib.i2c_async_wait.restype = ctypes.c_int
+
+transfer_lib.i2c_async_free.argtypes = [ctypes.c_void_p]
+transfer_lib.i2c_async_free.restype = None
+
+transfer_lib.i2c_eeprom_attach_stats.argtypes = [ctypes.POINTER(I2cEepromDevice), ctypes.POINTER(I2cStats)]
+transfer_lib.i2c_eeprom_attach_stats.restype = None
+
+transfer_lib.i2c_eeprom_get_stats.argtypes = [ctypes.POINTER(I2cEepromDevice), ctypes.POINTER(I2cStats)]
+transfer_lib.i2c_eeprom_get_stats.restype = ctypes.c_int
+
+transfer_lib.i2c_stats_reset.argtypes = [ctypes.POINTER(I2cStats)]
+transfer_lib.i2c_stats_reset.restype = None
+
+transfer_lib.get_transfer_error_message.argtypes = [ctypes.c_int]
+transfer_lib.get_transfer_error_message.restype = ctypes.c_char_p
+
+
+def load_mpsse(libmpsse_path: str) -> int:
+	"""
+	Bind the native transfer engine to libMPSSE.
+
+	Pass the same path that was used to load libmpsse.dll with ctypes so
+	channel handles opened from Python can be used by the engine.
+
+	Args:
+		libmpsse_path: Path to libmpsse.dll
+
+	Returns:
+		int: XFER_OK on success, error code on failure
+	"""
+	return transfer_lib.i2c_transfer_load(libmpsse_path.encode('utf-8'))
+
+
+def get_transfer_error_message(error_code: int) -> str:
+	"""
+	Get human-readable error message for a transfer error code.
+
+	Args:
+		error_code: Error code from transfer functions
+
+	Returns:
+		str: Error message
+	"""
+	msg = transfer_lib.get_transfer_error_message(error_code)
+	return msg.decode('utf-8')
+
+
+def stats_to_dict(stats: I2cStats) -> dict:
+	"""
+	Convert transfer counters to a plain dict (e.g. for JSON dashboards).
+	
+	Histogram bucket 0 counts < 1 us, bucket i counts [2^(i-1), 2^i) us.
+	"""
+	result = {name: getattr(stats, name) for name, _ in I2cStats._fields_ if not name.endswith('_hist')}
+	result['transfer_hist'] = list(stats.transfer_hist)
+	result['wait_hist'] = list(stats.wait_hist)
+	return result
+
+
+def diff_pages(current, target, start_addr: int = 0, page_size: int = I2C_EEPROM_DEFAULT_PAGE_SIZE) -> List[int]:
+	"""
+	Compare two images page by page.
+
+	Args:
+		current: Current EEPROM contents
+		target: Target image (same length as current)
+		start_addr: EEPROM address of the first byte
+		page_size: EEPROM page size in bytes
+
+	Returns:
+		list: Indices of the pages that differ
+	"""
+	length = min(len(current), len(target))
+	num_pages = (start_addr % page_size + length + page_size - 1) // page_size
+	bitmap = (ctypes.c_uint8 * ((num_pages + 7) // 8))()
+	# The slices are new objects; keep them in locals until the call returns
+	current_bytes = current[:length]
+	target_bytes = target[:length]
+	transfer_lib.eeprom_diff_pages(_data_pointer(current_bytes), _data_pointer(target_bytes), length,
+								   start_addr, page_size, bitmap)
+	return [page for page in range(num_pages) if bitmap[page // 8] & (1 << (page % 8))]
+
+
+def eeprom_geometries() -> List[EepromGeometry]:
+	"""Return the built-in EEPROM geometry table."""
+	return [transfer_lib.eeprom_geometry_get(i).contents for i in range(transfer_lib.eeprom_geometry_count())]
+
+
+def find_geometry(part: str) -> Optional[ctypes.POINTER(EepromGeometry)]:
+	"""Look up a part such as '24C256' (case-insensitive); returns a pointer into the table or None."""
+	geometry = transfer_lib.eeprom_geometry_find(part.encode('utf-8'))
+	return geometry if geometry else None
+
+
+def bus_scan(handle, first_addr: int = I2C_BUS_SCAN_FIRST, last_addr: int = I2C_BUS_SCAN_LAST) -> Tuple[int, int]:
+	"""
+	Probe an address range on an open channel in one native call.
+	
+	Returns:
+		tuple: (status, presence bitmap as an int with bit addr set for every address that ACKed)
+	"""
+	bitmap = (ctypes.c_uint8 * I2C_BUS_BITMAP_BYTES)()
+	status = transfer_lib.i2c_bus_scan(handle, first_addr, last_addr, bitmap, None)
+	return (status, int.from_bytes(bytes(bitmap), 'little'))
+
+
+def bitmap_addresses(bitmap: int) -> List[int]:
+	"""List the addresses set in a presence bitmap from bus_scan()."""
+	return [addr for addr in range(128) if bitmap >> addr & 1]
+
+
+def multi_channel_count() -> Tuple[int, int]:
+	"""Returns (status, number of MPSSE channels)."""
+	count = ctypes.c_uint32()
+	status = transfer_lib.i2c_multi_channel_count(ctypes.byref(count))
+	return (status, count.value)
+
+
+def run_multi_channel(channels: List[int], operations: int, images=None, length: int = 0, start_addr: int = 0,
+					  clock_rate: int = 400000, latency_timer: int = 25, slave_address: int = 0,
+					  differential: bool = False, part: Optional[str] = None,
+					  collect_stats: bool = False) -> Tuple[int, List[ChannelJob], List[bytes]]:
+	"""
+	Run the same operations on several channels concurrently, one native thread per channel.
+	
+	Args:
+		channels: libMPSSE channel indices (channels must not be open)
+		operations: MULTI_OP_* bits
+		images: Image for MULTI_OP_PROGRAM/VERIFY, either one for all channels or a list with one per channel
+		length: Bytes to read for MULTI_OP_READ when no images are given
+		start_addr: EEPROM start address
+		clock_rate: I2C clock in Hz
+		latency_timer: FTDI latency timer in ms
+		slave_address: EEPROM address, 0 to use the first one found in 0x50-0x57
+		differential: Program only the pages that differ
+		part: EEPROM part (e.g. '24C256') from the geometry table, None for 24C32 defaults
+		collect_stats: Fill in each job's stats with that channel's I2cStats
+	
+	Returns:
+		tuple: (status, list of ChannelJob results, list of read data per channel)
+	"""
+	if images is not None and not isinstance(images, (list, tuple)):
+		images = [images] * len(channels)
+
+	jobs = (ChannelJob * len(channels))()
+	stats = (I2cStats * len(channels))() if collect_stats else None
+	sources = []
+	buffers = []
+	for i, channel in enumerate(channels):
+		job_length = len(images[i]) if images is not None else length
+		jobs[i].channel_index = channel
+		jobs[i].operations = operations
+		jobs[i].start_addr = start_addr
+		jobs[i].length = job_length
+		if images is not None:
+			sources.append(_data_pointer(images[i]))
+			jobs[i].image = sources[-1]
+		buffers.append(bytearray(job_length))
+		if operations & MULTI_OP_READ and job_length:
+			jobs[i].read_buffer = (ctypes.c_uint8 * job_length).from_buffer(buffers[-1])
+		if stats is not None:
+			jobs[i].stats = ctypes.pointer(stats[i])
+
+	config = MultiChannelConfig()
+	config.channel.clock_rate = clock_rate
+	config.channel.latency_timer = latency_timer
+	config.slave_address = slave_address
+	config.differential = 1 if differential else 0
+	if part is not None:
+		geometry = find_geometry(part)
+		if geometry is None:
+			return (XFER_ERROR_INVALID_ARG, list(jobs), [bytes(buffer) for buffer in buffers])
+		config.geometry = geometry
+
+	status = transfer_lib.i2c_multi_run(jobs, len(channels), ctypes.byref(config))
+	return (status, list(jobs), [bytes(buffer) for buffer in buffers])
+
+
+# Transfers in flight by user_data key. Weak references, so a pending transfer
+# is not kept alive by a cycle through its own native callback.
+_async_transfers = {}
+_async_keys = itertools.count(1)
+
+
+@AsyncCallback
+def _async_complete(job, user_data):
+	# Runs on the native worker thread; one module-level thunk that is never freed
+	ref = _async_transfers.get(user_data)
+	transfer = ref() if ref is not None else None
+	if transfer is not None:
+		transfer._on_complete()
+
+
+class AsyncTransfer:
+	"""
+	A job running on a native worker thread; poll() it, wait() for it or await it.
+
+	The device belongs to the transfer until it completes, so submit the
+	next job on the same device only after this one is done. close() (or
+	garbage collection) waits for completion and releases the native handle.
+	The callback runs on the worker thread and may call close(), which then
+	releases the handle without waiting.
+	"""
+
+	def __init__(self, device: I2cEepromDevice, operations: int, start_addr: int, image=None, length: int = 0,
+				 differential: bool = False, callback: Optional[Callable[['AsyncTransfer'], None]] = None):
+		self.job = ChannelJob()
+		self.job.operations = operations
+		self.job.start_addr = start_addr
+		self.job.length = len(image) if image is not None else length
+		self._image = image
+		if image is not None:
+			self._source = _data_pointer(image)
+			self.job.image = self._source
+		self._buffer = bytearray(self.job.length if operations & MULTI_OP_READ else 0)
+		if self._buffer:
+			self.job.read_buffer = (ctypes.c_uint8 * len(self._buffer)).from_buffer(self._buffer)
+
+		self._callback = callback
+		self._lock = threading.Lock()
+		self._completed = False
+		self._futures = []
+		self._handle = ctypes.c_void_p()
+		self._key = next(_async_keys)
+		_async_transfers[self._key] = weakref.ref(self)
+
+		status = transfer_lib.i2c_async_submit(ctypes.byref(device), ctypes.byref(self.job), 1 if differential else 0,
+											   _async_complete, ctypes.c_void_p(self._key), ctypes.byref(self._handle))
+		if status != XFER_OK:
+			_async_transfers.pop(self._key, None)
+			self.job.status = status
+			self._completed = True
+
+	def _on_complete(self):
+		with self._lock:
+			self._completed = True
+			futures, self._futures = self._futures, []
+		for loop, future in futures:
+			loop.call_soon_threadsafe(self._resolve, future)
+		if self._callback:
+			self._callback(self)
+
+	@staticmethod
+	def _resolve(future: asyncio.Future):
+		if not future.done():
+			future.set_result(None)
+
+	def poll(self) -> int:
+		"""XFER_PENDING while the job runs, then its status."""
+		if not self._handle:
+			return self.job.status
+		return transfer_lib.i2c_async_poll(self._handle)
+
+	@property
+	def done(self) -> bool:
+		return self.poll() != XFER_PENDING
+
+	def wait(self, timeout_ms: Optional[int] = None) -> int:
+		"""Block until the job completes (or timeout_ms passes); returns its status or XFER_PENDING."""
+		if not self._handle:
+			return self.job.status
+		return transfer_lib.i2c_async_wait(self._handle, I2C_ASYNC_WAIT_FOREVER if timeout_ms is None else timeout_ms)
+
+	def result(self) -> Tuple[int, ChannelJob, bytes]:
+		"""(status, ChannelJob results, data read by MULTI_OP_READ); waits for completion."""
+		status = self.wait()
+		return (status, self.job, bytes(self._buffer))
+
+	def __await__(self):
+		future = None
+		with self._lock:
+			if not self._completed:
+				loop = asyncio.get_running_loop()
+				future = loop.create_future()
+				self._futures.append((loop, future))
+		if future is not None:
+			yield from future.__await__()
+		result = self.result()
+		self.close()
+		return result
+
+	def close(self):
+		handle, self._handle = self._handle, ctypes.c_void_p()
+		if handle:
+			transfer_lib.i2c_async_free(handle)
+		_async_transfers.pop(self._key, None)
+
+	def __del__(self):
+		self.close()
+
+
+class NativeEeprom:
+	"""
+	EEPROM on an open libMPSSE I2C channel, driven by the native engine.
+
+	Each whole-range operation is a single foreign call.
+	"""
+
+	def __init__(self, handle: ctypes.c_void_p, slave_address: int, page_size: int = I2C_EEPROM_DEFAULT_PAGE_SIZE):
+		self.device = I2cEepromDevice()
+		transfer_lib.i2c_eeprom_init(ctypes.byref(self.device), handle, slave_address)
+		self.device.page_size = page_size
+		self._stats = None
+
+	@property
+	def slave_address(self) -> int:
+		return self.device.slave_address
+
+	@slave_address.setter
+	def slave_address(self, address: int):
+		self.device.slave_address = address
+
+	@property
+	def page_size(self) -> int:
+		return self.device.page_size
+
+	@property
+	def capacity(self) -> int:
+		return self.device.capacity
+
+	def set_geometry(self, part: str) -> int:
+		"""Configure page size, address width, capacity and write timeout for a part such as '24C256'."""
+		geometry = find_geometry(part)
+		if geometry is None:
+			return XFER_ERROR_INVALID_ARG
+		return transfer_lib.i2c_eeprom_set_geometry(ctypes.byref(self.device), geometry)
+
+	@property
+	def write_timeout_ms(self) -> int:
+		return self.device.write_timeout_ms
+
+	@write_timeout_ms.setter
+	def write_timeout_ms(self, timeout_ms: int):
+		self.device.write_timeout_ms = timeout_ms
+
+	def enable_stats(self, enabled: bool = True):
+		"""Start (with fresh counters) or stop collecting transfer counters and latency histograms."""
+		self._stats = I2cStats() if enabled else None
+		transfer_lib.i2c_eeprom_attach_stats(ctypes.byref(self.device),
+											 ctypes.byref(self._stats) if enabled else None)
+
+	def stats(self) -> Optional[dict]:
+		"""Snapshot of the transfer counters (see stats_to_dict), or None when not enabled."""
+		if self._stats is None:
+			return None
+		snapshot = I2cStats()
+		transfer_lib.i2c_eeprom_get_stats(ctypes.byref(self.device), ctypes.byref(snapshot))
+		return stats_to_dict(snapshot)
+
+	def reset_stats(self):
+		"""Zero the transfer counters."""
+		if self._stats is not None:
+			transfer_lib.i2c_stats_reset(ctypes.byref(self._stats))
+
+	def wait_ready(self, timeout_ms: Optional[int] = None) -> int:
+		"""ACK-poll until any pending write cycle completes; returns status."""
+		if timeout_ms is None:
+			timeout_ms = self.device.write_timeout_ms
+		return transfer_lib.i2c_eeprom_wait_ready(ctypes.byref(self.device), timeout_ms)
+
+	def read(self, start_addr: int, length: int) -> Tuple[int, bytes]:
+		"""Read length bytes starting at start_addr; returns (status, data)."""
+		buffer = bytearray(length)
+		status = transfer_lib.i2c_eeprom_read(ctypes.byref(self.device), start_addr,
+											  (ctypes.c_uint8 * length).from_buffer(buffer), length)
+		return (status, bytes(buffer) if status == XFER_OK else b'')
+
+	def read_parse(self, start_addr: int, capacity: int, block_size: int = 0,
+				   verify_crc: bool = True) -> Tuple[int, bytes, ParsedEeprom, ParseIntegrity]:
+		"""
+		Read and parse an image with I2C reads and parsing overlapped.
+		
+		Returns:
+			tuple: (status, bytes read, ParsedEeprom, ParseIntegrity); status is
+			an XFER_* code when a read failed, else a PARSE_* code
+		"""
+		buffer = bytearray(capacity)
+		result = ParsedEeprom()
+		integrity = ParseIntegrity()
+		bytes_read = ctypes.c_uint32()
+		status = transfer_lib.i2c_eeprom_read_parse(ctypes.byref(self.device), start_addr,
+													(ctypes.c_uint8 * capacity).from_buffer(buffer), capacity,
+													block_size, PARSE_FLAG_VERIFY_CRC if verify_crc else 0,
+													ctypes.byref(result), ctypes.byref(integrity),
+													ctypes.byref(bytes_read))
+		return (status, bytes(buffer[:bytes_read.value]), result, integrity)
+
+	def write(self, start_addr: int, data) -> int:
+		"""Page-write data starting at start_addr; returns status."""
+		return transfer_lib.i2c_eeprom_write(ctypes.byref(self.device), start_addr, _data_pointer(data), len(data))
+
+	def write_diff(self, start_addr: int, data) -> Tuple[int, int]:
+		"""Rewrite only the pages that differ from the EEPROM; returns (status, pages_written)."""
+		pages_written = ctypes.c_uint32()
+		status = transfer_lib.i2c_eeprom_write_diff(ctypes.byref(self.device), start_addr, _data_pointer(data),
+													len(data), ctypes.byref(pages_written))
+		return (status, pages_written.value)
+
+	def program_verify(self, start_addr: int, data,
+					   max_retries: int = I2C_PROGRAM_DEFAULT_RETRIES) -> Tuple[int, int, int, int]:
+		"""
+		Page-write data, reading each page back right after its write cycle and rewriting failed pages.
+		
+		Returns:
+			tuple: (status, failed page bitmap as an int with bit i set if page i still differs,
+			pages rewritten, bytes that still differ)
+		"""
+		num_pages = (start_addr % self.device.page_size + len(data) + self.device.page_size - 1) // self.device.page_size
+		bitmap = (ctypes.c_uint8 * ((num_pages + 7) // 8))()
+		pages_retried = ctypes.c_uint32()
+		mismatches = ctypes.c_uint32()
+		status = transfer_lib.i2c_eeprom_program_verify(ctypes.byref(self.device), start_addr, _data_pointer(data),
+														len(data), max_retries, bitmap, ctypes.byref(pages_retried),
+														ctypes.byref(mismatches))
+		return (status, int.from_bytes(bytes(bitmap), 'little'), pages_retried.value, mismatches.value)
+
+	def erase(self, start_addr: int = 0, length: int = 0, skip_blank: bool = True) -> Tuple[int, int]:
+		"""
+		Fill a range with 0xFF (length 0 = to the end of the part, needs a geometry).
+		
+		Returns:
+			tuple: (status, pages_written); with skip_blank, pages already all 0xFF are not rewritten
+		"""
+		pages_written = ctypes.c_uint32()
+		status = transfer_lib.i2c_eeprom_erase(ctypes.byref(self.device), start_addr, length,
+											   ERASE_SKIP_BLANK if skip_blank else 0, ctypes.byref(pages_written))
+		return (status, pages_written.value)
+
+	def verify(self, start_addr: int, expected) -> Tuple[int, int, int]:
+		"""Compare EEPROM contents with expected; returns (status, mismatches, first_mismatch)."""
+		mismatches = ctypes.c_uint32()
+		first_mismatch = ctypes.c_uint32()
+		status = transfer_lib.i2c_eeprom_verify(ctypes.byref(self.device), start_addr, _data_pointer(expected),
+												len(expected), ctypes.byref(mismatches), ctypes.byref(first_mismatch))
+		return (status, mismatches.value, first_mismatch.value)
+
+	def submit(self, operations: int, start_addr: int, image=None, length: int = 0, differential: bool = False,
+			   callback: Optional[Callable[[AsyncTransfer], None]] = None) -> AsyncTransfer:
+		"""
+		Start MULTI_OP_* operations on a native worker thread and return at once.
+		
+		Args:
+			operations: MULTI_OP_READ, MULTI_OP_PROGRAM and/or MULTI_OP_VERIFY (run in that order)
+			start_addr: EEPROM start address
+			image: Source for program/verify (kept alive by the transfer)
+			length: Bytes to read when no image is given
+			differential: Program only the pages that differ
+			callback: Called with the transfer on the worker thread when it completes
+			
+		Returns:
+			AsyncTransfer to poll, wait for or await; `await transfer` gives (status, ChannelJob, data)
+		"""
+		return AsyncTransfer(self.device, operations, start_addr, image, length, differential, callback)
+
+	def read_async(self, start_addr: int, length: int, **kwargs) -> AsyncTransfer:
+		"""Start reading a range; the result's data holds the bytes read."""
+		return self.submit(MULTI_OP_READ, start_addr, length=length, **kwargs)
+
+	def program_async(self, start_addr: int, image, verify: bool = True, differential: bool = False,
+					  **kwargs) -> AsyncTransfer:
+		"""Start programming an image, then (by default) read it back and compare."""
+		operations = MULTI_OP_PROGRAM | (MULTI_OP_VERIFY if verify else 0)
+		return self.submit(operations, start_addr, image, differential=differential, **kwargs)
+
+	def verify_async(self, start_addr: int, expected, **kwargs) -> AsyncTransfer:
+		"""Start comparing a range with expected; the job's mismatches counts differing bytes."""
+		return self.submit(MULTI_OP_VERIFY, start_addr, expected, **kwargs)
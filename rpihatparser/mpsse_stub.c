@@ -0,0 +1,35 @@
+/**
+ * mpsse_stub.c
+ *
+ * Stand-in for libMPSSE used by test_i2c_async: exports the two entry points
+ * i2c_transfer_load requires, and every transfer fails at once as if the
+ * channel had been unplugged
+ */
+
+#include <stdint.h>
+
+#define FT_IO_ERROR 4
+
+uint32_t I2C_DeviceRead(void* handle, uint32_t device_address, uint32_t size_to_transfer,
+						uint8_t* buffer, uint32_t* size_transferred, uint32_t options) {
+	(void)handle;
+	(void)device_address;
+	(void)size_to_transfer;
+	(void)buffer;
+	(void)options;
+	if (size_transferred)
+		*size_transferred = 0;
+	return FT_IO_ERROR;
+}
+
+uint32_t I2C_DeviceWrite(void* handle, uint32_t device_address, uint32_t size_to_transfer,
+						 uint8_t* buffer, uint32_t* size_transferred, uint32_t options) {
+	(void)handle;
+	(void)device_address;
+	(void)size_to_transfer;
+	(void)buffer;
+	(void)options;
+	if (size_transferred)
+		*size_transferred = 0;
+	return FT_IO_ERROR;
+}
@@ -0,0 +1,287 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "rpi_hat_archive.h"
+#include "rpi_hat_builder.h"
+#include "thread_compat.h"
+#include "file_map.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+	char* base;
+	uint32_t size;
+	uint32_t used;      // Bytes needed so far, may exceed size
+	uint32_t origin;    // Offset of base within the caller's arena
+} ArchiveArena;
+
+static uint16_t read_le16(const uint8_t* data, uint32_t offset) {
+	return (uint16_t)(data[offset] | (data[offset + 1] << 8));
+}
+
+static uint32_t read_le32(const uint8_t* data, uint32_t offset) {
+	return (uint32_t)data[offset] | ((uint32_t)data[offset + 1] << 8) |
+		   ((uint32_t)data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+}
+
+static uint32_t arena_add_string(ArchiveArena* arena, const uint8_t* src, uint32_t length) {
+	uint32_t copy_len = (length < MAX_STRING_LENGTH - 1) ? length : MAX_STRING_LENGTH - 1;
+	const uint8_t* nul = (const uint8_t*)memchr(src, '\0', copy_len);
+	if (nul != NULL)
+		copy_len = (uint32_t)(nul - src);
+
+	// Saturates instead of wrapping, so a huge batch still reports that it did not fit
+	uint32_t offset = arena->used;
+	arena->used = (copy_len + 1 > ARENA_SIZE_OVERFLOW - offset) ? ARENA_SIZE_OVERFLOW : offset + copy_len + 1;
+
+	if (arena->base == NULL || arena->used > arena->size)
+		return ARENA_OFFSET_NONE;
+
+	memcpy(arena->base + offset, src, copy_len);
+	arena->base[offset + copy_len] = '\0';
+	return arena->origin + offset;
+}
+
+static void reset_row(ArchiveRow* row) {
+	memset(row, 0, sizeof(ArchiveRow));
+	row->vendor_offset = ARENA_OFFSET_NONE;
+	row->product_offset = ARENA_OFFSET_NONE;
+	row->dt_overlay_offset = ARENA_OFFSET_NONE;
+}
+
+static void summarize(const uint8_t* data, uint32_t size, ArchiveRow* row, ArchiveArena* arena) {
+	row->size = size;
+	row->status = index_rpi_hat_eeprom(data, size, &row->header, NULL, 0, &row->num_atoms);
+	if (row->status != PARSE_OK)
+		return;
+
+	// The index validated the whole chain, so every atom is walked here rather than a fixed-size table
+	uint32_t address = FIRST_ATOM_OFFSET;
+
+	for (uint32_t i = 0; i < row->num_atoms; i++) {
+		uint16_t type = read_le16(data, address);
+		uint32_t dlen = read_le32(data, address + 4);
+		uint32_t data_offset = address + ATOM_HEADER_SIZE;
+		address = data_offset + dlen;
+		row->atoms_checked++;
+
+		uint32_t data_len = dlen - 2;
+		const uint8_t* atom_data = &data[data_offset];
+		if (crc16_update(CRC16_INIT, atom_data, data_len) != read_le16(data, data_offset + data_len))
+			row->atoms_failed++;
+
+		if (type == ATOM_TYPE_VENDOR_INFO && !row->has_vendor_info && data_len >= VENDOR_ATOM_FIXED_SIZE) {
+			uint32_t vendor_len = atom_data[20];
+			uint32_t product_len = atom_data[21];
+			if (VENDOR_ATOM_FIXED_SIZE + vendor_len + product_len > data_len)
+				continue;
+
+			memcpy(row->uuid, atom_data, 16);
+			row->product_id = read_le16(atom_data, 16);
+			row->product_version = read_le16(atom_data, 18);
+			row->vendor_offset = arena_add_string(arena, &atom_data[VENDOR_ATOM_FIXED_SIZE], vendor_len);
+			row->product_offset = arena_add_string(arena, &atom_data[VENDOR_ATOM_FIXED_SIZE + vendor_len], product_len);
+			row->has_vendor_info = 1;
+		} else if (type == ATOM_TYPE_DT_OVERLAY && !row->has_dt_overlay) {
+			row->dt_overlay_offset = arena_add_string(arena, atom_data, data_len);
+			row->has_dt_overlay = 1;
+		}
+	}
+
+	row->crc_status = (row->atoms_failed > 0) ? PARSE_ERROR_CRC_MISMATCH : PARSE_OK;
+}
+
+int archive_summarize_image(const uint8_t* data, uint32_t size, ArchiveRow* row,
+							char* arena, uint32_t arena_size, uint32_t* arena_used) {
+	if (row == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	ArchiveArena strings = { arena, arena_size, 0, 0 };
+
+	reset_row(row);
+	summarize(data, size, row, &strings);
+
+	if (arena_used)
+		*arena_used = strings.used;
+
+	return (strings.used > arena_size) ? PARSE_ERROR_BUFFER_TOO_SMALL : PARSE_OK;
+}
+
+typedef struct {
+	const char* const* paths;   // File scan: one path per row
+	const uint8_t* container;   // Container scan: stride-sized slots
+	uint64_t container_size;
+	uint32_t stride;
+	uint32_t first;             // Index of the first row in this slice
+	uint32_t count;
+	ArchiveRow* rows;
+	ArchiveArena strings;
+} ScanSlice;
+
+static void scan_file(const char* path, ArchiveRow* row, ArchiveArena* strings) {
+	file_map_t map;
+	if (path == NULL || file_map_open(&map, path) != 0) {
+		row->status = ARCHIVE_ERROR_IO;
+		return;
+	}
+
+	// EEPROM dumps are far below 4 GB; anything larger is not an image
+	if (map.size > UINT32_MAX)
+		row->status = PARSE_ERROR_INVALID_DATA;
+	else
+		summarize(map.data, (uint32_t)map.size, row, strings);
+
+	file_map_close(&map);
+}
+
+static void scan_worker(void* arg) {
+	ScanSlice* slice = (ScanSlice*)arg;
+
+	for (uint32_t i = 0; i < slice->count; i++) {
+		uint32_t index = slice->first + i;
+		ArchiveRow* row = &slice->rows[index];
+		reset_row(row);
+		row->source = index;
+
+		if (slice->paths != NULL) {
+			scan_file(slice->paths[index], row, &slice->strings);
+			continue;
+		}
+
+		uint64_t offset = (uint64_t)index * slice->stride;
+		uint64_t remaining = slice->container_size - offset;
+		row->offset = offset;
+		summarize(&slice->container[offset], (remaining < slice->stride) ? (uint32_t)remaining : slice->stride,
+				  row, &slice->strings);
+	}
+}
+
+// Split rows across threads the same way as parse_rpi_hat_eeprom_batch_mt
+static int run_scan(const ScanSlice* base, uint32_t count, char* arena, uint32_t arena_size,
+					uint32_t* arena_used, uint32_t num_threads) {
+	if (num_threads == 0)
+		num_threads = thread_cpu_count();
+	if (num_threads > BATCH_MAX_THREADS)
+		num_threads = BATCH_MAX_THREADS;
+	if (num_threads > count)
+		num_threads = count;
+	if (num_threads == 0)
+		num_threads = 1;
+
+	ScanSlice slices[BATCH_MAX_THREADS];
+	thread_t threads[BATCH_MAX_THREADS];
+	uint32_t slice_size = arena_size / num_threads;
+	uint32_t per_thread = count / num_threads;
+	uint32_t extra = count % num_threads;
+	uint32_t first = 0;
+	uint32_t started = 0;
+
+	for (uint32_t t = 0; t < num_threads; t++) {
+		slices[t] = *base;
+		slices[t].first = first;
+		slices[t].count = per_thread + (t < extra ? 1 : 0);
+		slices[t].strings.base = arena ? arena + (size_t)t * slice_size : NULL;
+		slices[t].strings.size = slice_size;
+		slices[t].strings.used = 0;
+		slices[t].strings.origin = t * slice_size;
+		first += slices[t].count;
+
+		// Slice 0 runs on the calling thread; so does any slice whose thread fails to start
+		if (t > 0 && thread_start(&threads[t], scan_worker, &slices[t]) == 0)
+			started |= 1u << t;
+	}
+
+	scan_worker(&slices[0]);
+
+	for (uint32_t t = 1; t < num_threads; t++) {
+		if (started & (1u << t))
+			thread_join(&threads[t]);
+		else
+			scan_worker(&slices[t]);
+	}
+
+	uint32_t max_used = 0;
+	for (uint32_t t = 0; t < num_threads; t++) {
+		if (slices[t].strings.used > max_used)
+			max_used = slices[t].strings.used;
+	}
+
+	if (arena_used) {
+		uint64_t needed = (uint64_t)max_used * num_threads;
+		*arena_used = (needed > ARENA_SIZE_OVERFLOW) ? ARENA_SIZE_OVERFLOW : (uint32_t)needed;
+	}
+
+	return (max_used > slice_size) ? PARSE_ERROR_BUFFER_TOO_SMALL : PARSE_OK;
+}
+
+int archive_scan_files(const char* const* paths, uint32_t count, ArchiveRow* rows,
+					   char* arena, uint32_t arena_size, uint32_t* arena_used, uint32_t num_threads) {
+	if ((paths == NULL || rows == NULL) && count > 0) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	ScanSlice base;
+	memset(&base, 0, sizeof(base));
+	base.paths = paths;
+	base.rows = rows;
+
+	return run_scan(&base, count, arena, arena_size, arena_used, num_threads);
+}
+
+int archive_scan_container(const char* path, uint32_t stride, ArchiveRow* rows, uint32_t max_rows, uint32_t* num_rows,
+						   char* arena, uint32_t arena_size, uint32_t* arena_used, uint32_t num_threads) {
+	if (num_rows)
+		*num_rows = 0;
+
+	if (path == NULL || stride == 0 || (rows == NULL && max_rows > 0)) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	file_map_t map;
+	if (file_map_open(&map, path) != 0) {
+		return ARCHIVE_ERROR_IO;
+	}
+
+	uint64_t slots = (map.size + stride - 1) / stride;
+	if (slots > UINT32_MAX) {
+		file_map_close(&map);
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (num_rows)
+		*num_rows = (uint32_t)slots;
+
+	uint32_t count = (slots < max_rows) ? (uint32_t)slots : max_rows;
+
+	ScanSlice base;
+	memset(&base, 0, sizeof(base));
+	base.container = map.data;
+	base.container_size = map.size;
+	base.stride = stride;
+	base.rows = rows;
+
+	int ret = run_scan(&base, count, arena, arena_size, arena_used, num_threads);
+	file_map_close(&map);
+
+	if (ret == PARSE_OK && slots > max_rows)
+		ret = PARSE_ERROR_BUFFER_TOO_SMALL;
+
+	return ret;
+}
+
+const char* get_archive_error_message(int error_code) {
+	switch (error_code) {
+		case ARCHIVE_ERROR_IO:
+			return "File could not be opened or mapped";
+		case ARCHIVE_ERROR_FORMAT:
+			return "Not a pack file, unsupported pack version, or damaged record";
+		case ARCHIVE_ERROR_READ_ONLY:
+			return "Pack is open read-only";
+		case ARCHIVE_ERROR_NO_MEMORY:
+			return "Out of memory";
+		default:
+			return get_parse_error_message(error_code);
+	}
+}
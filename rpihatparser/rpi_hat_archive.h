@@ -0,0 +1,120 @@
+/**
+ * rpi_hat_archive.h
+ *
+ * Offline scanner for archives of RPi HAT EEPROM dumps
+ * Header file for DLL interface
+ */
+
+#ifndef RPI_HAT_ARCHIVE_H
+#define RPI_HAT_ARCHIVE_H
+
+#include <stdint.h>
+#include "rpi_hat_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parse codes run -1..-6 and transfer codes -10..-16
+#define ARCHIVE_ERROR_IO             -20   // File could not be opened or mapped
+#define ARCHIVE_ERROR_FORMAT         -21   // Not a pack file, an unsupported version, or a damaged record
+#define ARCHIVE_ERROR_READ_ONLY      -22   // Pack was opened without HAT_PACK_WRITE
+#define ARCHIVE_ERROR_NO_MEMORY      -23
+
+// One scanned image; strings live in the caller's arena
+typedef struct {
+    int status;                     // PARSE_OK, PARSE_ERROR_* or ARCHIVE_ERROR_*
+    int crc_status;                 // PARSE_OK or PARSE_ERROR_CRC_MISMATCH, valid if status is PARSE_OK
+    uint32_t source;                // Index of the path (file scan) or image (container scan)
+    uint32_t size;                  // Image size in bytes
+    uint64_t offset;                // Offset of the image within its file
+    RpiHatHeader header;
+    uint32_t num_atoms;
+    uint32_t atoms_checked;         // Atoms whose CRC was checked (every atom in the chain)
+    uint32_t atoms_failed;
+    uint8_t uuid[16];
+    uint16_t product_id;
+    uint16_t product_version;
+    int has_vendor_info;
+    int has_dt_overlay;
+    uint32_t vendor_offset;         // NUL-terminated strings in the arena, or ARENA_OFFSET_NONE
+    uint32_t product_offset;
+    uint32_t dt_overlay_offset;
+} ArchiveRow;
+
+/**
+ * Summarize one image in place (no copy of the image)
+ *
+ * Walks the atom index, checks every indexed atom's CRC against the
+ * image bytes and copies only the vendor, product and overlay strings
+ * into the arena.
+ *
+ * @param data: Image bytes
+ * @param size: Image size in bytes
+ * @param row: Row to fill in (source and offset are left at 0)
+ * @param arena: Caller storage for string payloads
+ * @param arena_size: Size of arena in bytes
+ * @param arena_used: Optional pointer to receive the arena bytes needed
+ * @return: PARSE_OK, or PARSE_ERROR_BUFFER_TOO_SMALL if some strings did not fit; the image status is in row
+ */
+int archive_summarize_image(const uint8_t* data, uint32_t size, ArchiveRow* row,
+                            char* arena, uint32_t arena_size, uint32_t* arena_used);
+
+/**
+ * Scan a list of dump files
+ *
+ * Each file is memory-mapped and summarized straight from the mapping, so
+ * the image bytes are never copied. Files are split into contiguous runs,
+ * one per thread, and the arena into equal per-thread slices, like
+ * parse_rpi_hat_eeprom_batch_mt. A file that cannot be mapped gets
+ * status ARCHIVE_ERROR_IO in its row.
+ *
+ * @param paths: File paths
+ * @param count: Number of paths (one row each)
+ * @param rows: Array of count rows to fill
+ * @param arena: Caller storage for string payloads
+ * @param arena_size: Size of arena in bytes
+ * @param arena_used: Optional pointer to receive an arena size that fits every slice,
+ *                    or ARENA_SIZE_OVERFLOW if none does (split the scan)
+ * @param num_threads: Worker count (0 = one per CPU, capped at BATCH_MAX_THREADS and count)
+ * @return: PARSE_OK, or PARSE_ERROR_BUFFER_TOO_SMALL if a slice ran out of arena
+ */
+int archive_scan_files(const char* const* paths, uint32_t count, ArchiveRow* rows,
+                       char* arena, uint32_t arena_size, uint32_t* arena_used, uint32_t num_threads);
+
+/**
+ * Scan a container of fixed-size dumps stored back to back
+ *
+ * The container is mapped once and each stride-sized slot is summarized
+ * in place (e.g. `cat *.bin > dumps.bin` for same-size readbacks). A short
+ * last slot is scanned with its actual size.
+ *
+ * @param path: Container file
+ * @param stride: Size of every dump in bytes
+ * @param rows: Array of max_rows rows to fill
+ * @param max_rows: Size of rows
+ * @param num_rows: Receives the number of slots in the container (may exceed max_rows)
+ * @param arena: Caller storage for string payloads
+ * @param arena_size: Size of arena in bytes
+ * @param arena_used: Optional pointer to receive an arena size that fits every slice,
+ *                    or ARENA_SIZE_OVERFLOW if none does (split the scan)
+ * @param num_threads: Worker count (0 = one per CPU)
+ * @return: PARSE_OK, ARCHIVE_ERROR_IO, PARSE_ERROR_INVALID_DATA, or PARSE_ERROR_BUFFER_TOO_SMALL
+ *          if the rows or a slice of the arena ran out
+ */
+int archive_scan_container(const char* path, uint32_t stride, ArchiveRow* rows, uint32_t max_rows, uint32_t* num_rows,
+                           char* arena, uint32_t arena_size, uint32_t* arena_used, uint32_t num_threads);
+
+/**
+ * Get a human-readable message for an archive or parse error code
+ *
+ * @param error_code: Error code returned by archive functions
+ * @return: Pointer to error message string (statically allocated)
+ */
+const char* get_archive_error_message(int error_code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RPI_HAT_ARCHIVE_H
@@ -0,0 +1,195 @@
+"""
+Python wrapper for the EEPROM dump archive scanner in rpi_hat_parser DLL
+"""
+
+import ctypes
+import glob
+import os
+from typing import List, Sequence, Tuple
+
+from .rpi_hat_parser_wrapper import (dll_path, RpiHatHeader, ARENA_OFFSET_NONE, PARSE_OK, PARSE_ERROR_BUFFER_TOO_SMALL,
+									 DEFAULT_BATCH_ARENA_SIZE, _grow_arena)
+
+archive_lib = ctypes.cdll.LoadLibrary(dll_path)
+
+ARCHIVE_ERROR_IO = -20
+ARCHIVE_ERROR_FORMAT = -21
+ARCHIVE_ERROR_READ_ONLY = -22
+ARCHIVE_ERROR_NO_MEMORY = -23
+
+class ArchiveRow(ctypes.Structure):
+	_fields_ = [
+		('status', ctypes.c_int),
+		('crc_status', ctypes.c_int),
+		('source', ctypes.c_uint32),
+		('size', ctypes.c_uint32),
+		('offset', ctypes.c_uint64),
+		('header', RpiHatHeader),
+		('num_atoms', ctypes.c_uint32),
+		('atoms_checked', ctypes.c_uint32),
+		('atoms_failed', ctypes.c_uint32),
+		('uuid', ctypes.c_uint8 * 16),
+		('product_id', ctypes.c_uint16),
+		('product_version', ctypes.c_uint16),
+		('has_vendor_info', ctypes.c_int),
+		('has_dt_overlay', ctypes.c_int),
+		('vendor_offset', ctypes.c_uint32),
+		('product_offset', ctypes.c_uint32),
+		('dt_overlay_offset', ctypes.c_uint32)
+	]
+
+archive_lib.archive_summarize_image.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ArchiveRow),
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+archive_lib.archive_summarize_image.restype = ctypes.c_int
+
+archive_lib.archive_scan_files.argtypes = [
+	ctypes.POINTER(ctypes.c_char_p),
+	ctypes.c_uint32,
+	ctypes.POINTER(ArchiveRow),
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.c_uint32
+]
+archive_lib.archive_scan_files.restype = ctypes.c_int
+
+archive_lib.archive_scan_container.argtypes = [
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ArchiveRow),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.c_uint32
+]
+archive_lib.archive_scan_container.restype = ctypes.c_int
+
+archive_lib.get_archive_error_message.argtypes = [ctypes.c_int]
+archive_lib.get_archive_error_message.restype = ctypes.c_char_p
+
+
+def get_archive_error_message(error_code: int) -> str:
+	"""Human-readable message for an archive or parse error code."""
+	return archive_lib.get_archive_error_message(error_code).decode('utf-8')
+
+
+def _arena_string(arena, offset: int):
+	if offset == ARENA_OFFSET_NONE or offset >= len(arena):
+		return None
+	return ctypes.string_at(ctypes.addressof(arena) + offset).decode('utf-8', errors='replace')
+
+
+def row_to_dict(row: ArchiveRow, arena) -> dict:
+	"""Flatten a scan row into the summary fields used for audits."""
+	return {
+		'status': row.status,
+		'crc_ok': row.status == PARSE_OK and row.crc_status == PARSE_OK,
+		'size': row.size,
+		'offset': row.offset,
+		'num_atoms': row.num_atoms,
+		'atoms_failed': row.atoms_failed,
+		'uuid': bytes(row.uuid).hex() if row.has_vendor_info else None,
+		'vendor': _arena_string(arena, row.vendor_offset),
+		'product': _arena_string(arena, row.product_offset),
+		'product_id': row.product_id,
+		'product_version': row.product_version,
+		'overlay': _arena_string(arena, row.dt_overlay_offset),
+	}
+
+
+def scan_files(paths: Sequence[str], num_threads: int = 0,
+			   arena_size: int = DEFAULT_BATCH_ARENA_SIZE) -> List[dict]:
+	"""
+	Summarize dump files in one foreign call; each file is mmap'd, not read.
+
+	Args:
+		paths: Dump file paths
+		num_threads: Worker threads in the DLL (0 = one per CPU)
+		arena_size: Initial string arena size (grown automatically)
+
+	Returns:
+		list: One dict per path (see row_to_dict), with 'path' added
+	"""
+	count = len(paths)
+	encoded = (ctypes.c_char_p * count)(*[os.fsencode(path) for path in paths])
+	rows = (ArchiveRow * count)()
+	arena = ctypes.create_string_buffer(arena_size)
+	arena_used = ctypes.c_uint32()
+
+	while True:
+		status = archive_lib.archive_scan_files(encoded, count, rows, arena, len(arena),
+												ctypes.byref(arena_used), num_threads)
+		grown = _grow_arena(arena, arena_used.value) if status == PARSE_ERROR_BUFFER_TOO_SMALL else None
+		if grown is None:
+			break
+		arena = grown
+
+	results = []
+	for path, row in zip(paths, rows):
+		summary = row_to_dict(row, arena)
+		summary['path'] = path
+		results.append(summary)
+	return results
+
+
+def scan_directory(directory: str, pattern: str = '*.bin', recursive: bool = False, num_threads: int = 0) -> List[dict]:
+	"""Summarize every dump in a directory matching pattern (see scan_files)."""
+	search = os.path.join(directory, '**', pattern) if recursive else os.path.join(directory, pattern)
+	paths = sorted(path for path in glob.glob(search, recursive=recursive) if os.path.isfile(path))
+	return scan_files(paths, num_threads)
+
+
+def scan_container(path: str, stride: int, num_threads: int = 0,
+				   arena_size: int = DEFAULT_BATCH_ARENA_SIZE) -> Tuple[int, List[dict]]:
+	"""
+	Summarize a container of stride-sized dumps stored back to back.
+
+	Returns:
+		tuple: (status, one dict per slot); status is ARCHIVE_ERROR_IO if the file cannot be mapped
+	"""
+	num_rows = ctypes.c_uint32()
+	rows = (ArchiveRow * 0)()
+	arena = ctypes.create_string_buffer(arena_size)
+	arena_used = ctypes.c_uint32()
+
+	while True:
+		status = archive_lib.archive_scan_container(os.fsencode(path), stride, rows, len(rows),
+													ctypes.byref(num_rows), arena, len(arena),
+													ctypes.byref(arena_used), num_threads)
+		if status != PARSE_ERROR_BUFFER_TOO_SMALL:
+			break
+		if num_rows.value > len(rows):
+			rows = (ArchiveRow * num_rows.value)()
+		else:
+			grown = _grow_arena(arena, arena_used.value)
+			if grown is None:
+				break
+			arena = grown
+
+	if status != PARSE_OK:
+		return (status, [])
+	return (status, [row_to_dict(row, arena) for row in rows[:num_rows.value]])
+
+
+if __name__ == '__main__':
+	import sys
+
+	if len(sys.argv) < 2:
+		print("Usage: python -m rpihatparser.rpi_hat_archive_wrapper <directory> [pattern]")
+		sys.exit(1)
+
+	for summary in scan_directory(sys.argv[1], sys.argv[2] if len(sys.argv) > 2 else '*.bin'):
+		if summary['status'] != PARSE_OK:
+			print(f"{summary['path']}: {get_archive_error_message(summary['status'])}")
+			continue
+		print(f"{summary['path']}: {summary['vendor']} / {summary['product']} "
+			  f"(id 0x{summary['product_id']:04x}, v{summary['product_version']}), "
+			  f"overlay {summary['overlay']}, CRC {'OK' if summary['crc_ok'] else 'MISMATCH'}")
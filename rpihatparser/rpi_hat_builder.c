@@ -0,0 +1,227 @@
+#include "rpi_hat_builder.h"
+#include <string.h>
+
+#define HAT_SIGNATURE  "R-Pi"
+#define EEPLEN_OFFSET  8
+
+static void write_le16(uint8_t* out, uint32_t offset, uint16_t value) {
+	out[offset] = (uint8_t)(value & 0xFF);
+	out[offset + 1] = (uint8_t)(value >> 8);
+}
+
+static void write_le32(uint8_t* out, uint32_t offset, uint32_t value) {
+	out[offset] = (uint8_t)(value & 0xFF);
+	out[offset + 1] = (uint8_t)((value >> 8) & 0xFF);
+	out[offset + 2] = (uint8_t)((value >> 16) & 0xFF);
+	out[offset + 3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t vendor_data_size(const HatVendorSpec* vendor) {
+	return VENDOR_ATOM_FIXED_SIZE + vendor->vendor_len + vendor->product_len;
+}
+
+static uint32_t gpio_data_size(int bank1) {
+	return 2 + (bank1 ? GPIO_COUNT_BANK1 : GPIO_COUNT_BANK0);
+}
+
+static uint16_t count_atoms(const HatImageSpec* spec) {
+	uint32_t num_atoms = 1;
+
+	if (spec->gpio_bank0)
+		num_atoms++;
+	if (spec->has_dt_overlay)
+		num_atoms++;
+	num_atoms += spec->num_custom_blobs;
+	if (spec->gpio_bank1)
+		num_atoms++;
+	if (spec->has_power_supply)
+		num_atoms++;
+
+	return (uint16_t)num_atoms;
+}
+
+uint32_t hat_image_size(const HatImageSpec* spec) {
+	if (spec == NULL)
+		return 0;
+
+	uint32_t size = FIRST_ATOM_OFFSET + ATOM_HEADER_SIZE + vendor_data_size(&spec->vendor) + 2;
+
+	if (spec->gpio_bank0)
+		size += ATOM_HEADER_SIZE + gpio_data_size(0) + 2;
+	if (spec->has_dt_overlay)
+		size += ATOM_HEADER_SIZE + spec->dt_overlay.length + 2;
+	for (uint32_t i = 0; i < spec->num_custom_blobs; i++)
+		size += ATOM_HEADER_SIZE + spec->custom_blobs[i].length + 2;
+	if (spec->gpio_bank1)
+		size += ATOM_HEADER_SIZE + gpio_data_size(1) + 2;
+	if (spec->has_power_supply)
+		size += ATOM_HEADER_SIZE + 4 + 2;
+
+	return size;
+}
+
+// Writes the atom header at *pos and returns the data offset; the caller fills data_len bytes then calls end_atom
+static uint32_t begin_atom(uint8_t* out, uint32_t* pos, uint16_t atom_type, uint16_t* atom_count, uint32_t data_len) {
+	write_le16(out, *pos, atom_type);
+	write_le16(out, *pos + 2, (*atom_count)++);
+	write_le32(out, *pos + 4, data_len + 2);
+	*pos += ATOM_HEADER_SIZE;
+	return *pos;
+}
+
+static void end_atom(uint8_t* out, uint32_t* pos, uint32_t data_start, uint32_t data_len) {
+	write_le16(out, data_start + data_len, crc16_update(CRC16_INIT, &out[data_start], data_len));
+	*pos = data_start + data_len + 2;
+}
+
+static void write_gpio_atom(uint8_t* out, uint32_t* pos, uint16_t* atom_count, const HatGpioSpec* gpio, int bank1) {
+	uint32_t data_len = gpio_data_size(bank1);
+	uint32_t start = begin_atom(out, pos, bank1 ? ATOM_TYPE_GPIO_BANK1 : ATOM_TYPE_GPIO_MAP, atom_count, data_len);
+
+	out[start] = gpio->flags;
+	out[start + 1] = gpio->power;
+	memcpy(&out[start + 2], gpio->pins, data_len - 2);
+
+	end_atom(out, pos, start, data_len);
+}
+
+static void write_blob_atom(uint8_t* out, uint32_t* pos, uint16_t* atom_count, uint16_t atom_type, const ByteView* blob) {
+	uint32_t start = begin_atom(out, pos, atom_type, atom_count, blob->length);
+
+	if (blob->length > 0)
+		memcpy(&out[start], blob->data, blob->length);
+
+	end_atom(out, pos, start, blob->length);
+}
+
+int build_hat_image(const HatImageSpec* spec, uint8_t* out, uint32_t out_size, uint32_t* image_size) {
+	if (spec == NULL ||
+		(spec->vendor.vendor == NULL && spec->vendor.vendor_len > 0) ||
+		(spec->vendor.product == NULL && spec->vendor.product_len > 0) ||
+		(spec->custom_blobs == NULL && spec->num_custom_blobs > 0)) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (spec->has_dt_overlay && spec->dt_overlay.data == NULL && spec->dt_overlay.length > 0)
+		return PARSE_ERROR_INVALID_DATA;
+
+	for (uint32_t i = 0; i < spec->num_custom_blobs; i++) {
+		if (spec->custom_blobs[i].data == NULL && spec->custom_blobs[i].length > 0)
+			return PARSE_ERROR_INVALID_DATA;
+	}
+
+	uint32_t size = hat_image_size(spec);
+	if (image_size)
+		*image_size = size;
+
+	if (out == NULL || out_size < size)
+		return PARSE_ERROR_BUFFER_TOO_SMALL;
+
+	// Header; eeplen is known up front so nothing is patched afterwards
+	memcpy(out, HAT_SIGNATURE, 4);
+	out[4] = spec->format_version;
+	out[5] = 0;
+	write_le16(out, 6, count_atoms(spec));
+	write_le32(out, EEPLEN_OFFSET, size);
+
+	uint32_t pos = FIRST_ATOM_OFFSET;
+	uint16_t atom_count = 0;
+
+	const HatVendorSpec* vendor = &spec->vendor;
+	uint32_t vendor_len = vendor_data_size(vendor);
+	uint32_t start = begin_atom(out, &pos, ATOM_TYPE_VENDOR_INFO, &atom_count, vendor_len);
+	for (int i = 0; i < 4; i++)
+		write_le32(out, start + 4 * i, vendor->serial[i]);
+	write_le16(out, start + 16, vendor->product_id);
+	write_le16(out, start + 18, vendor->product_version);
+	out[start + 20] = vendor->vendor_len;
+	out[start + 21] = vendor->product_len;
+	if (vendor->vendor_len > 0)
+		memcpy(&out[start + VENDOR_ATOM_FIXED_SIZE], vendor->vendor, vendor->vendor_len);
+	if (vendor->product_len > 0)
+		memcpy(&out[start + VENDOR_ATOM_FIXED_SIZE + vendor->vendor_len], vendor->product, vendor->product_len);
+	end_atom(out, &pos, start, vendor_len);
+
+	if (spec->gpio_bank0)
+		write_gpio_atom(out, &pos, &atom_count, spec->gpio_bank0, 0);
+
+	if (spec->has_dt_overlay)
+		write_blob_atom(out, &pos, &atom_count, ATOM_TYPE_DT_OVERLAY, &spec->dt_overlay);
+
+	for (uint32_t i = 0; i < spec->num_custom_blobs; i++)
+		write_blob_atom(out, &pos, &atom_count, ATOM_TYPE_CUSTOM, &spec->custom_blobs[i]);
+
+	if (spec->gpio_bank1)
+		write_gpio_atom(out, &pos, &atom_count, spec->gpio_bank1, 1);
+
+	if (spec->has_power_supply) {
+		start = begin_atom(out, &pos, ATOM_TYPE_POWER_SUPPLY, &atom_count, 4);
+		write_le32(out, start, spec->current_supply_ma);
+		end_atom(out, &pos, start, 4);
+	}
+
+	return PARSE_OK;
+}
+
+int hat_template_init(HatTemplate* tpl, uint8_t* image, uint32_t size) {
+	if (tpl == NULL || image == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	memset(tpl, 0, sizeof(HatTemplate));
+	tpl->image = image;
+	tpl->size = size;
+	tpl->vendor_atom = -1;
+
+	int ret = index_rpi_hat_eeprom(image, size, NULL, tpl->atoms, HAT_TEMPLATE_MAX_ATOMS, &tpl->num_atoms);
+	if (ret != PARSE_OK)
+		return ret;
+
+	if (tpl->num_atoms > HAT_TEMPLATE_MAX_ATOMS)
+		return PARSE_ERROR_BUFFER_TOO_SMALL;
+
+	for (uint32_t i = 0; i < tpl->num_atoms; i++) {
+		if (tpl->atoms[i].type == ATOM_TYPE_VENDOR_INFO && tpl->atoms[i].dlen >= VENDOR_ATOM_FIXED_SIZE + 2) {
+			tpl->vendor_atom = (int32_t)i;
+			break;
+		}
+	}
+
+	return PARSE_OK;
+}
+
+int hat_template_patch(HatTemplate* tpl, uint32_t atom_index, uint32_t offset, const uint8_t* data, uint32_t length,
+					   uint32_t* first_byte, uint32_t* last_byte) {
+	if (tpl == NULL || tpl->image == NULL || atom_index >= tpl->num_atoms || (data == NULL && length > 0)) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	const AtomView* atom = &tpl->atoms[atom_index];
+	if (atom->dlen < 2)
+		return PARSE_ERROR_INVALID_DATA;
+
+	uint32_t data_len = atom->dlen - 2;
+	if (offset > data_len || length > data_len - offset)
+		return PARSE_ERROR_INVALID_DATA;
+
+	memcpy(&tpl->image[atom->offset + offset], data, length);
+	write_le16(tpl->image, atom->offset + data_len, crc16_update(CRC16_INIT, &tpl->image[atom->offset], data_len));
+
+	if (first_byte)
+		*first_byte = atom->offset + offset;
+	if (last_byte)
+		*last_byte = atom->offset + data_len + 2;
+
+	return PARSE_OK;
+}
+
+int hat_template_set_uuid(HatTemplate* tpl, const uint8_t* uuid) {
+	if (tpl == NULL || uuid == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (tpl->vendor_atom < 0)
+		return PARSE_ERROR_NOT_FOUND;
+
+	return hat_template_patch(tpl, (uint32_t)tpl->vendor_atom, 0, uuid, HAT_UUID_SIZE, NULL, NULL);
+}
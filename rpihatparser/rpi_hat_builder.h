@@ -0,0 +1,135 @@
+/**
+ * rpi_hat_builder.h
+ *
+ * Raspberry Pi HAT EEPROM image builder (same layout as eepmake.py)
+ * Header file for DLL interface
+ */
+
+#ifndef RPI_HAT_BUILDER_H
+#define RPI_HAT_BUILDER_H
+
+#include <stdint.h>
+#include "rpi_hat_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ATOM_TYPE_GPIO_BANK1     5
+#define ATOM_TYPE_POWER_SUPPLY   6
+
+#define HAT_FORMAT_V1            0x01
+#define HAT_FORMAT_HATPLUS       0x02
+
+#define GPIO_COUNT_BANK0         28
+#define GPIO_COUNT_BANK1         18
+
+#define VENDOR_ATOM_FIXED_SIZE   22    // UUID + product ID/version + two string lengths
+#define HAT_TEMPLATE_MAX_ATOMS   32
+#define HAT_UUID_SIZE            16
+
+typedef struct {
+    uint32_t serial[4];         // UUID as four little-endian words (eepmake's product_serial)
+    uint16_t product_id;
+    uint16_t product_version;
+    const char* vendor;         // Vendor string, not NUL-terminated
+    uint8_t vendor_len;
+    const char* product;        // Product string, not NUL-terminated
+    uint8_t product_len;
+} HatVendorSpec;
+
+typedef struct {
+    uint8_t flags;
+    uint8_t power;
+    uint8_t pins[GPIO_COUNT_BANK0];  // Bank 1 uses the first GPIO_COUNT_BANK1 entries
+} HatGpioSpec;
+
+typedef struct {
+    uint8_t format_version;          // HAT_FORMAT_V1 or HAT_FORMAT_HATPLUS
+    HatVendorSpec vendor;
+    const HatGpioSpec* gpio_bank0;   // NULL if absent
+    int has_dt_overlay;
+    ByteView dt_overlay;
+    const ByteView* custom_blobs;    // num_custom_blobs custom data atoms
+    uint32_t num_custom_blobs;
+    const HatGpioSpec* gpio_bank1;   // NULL if absent
+    int has_power_supply;
+    uint32_t current_supply_ma;
+} HatImageSpec;
+
+// Built image plus its atom table, used to patch per-board fields in place
+typedef struct {
+    uint8_t* image;                           // Caller-owned image buffer
+    uint32_t size;
+    uint32_t num_atoms;
+    AtomView atoms[HAT_TEMPLATE_MAX_ATOMS];   // Patch table: data offset and length of every atom
+    int32_t vendor_atom;                      // Index of the vendor info atom, -1 if absent
+} HatTemplate;
+
+/**
+ * Compute the size of the image build_hat_image would produce
+ *
+ * @param spec: Image contents
+ * @return: Image size in bytes (0 if spec is NULL)
+ */
+uint32_t hat_image_size(const HatImageSpec* spec);
+
+/**
+ * Serialize a HAT EEPROM image into a caller buffer
+ *
+ * Atoms are written in eepmake order (vendor, GPIO bank 0, DT overlay,
+ * custom blobs, GPIO bank 1, power supply). Atom lengths, CRCs and eeplen
+ * are filled in during the same pass, so the output matches
+ * EepMake.write_binary byte for byte.
+ *
+ * @param spec: Image contents
+ * @param out: Output buffer
+ * @param out_size: Size of out in bytes
+ * @param image_size: Optional pointer to receive the image size (also set when out is too small)
+ * @return: PARSE_OK, PARSE_ERROR_BUFFER_TOO_SMALL or PARSE_ERROR_INVALID_DATA
+ */
+int build_hat_image(const HatImageSpec* spec, uint8_t* out, uint32_t out_size, uint32_t* image_size);
+
+/**
+ * Prepare a template from a built image
+ *
+ * Indexes the atoms once; later patches only touch the patched atom and
+ * its CRC. The image buffer stays owned by the caller and is patched in
+ * place.
+ *
+ * @param tpl: Template to initialize
+ * @param image: Image from build_hat_image (or any valid HAT image)
+ * @param size: Size of the image in bytes
+ * @return: PARSE_OK, PARSE_ERROR_BUFFER_TOO_SMALL if the image has more than HAT_TEMPLATE_MAX_ATOMS atoms, or a parse error
+ */
+int hat_template_init(HatTemplate* tpl, uint8_t* image, uint32_t size);
+
+/**
+ * Overwrite bytes inside one atom's data and recompute that atom's CRC
+ *
+ * @param tpl: Template
+ * @param atom_index: Atom to patch
+ * @param offset: Offset within the atom data
+ * @param data: Replacement bytes
+ * @param length: Number of bytes (must stay inside the atom data)
+ * @param first_byte: Optional pointer to receive the image offset of the first changed byte
+ * @param last_byte: Optional pointer to receive the image offset just past the CRC
+ * @return: PARSE_OK or PARSE_ERROR_INVALID_DATA
+ */
+int hat_template_patch(HatTemplate* tpl, uint32_t atom_index, uint32_t offset, const uint8_t* data, uint32_t length,
+                       uint32_t* first_byte, uint32_t* last_byte);
+
+/**
+ * Set the vendor atom UUID and recompute the vendor atom CRC
+ *
+ * @param tpl: Template
+ * @param uuid: HAT_UUID_SIZE bytes, in image byte order
+ * @return: PARSE_OK, or PARSE_ERROR_NOT_FOUND if the image has no vendor atom
+ */
+int hat_template_set_uuid(HatTemplate* tpl, const uint8_t* uuid);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RPI_HAT_BUILDER_H
@@ -0,0 +1,222 @@
+"""
+Python wrapper for the RPi HAT EEPROM image builder in rpi_hat_parser DLL
+"""
+
+import ctypes
+from typing import Optional, Sequence, Tuple
+
+from .rpi_hat_parser_wrapper import dll_path, AtomView, ByteView, PARSE_OK, get_parse_error_message
+
+builder_lib = ctypes.cdll.LoadLibrary(dll_path)
+
+HAT_FORMAT_V1 = 0x01
+HAT_FORMAT_HATPLUS = 0x02
+
+GPIO_COUNT_BANK0 = 28
+GPIO_COUNT_BANK1 = 18
+
+HAT_TEMPLATE_MAX_ATOMS = 32
+HAT_UUID_SIZE = 16
+
+class HatVendorSpec(ctypes.Structure):
+	_fields_ = [
+		('serial', ctypes.c_uint32 * 4),
+		('product_id', ctypes.c_uint16),
+		('product_version', ctypes.c_uint16),
+		('vendor', ctypes.c_char_p),
+		('vendor_len', ctypes.c_uint8),
+		('product', ctypes.c_char_p),
+		('product_len', ctypes.c_uint8)
+	]
+
+class HatGpioSpec(ctypes.Structure):
+	_fields_ = [
+		('flags', ctypes.c_uint8),
+		('power', ctypes.c_uint8),
+		('pins', ctypes.c_uint8 * GPIO_COUNT_BANK0)
+	]
+
+class HatImageSpec(ctypes.Structure):
+	_fields_ = [
+		('format_version', ctypes.c_uint8),
+		('vendor', HatVendorSpec),
+		('gpio_bank0', ctypes.POINTER(HatGpioSpec)),
+		('has_dt_overlay', ctypes.c_int),
+		('dt_overlay', ByteView),
+		('custom_blobs', ctypes.POINTER(ByteView)),
+		('num_custom_blobs', ctypes.c_uint32),
+		('gpio_bank1', ctypes.POINTER(HatGpioSpec)),
+		('has_power_supply', ctypes.c_int),
+		('current_supply_ma', ctypes.c_uint32)
+	]
+
+class HatTemplate(ctypes.Structure):
+	_fields_ = [
+		('image', ctypes.POINTER(ctypes.c_uint8)),
+		('size', ctypes.c_uint32),
+		('num_atoms', ctypes.c_uint32),
+		('atoms', AtomView * HAT_TEMPLATE_MAX_ATOMS),
+		('vendor_atom', ctypes.c_int32)
+	]
+
+builder_lib.hat_image_size.argtypes = [ctypes.POINTER(HatImageSpec)]
+builder_lib.hat_image_size.restype = ctypes.c_uint32
+
+builder_lib.build_hat_image.argtypes = [
+	ctypes.POINTER(HatImageSpec),
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+builder_lib.build_hat_image.restype = ctypes.c_int
+
+builder_lib.hat_template_init.argtypes = [ctypes.POINTER(HatTemplate), ctypes.POINTER(ctypes.c_uint8), ctypes.c_uint32]
+builder_lib.hat_template_init.restype = ctypes.c_int
+
+builder_lib.hat_template_patch.argtypes = [
+	ctypes.POINTER(HatTemplate),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.POINTER(ctypes.c_uint32)
+]
+builder_lib.hat_template_patch.restype = ctypes.c_int
+
+builder_lib.hat_template_set_uuid.argtypes = [ctypes.POINTER(HatTemplate), ctypes.c_char_p]
+builder_lib.hat_template_set_uuid.restype = ctypes.c_int
+
+
+def _gpio_spec(gpio: Tuple[int, int, Sequence[int]], pin_count: int) -> HatGpioSpec:
+	flags, power, pins = gpio
+	spec = HatGpioSpec()
+	spec.flags = flags
+	spec.power = power
+	for i, pin in enumerate(list(pins)[:pin_count]):
+		spec.pins[i] = pin
+	return spec
+
+
+def _byte_view(data: bytes) -> ByteView:
+	return ByteView(ctypes.cast(data, ctypes.c_void_p), len(data))
+
+
+def build_hat_image(format_version: int, serial: Sequence[int], product_id: int, product_version: int,
+					vendor: bytes, product: bytes,
+					gpio_bank0: Optional[Tuple[int, int, Sequence[int]]] = None,
+					dt_overlay: Optional[bytes] = None,
+					custom_blobs: Sequence[bytes] = (),
+					gpio_bank1: Optional[Tuple[int, int, Sequence[int]]] = None,
+					current_supply_ma: Optional[int] = None) -> bytes:
+	"""
+	Serialize a HAT EEPROM image in one DLL call.
+	
+	Args:
+		format_version: HAT_FORMAT_V1 or HAT_FORMAT_HATPLUS
+		serial: UUID as four 32-bit words
+		product_id: Product ID
+		product_version: Product version
+		vendor: Vendor string bytes
+		product: Product string bytes
+		gpio_bank0: Optional (flags, power, pins) for the bank 0 GPIO atom
+		dt_overlay: Optional DT overlay atom data
+		custom_blobs: Custom data atom payloads
+		gpio_bank1: Optional (flags, power, pins) for the bank 1 GPIO atom
+		current_supply_ma: Optional power supply atom value
+		
+	Returns:
+		bytes: The image, identical to EepMake.write_binary output
+	"""
+	# The vendor atom stores each length in one byte
+	if len(vendor) > 255:
+		raise ValueError(f"Vendor string is {len(vendor)} bytes, at most 255 fit")
+	if len(product) > 255:
+		raise ValueError(f"Product string is {len(product)} bytes, at most 255 fit")
+
+	spec = HatImageSpec()
+	spec.format_version = format_version
+	for i, word in enumerate(serial):
+		spec.vendor.serial[i] = word
+	spec.vendor.product_id = product_id
+	spec.vendor.product_version = product_version
+	spec.vendor.vendor = vendor
+	spec.vendor.vendor_len = len(vendor)
+	spec.vendor.product = product
+	spec.vendor.product_len = len(product)
+
+	keep = [vendor, product]
+	if gpio_bank0 is not None:
+		bank0 = _gpio_spec(gpio_bank0, GPIO_COUNT_BANK0)
+		spec.gpio_bank0 = ctypes.pointer(bank0)
+	if dt_overlay is not None:
+		dt_overlay = bytes(dt_overlay)
+		keep.append(dt_overlay)
+		spec.has_dt_overlay = 1
+		spec.dt_overlay = _byte_view(dt_overlay)
+	blobs = [bytes(blob) for blob in custom_blobs]
+	blob_views = (ByteView * max(len(blobs), 1))(*[_byte_view(blob) for blob in blobs])
+	spec.custom_blobs = blob_views
+	spec.num_custom_blobs = len(blobs)
+	if gpio_bank1 is not None:
+		bank1 = _gpio_spec(gpio_bank1, GPIO_COUNT_BANK1)
+		spec.gpio_bank1 = ctypes.pointer(bank1)
+	if current_supply_ma is not None:
+		spec.has_power_supply = 1
+		spec.current_supply_ma = current_supply_ma
+
+	size = builder_lib.hat_image_size(ctypes.byref(spec))
+	image = bytearray(size)
+	status = builder_lib.build_hat_image(ctypes.byref(spec), (ctypes.c_uint8 * size).from_buffer(image),
+										 size, None)
+	if status != PARSE_OK:
+		raise ValueError(get_parse_error_message(status))
+	return bytes(image)
+
+
+class ImageTemplate:
+	"""
+	A built image whose per-board fields are patched in place.
+	
+	The atom table is built once; each patch rewrites only the patched bytes
+	and the CRC of the atom that contains them.
+	"""
+
+	def __init__(self, image: bytes):
+		self._image = bytearray(image)
+		self._buffer = (ctypes.c_uint8 * len(self._image)).from_buffer(self._image)
+		self._tpl = HatTemplate()
+		status = builder_lib.hat_template_init(ctypes.byref(self._tpl), self._buffer, len(self._image))
+		if status != PARSE_OK:
+			raise ValueError(get_parse_error_message(status))
+
+	@property
+	def image(self) -> bytes:
+		return bytes(self._image)
+
+	@property
+	def atoms(self):
+		return self._tpl.atoms[:self._tpl.num_atoms]
+
+	def set_uuid(self, uuid_bytes: bytes):
+		"""Patch the vendor atom UUID (16 bytes, image byte order) and its CRC."""
+		if len(uuid_bytes) != HAT_UUID_SIZE:
+			raise ValueError(f"UUID must be {HAT_UUID_SIZE} bytes")
+		status = builder_lib.hat_template_set_uuid(ctypes.byref(self._tpl), bytes(uuid_bytes))
+		if status != PARSE_OK:
+			raise ValueError(get_parse_error_message(status))
+
+	def patch(self, atom_index: int, offset: int, data: bytes) -> Tuple[int, int]:
+		"""
+		Overwrite bytes inside one atom and recompute its CRC.
+		
+		Returns:
+			tuple: (first, end) image offsets of the changed range, CRC included
+		"""
+		first = ctypes.c_uint32()
+		end = ctypes.c_uint32()
+		status = builder_lib.hat_template_patch(ctypes.byref(self._tpl), atom_index, offset, bytes(data), len(data),
+												ctypes.byref(first), ctypes.byref(end))
+		if status != PARSE_OK:
+			raise ValueError(get_parse_error_message(status))
+		return (first.value, end.value)
@@ -0,0 +1,860 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "rpi_hat_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define pack_fseek(f, offset) _fseeki64((f), (__int64)(offset), SEEK_SET)
+#define pack_fseek_end(f) _fseeki64((f), 0, SEEK_END)
+#define pack_ftell(f) ((int64_t)_ftelli64(f))
+#define pack_truncate(f, size) _chsize_s(_fileno(f), (__int64)(size))
+#else
+#include <sys/types.h>
+#include <unistd.h>
+#define pack_fseek(f, offset) fseeko((f), (off_t)(offset), SEEK_SET)
+#define pack_fseek_end(f) fseeko((f), 0, SEEK_END)
+#define pack_ftell(f) ((int64_t)ftello(f))
+#define pack_truncate(f, size) ftruncate(fileno(f), (off_t)(size))
+#endif
+
+#define PACK_MAGIC            "RPIHPACK"
+#define PACK_MAX_IMAGE_SIZE   (16u << 20)   // Far above any EEPROM; bounds allocations for damaged files
+#define PACK_INITIAL_SLOTS    1024u         // Hash table size, power of two
+#define PACK_LOAD_CHUNK       (1u << 20)    // Entries are read in blocks of this size when opening
+#define DELTA_RUN_HEADER      8             // uint32 offset + uint32 length
+#define DELTA_MERGE_GAP       DELTA_RUN_HEADER  // Equal gaps shorter than a run header are cheaper to copy
+#define FNV64_OFFSET          0xcbf29ce484222325ull
+#define FNV64_PRIME           0x100000001b3ull
+
+typedef struct {
+	uint8_t uuid[HAT_PACK_UUID_SIZE];
+	uint64_t hash;
+	uint64_t file_offset;     // Offset of the entry; the payload follows it
+	uint32_t image_size;
+	uint32_t payload_size;
+	uint32_t base;
+	uint16_t kind;
+} PackRecord;
+
+// Open-addressing table of record IDs, HAT_PACK_NO_RECORD marks an empty slot
+typedef struct {
+	uint32_t* slots;
+	uint32_t mask;
+	uint32_t used;
+} RecordTable;
+
+typedef struct {
+	uint32_t record_id;
+	uint8_t* image;
+} CachedTemplate;
+
+struct HatPack {
+	FILE* file;
+	int writable;
+	uint64_t end_offset;          // Where the next record is written
+	PackRecord* records;
+	uint32_t count;
+	uint32_t capacity;
+	RecordTable by_uuid;          // Latest non-template record per UUID
+	RecordTable by_hash;          // Every record with a payload, for dedup
+	CachedTemplate* templates;
+	uint32_t num_templates;
+	uint8_t* scratch;             // Reconstructed candidate images
+	uint32_t scratch_size;
+	uint8_t* payload;             // Delta payloads being read or built
+	uint32_t payload_size;
+};
+
+static void put_le16(uint8_t* out, uint32_t offset, uint16_t value) {
+	out[offset] = (uint8_t)value;
+	out[offset + 1] = (uint8_t)(value >> 8);
+}
+
+static void put_le32(uint8_t* out, uint32_t offset, uint32_t value) {
+	for (uint32_t i = 0; i < 4; i++)
+		out[offset + i] = (uint8_t)(value >> (8 * i));
+}
+
+static void put_le64(uint8_t* out, uint32_t offset, uint64_t value) {
+	for (uint32_t i = 0; i < 8; i++)
+		out[offset + i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint16_t get_le16(const uint8_t* data, uint32_t offset) {
+	return (uint16_t)(data[offset] | (data[offset + 1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t* data, uint32_t offset) {
+	return (uint32_t)data[offset] | ((uint32_t)data[offset + 1] << 8) |
+		   ((uint32_t)data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+}
+
+static uint64_t get_le64(const uint8_t* data, uint32_t offset) {
+	return (uint64_t)get_le32(data, offset) | ((uint64_t)get_le32(data, offset + 4) << 32);
+}
+
+static uint64_t fnv1a64(const uint8_t* data, uint32_t length) {
+	uint64_t hash = FNV64_OFFSET;
+	for (uint32_t i = 0; i < length; i++) {
+		hash ^= data[i];
+		hash *= FNV64_PRIME;
+	}
+	return hash;
+}
+
+static int read_at(FILE* file, uint64_t offset, void* buffer, uint32_t length) {
+	if (pack_fseek(file, offset) != 0)
+		return -1;
+	return (fread(buffer, 1, length, file) == length) ? 0 : -1;
+}
+
+static int write_at(FILE* file, uint64_t offset, const void* buffer, uint32_t length) {
+	if (pack_fseek(file, offset) != 0)
+		return -1;
+	return (length == 0 || fwrite(buffer, 1, length, file) == length) ? 0 : -1;
+}
+
+static int ensure_buffer(uint8_t** buffer, uint32_t* size, uint32_t needed) {
+	if (*size >= needed)
+		return 0;
+
+	uint8_t* grown = (uint8_t*)realloc(*buffer, needed);
+	if (grown == NULL)
+		return -1;
+
+	*buffer = grown;
+	*size = needed;
+	return 0;
+}
+
+static void encode_entry(const PackRecord* record, uint8_t* entry) {
+	memset(entry, 0, HAT_PACK_ENTRY_SIZE);
+	entry[0] = 'P';
+	entry[1] = 'K';
+	put_le16(entry, 2, record->kind);
+	put_le32(entry, 4, record->image_size);
+	put_le32(entry, 8, record->payload_size);
+	put_le32(entry, 12, record->base);
+	memcpy(&entry[16], record->uuid, HAT_PACK_UUID_SIZE);
+	put_le64(entry, 32, record->hash);
+	put_le16(entry, HAT_PACK_ENTRY_SIZE - 2, crc16_update(CRC16_INIT, entry, HAT_PACK_ENTRY_SIZE - 2));
+}
+
+static int entry_intact(const uint8_t* entry) {
+	return entry[0] == 'P' && entry[1] == 'K' &&
+		   get_le16(entry, HAT_PACK_ENTRY_SIZE - 2) == crc16_update(CRC16_INIT, entry, HAT_PACK_ENTRY_SIZE - 2);
+}
+
+// Validates an intact entry against the records before it; kinds may only reference earlier records
+static int decode_entry(const HatPack* pack, const uint8_t* entry, PackRecord* record) {
+
+	record->kind = get_le16(entry, 2);
+	record->image_size = get_le32(entry, 4);
+	record->payload_size = get_le32(entry, 8);
+	record->base = get_le32(entry, 12);
+	memcpy(record->uuid, &entry[16], HAT_PACK_UUID_SIZE);
+	record->hash = get_le64(entry, 32);
+
+	if (record->image_size == 0 || record->image_size > PACK_MAX_IMAGE_SIZE)
+		return -1;
+
+	switch (record->kind) {
+		case HAT_PACK_KIND_TEMPLATE:
+		case HAT_PACK_KIND_FULL:
+			return (record->payload_size == record->image_size && record->base == HAT_PACK_NO_RECORD) ? 0 : -1;
+
+		case HAT_PACK_KIND_DELTA:
+			return (record->base < pack->count && pack->records[record->base].kind == HAT_PACK_KIND_TEMPLATE &&
+					record->payload_size <= record->image_size) ? 0 : -1;
+
+		case HAT_PACK_KIND_DUPLICATE:
+			return (record->base < pack->count && pack->records[record->base].kind != HAT_PACK_KIND_DUPLICATE &&
+					pack->records[record->base].image_size == record->image_size &&
+					record->payload_size == 0) ? 0 : -1;
+
+		default:
+			return -1;
+	}
+}
+
+static uint32_t uuid_slot(const uint8_t* uuid, uint32_t mask) {
+	return (uint32_t)(fnv1a64(uuid, HAT_PACK_UUID_SIZE) >> 16) & mask;
+}
+
+static uint32_t hash_slot(uint64_t hash, uint32_t mask) {
+	return (uint32_t)(hash ^ (hash >> 32)) & mask;
+}
+
+static int table_init(RecordTable* table, uint32_t num_slots) {
+	table->slots = (uint32_t*)malloc((size_t)num_slots * sizeof(uint32_t));
+	if (table->slots == NULL)
+		return -1;
+
+	memset(table->slots, 0xFF, (size_t)num_slots * sizeof(uint32_t));
+	table->mask = num_slots - 1;
+	table->used = 0;
+	return 0;
+}
+
+static void uuid_table_put(HatPack* pack, RecordTable* table, uint32_t record_id) {
+	const uint8_t* uuid = pack->records[record_id].uuid;
+	uint32_t slot = uuid_slot(uuid, table->mask);
+
+	for (;;) {
+		uint32_t existing = table->slots[slot];
+		if (existing == HAT_PACK_NO_RECORD) {
+			table->slots[slot] = record_id;
+			table->used++;
+			return;
+		}
+		if (memcmp(pack->records[existing].uuid, uuid, HAT_PACK_UUID_SIZE) == 0) {
+			table->slots[slot] = record_id;
+			return;
+		}
+		slot = (slot + 1) & table->mask;
+	}
+}
+
+static void hash_table_put(HatPack* pack, RecordTable* table, uint32_t record_id) {
+	uint32_t slot = hash_slot(pack->records[record_id].hash, table->mask);
+
+	while (table->slots[slot] != HAT_PACK_NO_RECORD)
+		slot = (slot + 1) & table->mask;
+
+	table->slots[slot] = record_id;
+	table->used++;
+}
+
+// Keeps the load factor at or below one half
+static int table_reserve(HatPack* pack, RecordTable* table, int by_uuid) {
+	if ((table->used + 1) * 2 <= table->mask + 1)
+		return 0;
+
+	RecordTable grown;
+	if (table_init(&grown, (table->mask + 1) * 2) != 0)
+		return -1;
+
+	for (uint32_t i = 0; i <= table->mask; i++) {
+		uint32_t record_id = table->slots[i];
+		if (record_id == HAT_PACK_NO_RECORD)
+			continue;
+		if (by_uuid)
+			uuid_table_put(pack, &grown, record_id);
+		else
+			hash_table_put(pack, &grown, record_id);
+	}
+
+	free(table->slots);
+	*table = grown;
+	return 0;
+}
+
+// Makes room for one more record so that insert_record cannot fail
+static int reserve_record(HatPack* pack) {
+	if (pack->count == pack->capacity) {
+		uint32_t capacity = pack->capacity ? pack->capacity * 2 : 1024;
+		PackRecord* grown = (PackRecord*)realloc(pack->records, (size_t)capacity * sizeof(PackRecord));
+		if (grown == NULL)
+			return -1;
+		pack->records = grown;
+		pack->capacity = capacity;
+	}
+
+	if (table_reserve(pack, &pack->by_uuid, 1) != 0 || table_reserve(pack, &pack->by_hash, 0) != 0)
+		return -1;
+
+	return 0;
+}
+
+static uint32_t insert_record(HatPack* pack, const PackRecord* record) {
+	uint32_t record_id = pack->count;
+	pack->records[record_id] = *record;
+	pack->count++;
+
+	if (record->kind != HAT_PACK_KIND_TEMPLATE)
+		uuid_table_put(pack, &pack->by_uuid, record_id);
+	if (record->kind != HAT_PACK_KIND_DUPLICATE)
+		hash_table_put(pack, &pack->by_hash, record_id);
+
+	return record_id;
+}
+
+static int reconstruct(HatPack* pack, uint32_t record_id, uint8_t* out);
+
+static const uint8_t* template_image(HatPack* pack, uint32_t record_id, int* status) {
+	for (uint32_t i = 0; i < pack->num_templates; i++) {
+		if (pack->templates[i].record_id == record_id)
+			return pack->templates[i].image;
+	}
+
+	CachedTemplate* grown = (CachedTemplate*)realloc(pack->templates, (pack->num_templates + 1) * sizeof(CachedTemplate));
+	if (grown == NULL) {
+		*status = ARCHIVE_ERROR_NO_MEMORY;
+		return NULL;
+	}
+	pack->templates = grown;
+
+	uint8_t* image = (uint8_t*)malloc(pack->records[record_id].image_size);
+	if (image == NULL) {
+		*status = ARCHIVE_ERROR_NO_MEMORY;
+		return NULL;
+	}
+
+	*status = reconstruct(pack, record_id, image);
+	if (*status != PARSE_OK) {
+		free(image);
+		return NULL;
+	}
+
+	pack->templates[pack->num_templates].record_id = record_id;
+	pack->templates[pack->num_templates].image = image;
+	pack->num_templates++;
+	return image;
+}
+
+static int apply_delta(const uint8_t* payload, uint32_t payload_size, uint8_t* out, uint32_t image_size) {
+	uint32_t pos = 0;
+
+	while (pos < payload_size) {
+		if (payload_size - pos < DELTA_RUN_HEADER)
+			return ARCHIVE_ERROR_FORMAT;
+
+		uint32_t offset = get_le32(payload, pos);
+		uint32_t length = get_le32(payload, pos + 4);
+		pos += DELTA_RUN_HEADER;
+
+		if (length > payload_size - pos || offset > image_size || length > image_size - offset)
+			return ARCHIVE_ERROR_FORMAT;
+
+		memcpy(&out[offset], &payload[pos], length);
+		pos += length;
+	}
+
+	return PARSE_OK;
+}
+
+// out must hold the record's image_size bytes
+static int reconstruct(HatPack* pack, uint32_t record_id, uint8_t* out) {
+	const PackRecord* record = &pack->records[record_id];
+	uint64_t payload_offset = record->file_offset + HAT_PACK_ENTRY_SIZE;
+
+	switch (record->kind) {
+		case HAT_PACK_KIND_TEMPLATE:
+		case HAT_PACK_KIND_FULL:
+			return (read_at(pack->file, payload_offset, out, record->image_size) == 0) ? PARSE_OK : ARCHIVE_ERROR_IO;
+
+		case HAT_PACK_KIND_DUPLICATE:
+			// Bases are never duplicates, so this recurses at most twice
+			return reconstruct(pack, record->base, out);
+
+		case HAT_PACK_KIND_DELTA: {
+			int status = PARSE_OK;
+			const uint8_t* base = template_image(pack, record->base, &status);
+			if (base == NULL)
+				return status;
+
+			// Bytes past the end of the template must be covered by runs
+			uint32_t base_size = pack->records[record->base].image_size;
+			uint32_t common = (base_size < record->image_size) ? base_size : record->image_size;
+			memcpy(out, base, common);
+			memset(&out[common], 0xFF, record->image_size - common);
+
+			if (ensure_buffer(&pack->payload, &pack->payload_size, record->payload_size) != 0)
+				return ARCHIVE_ERROR_NO_MEMORY;
+			if (read_at(pack->file, payload_offset, pack->payload, record->payload_size) != 0)
+				return ARCHIVE_ERROR_IO;
+
+			return apply_delta(pack->payload, record->payload_size, out, record->image_size);
+		}
+
+		default:
+			return ARCHIVE_ERROR_FORMAT;
+	}
+}
+
+// Returns the first record with a payload whose image equals image, or HAT_PACK_NO_RECORD
+static uint32_t find_identical(HatPack* pack, const uint8_t* image, uint32_t size, uint64_t hash, int templates_only) {
+	uint32_t slot = hash_slot(hash, pack->by_hash.mask);
+
+	for (;;) {
+		uint32_t record_id = pack->by_hash.slots[slot];
+		if (record_id == HAT_PACK_NO_RECORD)
+			return HAT_PACK_NO_RECORD;
+
+		const PackRecord* record = &pack->records[record_id];
+		if (record->hash == hash && record->image_size == size &&
+			(!templates_only || record->kind == HAT_PACK_KIND_TEMPLATE) &&
+			ensure_buffer(&pack->scratch, &pack->scratch_size, size) == 0 &&
+			reconstruct(pack, record_id, pack->scratch) == PARSE_OK &&
+			memcmp(pack->scratch, image, size) == 0)
+			return record_id;
+
+		slot = (slot + 1) & pack->by_hash.mask;
+	}
+}
+
+// Encodes runs of bytes that differ from base; returns the payload size, or UINT32_MAX if it exceeds capacity
+static uint32_t build_delta(const uint8_t* image, uint32_t size, const uint8_t* base, uint32_t base_size,
+							uint8_t* out, uint32_t capacity) {
+	uint32_t used = 0;
+	uint32_t i = 0;
+
+	while (i < size) {
+		if (i < base_size && image[i] == base[i]) {
+			i++;
+			continue;
+		}
+
+		uint32_t start = i;
+		uint32_t end = i + 1;
+		for (uint32_t j = i + 1; j < size && j - end < DELTA_MERGE_GAP; j++) {
+			if (j >= base_size || image[j] != base[j])
+				end = j + 1;
+		}
+
+		uint32_t length = end - start;
+		if (length + DELTA_RUN_HEADER > capacity - used)
+			return UINT32_MAX;
+
+		put_le32(out, used, start);
+		put_le32(out, used + 4, length);
+		memcpy(&out[used + DELTA_RUN_HEADER], &image[start], length);
+		used += DELTA_RUN_HEADER + length;
+		i = end;
+	}
+
+	return used;
+}
+
+static int write_record(HatPack* pack, PackRecord* record, const uint8_t* payload, uint32_t* record_id) {
+	uint8_t entry[HAT_PACK_ENTRY_SIZE];
+
+	// Reserve first so a record that reached the file is always indexed
+	if (reserve_record(pack) != 0)
+		return ARCHIVE_ERROR_NO_MEMORY;
+
+	record->file_offset = pack->end_offset;
+	encode_entry(record, entry);
+
+	// On failure end_offset stays put and the partial bytes are cut off, so the next append
+	// cannot leave the tail of this one behind it; if the cut fails, reopening drops the torn tail
+	if (write_at(pack->file, record->file_offset, entry, HAT_PACK_ENTRY_SIZE) != 0 ||
+		(record->payload_size > 0 && fwrite(payload, 1, record->payload_size, pack->file) != record->payload_size) ||
+		fflush(pack->file) != 0) {
+		fflush(pack->file);
+		(void)pack_truncate(pack->file, pack->end_offset);
+		return ARCHIVE_ERROR_IO;
+	}
+
+	pack->end_offset += HAT_PACK_ENTRY_SIZE + record->payload_size;
+	uint32_t new_id = insert_record(pack, record);
+	if (record_id)
+		*record_id = new_id;
+	return PARSE_OK;
+}
+
+static int image_uuid(const uint8_t* image, uint32_t size, uint8_t* uuid) {
+	AtomView atoms[MAX_INTEGRITY_ATOMS];
+	uint32_t num_atoms = 0;
+
+	int ret = index_rpi_hat_eeprom(image, size, NULL, atoms, MAX_INTEGRITY_ATOMS, &num_atoms);
+	if (ret != PARSE_OK)
+		return ret;
+
+	if (num_atoms > MAX_INTEGRITY_ATOMS)
+		num_atoms = MAX_INTEGRITY_ATOMS;
+
+	const AtomView* vendor = find_atom_view(atoms, num_atoms, ATOM_TYPE_VENDOR_INFO);
+	if (vendor == NULL || vendor->dlen < HAT_PACK_UUID_SIZE + 2)
+		return PARSE_ERROR_NOT_FOUND;
+
+	memcpy(uuid, &image[vendor->offset], HAT_PACK_UUID_SIZE);
+	return PARSE_OK;
+}
+
+// Fills chunk with the file from offset on; returns the bytes read
+static uint32_t read_chunk(FILE* file, uint64_t offset, uint64_t file_size, uint8_t* chunk) {
+	uint64_t left = file_size - offset;
+	uint32_t length = (left < PACK_LOAD_CHUNK) ? (uint32_t)left : PACK_LOAD_CHUNK;
+	return (read_at(file, offset, chunk, length) == 0) ? length : 0;
+}
+
+// Whether an intact entry starts anywhere in [offset, file_size): tells a torn last record,
+// which nothing follows, from damage in the middle of the pack
+static int entry_follows(FILE* file, uint64_t offset, uint64_t file_size, uint8_t* chunk) {
+	while (offset + HAT_PACK_ENTRY_SIZE <= file_size) {
+		uint32_t length = read_chunk(file, offset, file_size, chunk);
+		if (length < HAT_PACK_ENTRY_SIZE)
+			return 1;  // Unreadable, so it cannot be shown to be a torn tail
+
+		for (uint32_t i = 0; i + HAT_PACK_ENTRY_SIZE <= length; i++) {
+			if (chunk[i] == 'P' && entry_intact(&chunk[i]))
+				return 1;
+		}
+
+		// Overlap chunks so an entry straddling the boundary is seen
+		offset += length - HAT_PACK_ENTRY_SIZE + 1;
+	}
+
+	return 0;
+}
+
+static int load_records(HatPack* pack) {
+	if (pack_fseek_end(pack->file) != 0)
+		return ARCHIVE_ERROR_IO;
+	int64_t file_size = pack_ftell(pack->file);
+	if (file_size < 0)
+		return ARCHIVE_ERROR_IO;
+
+	uint8_t header[HAT_PACK_HEADER_SIZE];
+
+	if (file_size == 0 && pack->writable) {
+		memcpy(header, PACK_MAGIC, 8);
+		put_le32(header, 8, HAT_PACK_VERSION);
+		put_le32(header, 12, HAT_PACK_ENTRY_SIZE);
+		if (write_at(pack->file, 0, header, HAT_PACK_HEADER_SIZE) != 0 || fflush(pack->file) != 0)
+			return ARCHIVE_ERROR_IO;
+		pack->end_offset = HAT_PACK_HEADER_SIZE;
+		return PARSE_OK;
+	}
+
+	if (file_size < HAT_PACK_HEADER_SIZE || read_at(pack->file, 0, header, HAT_PACK_HEADER_SIZE) != 0 ||
+		memcmp(header, PACK_MAGIC, 8) != 0 || get_le32(header, 8) != HAT_PACK_VERSION ||
+		get_le32(header, 12) != HAT_PACK_ENTRY_SIZE)
+		return ARCHIVE_ERROR_FORMAT;
+
+	// One sequential pass: entries are decoded from large blocks instead of a seek per record
+	uint8_t* chunk = (uint8_t*)malloc(PACK_LOAD_CHUNK);
+	if (chunk == NULL)
+		return ARCHIVE_ERROR_NO_MEMORY;
+
+	uint64_t size = (uint64_t)file_size;
+	uint64_t offset = HAT_PACK_HEADER_SIZE;
+	uint64_t chunk_offset = 0;
+	uint32_t chunk_length = 0;
+	int ret = PARSE_OK;
+
+	while (offset + HAT_PACK_ENTRY_SIZE <= size) {
+		if (offset < chunk_offset || offset + HAT_PACK_ENTRY_SIZE > chunk_offset + chunk_length) {
+			chunk_offset = offset;
+			chunk_length = read_chunk(pack->file, offset, size, chunk);
+			if (chunk_length < HAT_PACK_ENTRY_SIZE) {
+				ret = ARCHIVE_ERROR_IO;
+				break;
+			}
+		}
+
+		const uint8_t* entry = &chunk[offset - chunk_offset];
+		PackRecord record;
+
+		if (!entry_intact(entry)) {
+			// A torn last record is dropped; a damaged one with records after it fails the open,
+			// as appending over it would lose them for good
+			if (entry_follows(pack->file, offset + 1, size, chunk))
+				ret = ARCHIVE_ERROR_FORMAT;
+			break;
+		}
+
+		if (decode_entry(pack, entry, &record) != 0) {
+			ret = ARCHIVE_ERROR_FORMAT;
+			break;
+		}
+
+		// An intact entry whose payload runs past the end is the torn record of an interrupted append
+		if (offset + HAT_PACK_ENTRY_SIZE + record.payload_size > size)
+			break;
+
+		record.file_offset = offset;
+		if (reserve_record(pack) != 0) {
+			ret = ARCHIVE_ERROR_NO_MEMORY;
+			break;
+		}
+		insert_record(pack, &record);
+
+		offset += HAT_PACK_ENTRY_SIZE + record.payload_size;
+	}
+
+	free(chunk);
+	if (ret != PARSE_OK)
+		return ret;
+
+	// Cut the torn tail off so a shorter append cannot leave part of it behind the new record
+	if (offset < size && pack->writable &&
+		(fflush(pack->file) != 0 || pack_truncate(pack->file, offset) != 0))
+		return ARCHIVE_ERROR_IO;
+
+	pack->end_offset = offset;
+	return PARSE_OK;
+}
+
+int hat_pack_open(const char* path, uint32_t flags, HatPack** pack) {
+	if (pack == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	*pack = NULL;
+
+	if (path == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (flags & HAT_PACK_CREATE)
+		flags |= HAT_PACK_WRITE;
+
+	HatPack* p = (HatPack*)calloc(1, sizeof(HatPack));
+	if (p == NULL) {
+		return ARCHIVE_ERROR_NO_MEMORY;
+	}
+
+	p->writable = (flags & HAT_PACK_WRITE) != 0;
+
+	if (table_init(&p->by_uuid, PACK_INITIAL_SLOTS) != 0 || table_init(&p->by_hash, PACK_INITIAL_SLOTS) != 0) {
+		hat_pack_close(p);
+		return ARCHIVE_ERROR_NO_MEMORY;
+	}
+
+	p->file = fopen(path, p->writable ? "r+b" : "rb");
+	if (p->file == NULL && (flags & HAT_PACK_CREATE))
+		p->file = fopen(path, "w+b");
+
+	if (p->file == NULL) {
+		hat_pack_close(p);
+		return ARCHIVE_ERROR_IO;
+	}
+
+	int ret = load_records(p);
+	if (ret != PARSE_OK) {
+		hat_pack_close(p);
+		return ret;
+	}
+
+	*pack = p;
+	return PARSE_OK;
+}
+
+void hat_pack_close(HatPack* pack) {
+	if (pack == NULL)
+		return;
+
+	if (pack->file != NULL)
+		fclose(pack->file);
+
+	for (uint32_t i = 0; i < pack->num_templates; i++)
+		free(pack->templates[i].image);
+
+	free(pack->templates);
+	free(pack->records);
+	free(pack->by_uuid.slots);
+	free(pack->by_hash.slots);
+	free(pack->scratch);
+	free(pack->payload);
+	free(pack);
+}
+
+int hat_pack_add_template(HatPack* pack, const uint8_t* image, uint32_t size, uint32_t* template_id) {
+	if (pack == NULL || image == NULL || size == 0 || size > PACK_MAX_IMAGE_SIZE || template_id == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (!pack->writable) {
+		return ARCHIVE_ERROR_READ_ONLY;
+	}
+
+	PackRecord record;
+	memset(&record, 0, sizeof(record));
+	record.hash = fnv1a64(image, size);
+
+	uint32_t existing = find_identical(pack, image, size, record.hash, 1);
+	if (existing != HAT_PACK_NO_RECORD) {
+		*template_id = existing;
+		return PARSE_OK;
+	}
+
+	// A template without a vendor atom is stored under the all-zero UUID
+	if (image_uuid(image, size, record.uuid) != PARSE_OK)
+		memset(record.uuid, 0, HAT_PACK_UUID_SIZE);
+
+	record.kind = HAT_PACK_KIND_TEMPLATE;
+	record.image_size = size;
+	record.payload_size = size;
+	record.base = HAT_PACK_NO_RECORD;
+
+	return write_record(pack, &record, image, template_id);
+}
+
+int hat_pack_append(HatPack* pack, const uint8_t* image, uint32_t size, const uint8_t* uuid,
+					uint32_t template_id, uint32_t* record_id) {
+	if (pack == NULL || image == NULL || size == 0 || size > PACK_MAX_IMAGE_SIZE) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (!pack->writable) {
+		return ARCHIVE_ERROR_READ_ONLY;
+	}
+
+	if (template_id != HAT_PACK_NO_RECORD &&
+		(template_id >= pack->count || pack->records[template_id].kind != HAT_PACK_KIND_TEMPLATE)) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	PackRecord record;
+	memset(&record, 0, sizeof(record));
+
+	if (uuid != NULL) {
+		memcpy(record.uuid, uuid, HAT_PACK_UUID_SIZE);
+	} else {
+		int ret = image_uuid(image, size, record.uuid);
+		if (ret != PARSE_OK)
+			return ret;
+	}
+
+	record.hash = fnv1a64(image, size);
+	record.image_size = size;
+
+	uint32_t identical = find_identical(pack, image, size, record.hash, 0);
+	if (identical != HAT_PACK_NO_RECORD) {
+		record.kind = HAT_PACK_KIND_DUPLICATE;
+		record.base = identical;
+		return write_record(pack, &record, NULL, record_id);
+	}
+
+	if (template_id != HAT_PACK_NO_RECORD) {
+		int status = PARSE_OK;
+		const uint8_t* base = template_image(pack, template_id, &status);
+		if (base == NULL)
+			return status;
+
+		if (ensure_buffer(&pack->payload, &pack->payload_size, size) != 0)
+			return ARCHIVE_ERROR_NO_MEMORY;
+
+		uint32_t delta_size = build_delta(image, size, base, pack->records[template_id].image_size,
+										  pack->payload, size);
+		if (delta_size != UINT32_MAX) {
+			record.kind = HAT_PACK_KIND_DELTA;
+			record.base = template_id;
+			record.payload_size = delta_size;
+			return write_record(pack, &record, pack->payload, record_id);
+		}
+	}
+
+	record.kind = HAT_PACK_KIND_FULL;
+	record.base = HAT_PACK_NO_RECORD;
+	record.payload_size = size;
+	return write_record(pack, &record, image, record_id);
+}
+
+uint32_t hat_pack_count(const HatPack* pack) {
+	return (pack != NULL) ? pack->count : 0;
+}
+
+int hat_pack_get_info(const HatPack* pack, uint32_t record_id, HatPackRecordInfo* info) {
+	if (pack == NULL || info == NULL || record_id >= pack->count) {
+		return PARSE_ERROR_NOT_FOUND;
+	}
+
+	const PackRecord* record = &pack->records[record_id];
+	memset(info, 0, sizeof(HatPackRecordInfo));
+	info->record_id = record_id;
+	info->kind = record->kind;
+	info->image_size = record->image_size;
+	info->payload_size = record->payload_size;
+	info->base = record->base;
+	memcpy(info->uuid, record->uuid, HAT_PACK_UUID_SIZE);
+	info->hash = record->hash;
+	info->file_offset = record->file_offset;
+	return PARSE_OK;
+}
+
+int hat_pack_find(const HatPack* pack, const uint8_t* uuid, uint32_t* record_id) {
+	if (pack == NULL || uuid == NULL || record_id == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	uint32_t slot = uuid_slot(uuid, pack->by_uuid.mask);
+
+	for (;;) {
+		uint32_t candidate = pack->by_uuid.slots[slot];
+		if (candidate == HAT_PACK_NO_RECORD)
+			return PARSE_ERROR_NOT_FOUND;
+
+		if (memcmp(pack->records[candidate].uuid, uuid, HAT_PACK_UUID_SIZE) == 0) {
+			*record_id = candidate;
+			return PARSE_OK;
+		}
+
+		slot = (slot + 1) & pack->by_uuid.mask;
+	}
+}
+
+int hat_pack_read(HatPack* pack, uint32_t record_id, uint8_t* out, uint32_t out_size, uint32_t* image_size) {
+	if (pack == NULL || record_id >= pack->count) {
+		return PARSE_ERROR_NOT_FOUND;
+	}
+
+	uint32_t size = pack->records[record_id].image_size;
+	if (image_size)
+		*image_size = size;
+
+	if (out == NULL || out_size < size) {
+		return PARSE_ERROR_BUFFER_TOO_SMALL;
+	}
+
+	return reconstruct(pack, record_id, out);
+}
+
+int hat_pack_scan(HatPack* pack, uint32_t first_record, ArchiveRow* rows, uint32_t max_rows, uint32_t* num_rows,
+				  char* arena, uint32_t arena_size, uint32_t* arena_used) {
+	if (num_rows)
+		*num_rows = 0;
+
+	if (pack == NULL || (rows == NULL && max_rows > 0)) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	uint32_t count = 0;
+	uint32_t used = 0;
+
+	for (uint32_t record_id = first_record; record_id < pack->count && count < max_rows; record_id++) {
+		const PackRecord* record = &pack->records[record_id];
+		ArchiveRow* row = &rows[count++];
+
+		if (ensure_buffer(&pack->scratch, &pack->scratch_size, record->image_size) != 0)
+			return ARCHIVE_ERROR_NO_MEMORY;
+
+		int status = reconstruct(pack, record_id, pack->scratch);
+		uint32_t needed = 0;
+
+		if (status == PARSE_OK) {
+			// Each image gets the rest of the arena; shift its offsets to be relative to arena
+			int fits = (arena != NULL && used < arena_size);
+			archive_summarize_image(pack->scratch, record->image_size, row, fits ? arena + used : NULL,
+									fits ? arena_size - used : 0, &needed);
+			uint32_t* offsets[3] = { &row->vendor_offset, &row->product_offset, &row->dt_overlay_offset };
+			for (uint32_t i = 0; i < 3; i++) {
+				if (*offsets[i] != ARENA_OFFSET_NONE)
+					*offsets[i] += used;
+			}
+			used = (needed > ARENA_SIZE_OVERFLOW - used) ? ARENA_SIZE_OVERFLOW : used + needed;
+		} else {
+			archive_summarize_image(NULL, 0, row, NULL, 0, NULL);
+			row->status = status;
+			row->size = record->image_size;
+		}
+
+		row->source = record_id;
+		row->offset = record->file_offset;
+	}
+
+	if (num_rows)
+		*num_rows = count;
+	if (arena_used)
+		*arena_used = used;
+
+	return (used > arena_size) ? PARSE_ERROR_BUFFER_TOO_SMALL : PARSE_OK;
+}
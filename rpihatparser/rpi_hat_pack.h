@@ -0,0 +1,187 @@
+/**
+ * rpi_hat_pack.h
+ *
+ * Packed, appendable archive of RPi HAT EEPROM images
+ * Header file for DLL interface
+ */
+
+#ifndef RPI_HAT_PACK_H
+#define RPI_HAT_PACK_H
+
+#include <stdint.h>
+#include "rpi_hat_parser.h"
+#include "rpi_hat_archive.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// hat_pack_open flags
+#define HAT_PACK_WRITE               0x01  // Allow appends
+#define HAT_PACK_CREATE              0x02  // Create the file if it does not exist (implies HAT_PACK_WRITE)
+
+// Record kinds
+#define HAT_PACK_KIND_TEMPLATE       1     // Full image, base for deltas; not returned by hat_pack_find
+#define HAT_PACK_KIND_FULL           2     // Full image
+#define HAT_PACK_KIND_DELTA          3     // Runs of bytes that differ from template record base
+#define HAT_PACK_KIND_DUPLICATE      4     // Byte-identical to record base, no payload
+
+#define HAT_PACK_NO_RECORD           0xFFFFFFFFu
+#define HAT_PACK_UUID_SIZE           16
+
+/*
+ * File layout (all integers little-endian):
+ *   16-byte file header: "RPIHPACK", version, entry size
+ *   Records, appended in order: a HAT_PACK_ENTRY_SIZE entry, then payload_size bytes
+ *     Entry: magic "PK", kind, image_size, payload_size, base, uuid[16], image hash (FNV-1a 64),
+ *            reserved, CRC16 of the preceding entry bytes
+ *     DELTA payload: repeated { uint32 offset, uint32 length, length bytes }
+ * Record IDs are positions in the file. Only a torn last record (a crash
+ * mid-append) is dropped: opening for writing cuts it off and the next
+ * append takes its place. A damaged entry with any intact entry after it
+ * makes hat_pack_open fail with ARCHIVE_ERROR_FORMAT instead, so the
+ * records behind it are never hidden or overwritten.
+ *
+ * There is no persisted index. hat_pack_open rebuilds the UUID and dedup
+ * hash tables in one sequential pass over the file, reading it in 1 MB
+ * blocks; entries are fixed-size and delta payloads are small, so this is
+ * about one read per 20000 records.
+ */
+#define HAT_PACK_VERSION             1
+#define HAT_PACK_HEADER_SIZE         16
+#define HAT_PACK_ENTRY_SIZE          48
+
+typedef struct HatPack HatPack;
+
+// One record as returned by hat_pack_get_info
+typedef struct {
+    uint32_t record_id;
+    uint16_t kind;              // HAT_PACK_KIND_*
+    uint32_t image_size;        // Size of the reconstructed image
+    uint32_t payload_size;      // Bytes stored for this record
+    uint32_t base;              // Template (DELTA) or source record (DUPLICATE), else HAT_PACK_NO_RECORD
+    uint8_t uuid[HAT_PACK_UUID_SIZE];
+    uint64_t hash;              // FNV-1a 64 of the image
+    uint64_t file_offset;       // Offset of the record entry in the file
+} HatPackRecordInfo;
+
+/**
+ * Open a pack file
+ *
+ * Reads every entry once to build the in-memory UUID and dedup indexes.
+ * A torn last record is dropped (and cut off when opened for writing).
+ *
+ * @param path: Pack file
+ * @param flags: HAT_PACK_WRITE and/or HAT_PACK_CREATE
+ * @param pack: Receives the pack handle (close with hat_pack_close)
+ * @return: PARSE_OK, ARCHIVE_ERROR_IO, ARCHIVE_ERROR_NO_MEMORY, or ARCHIVE_ERROR_FORMAT for a file
+ *          that is not a pack or has a damaged record before its last one
+ */
+int hat_pack_open(const char* path, uint32_t flags, HatPack** pack);
+
+/**
+ * Flush and close a pack
+ *
+ * @param pack: Pack handle (NULL is ignored)
+ */
+void hat_pack_close(HatPack* pack);
+
+/**
+ * Store a template image, the base for later delta records
+ *
+ * An identical template already in the pack is reused.
+ *
+ * @param pack: Pack opened with HAT_PACK_WRITE
+ * @param image: Template image (e.g. from build_hat_image)
+ * @param size: Image size in bytes
+ * @param template_id: Receives the template's record ID
+ * @return: PARSE_OK, ARCHIVE_ERROR_READ_ONLY, ARCHIVE_ERROR_IO or ARCHIVE_ERROR_NO_MEMORY
+ */
+int hat_pack_add_template(HatPack* pack, const uint8_t* image, uint32_t size, uint32_t* template_id);
+
+/**
+ * Append a board image
+ *
+ * A byte-identical image already in the pack is stored as a DUPLICATE
+ * with no payload. Otherwise, with a template the image is stored as a
+ * DELTA of the bytes that differ from it (usually just the vendor atom
+ * UUID and CRC), unless the delta would be larger than the image.
+ *
+ * @param pack: Pack opened with HAT_PACK_WRITE
+ * @param image: Image bytes
+ * @param size: Image size in bytes
+ * @param uuid: HAT_PACK_UUID_SIZE byte key, or NULL to use the vendor atom UUID
+ * @param template_id: Template record to delta against, or HAT_PACK_NO_RECORD
+ * @param record_id: Optional pointer to receive the new record ID
+ * @return: PARSE_OK; if uuid is NULL, PARSE_ERROR_NOT_FOUND when the image has no vendor atom or the
+ *          parse error for an invalid image; PARSE_ERROR_INVALID_DATA if template_id is not a template;
+ *          or an ARCHIVE_ERROR_* code
+ */
+int hat_pack_append(HatPack* pack, const uint8_t* image, uint32_t size, const uint8_t* uuid,
+                    uint32_t template_id, uint32_t* record_id);
+
+/**
+ * Number of records in the pack, templates included
+ *
+ * @param pack: Pack handle
+ * @return: Record count (record IDs run from 0 to count - 1)
+ */
+uint32_t hat_pack_count(const HatPack* pack);
+
+/**
+ * Describe one record, for iterating the pack in append order
+ *
+ * @param pack: Pack handle
+ * @param record_id: Record to describe
+ * @param info: Receives the record description
+ * @return: PARSE_OK or PARSE_ERROR_NOT_FOUND
+ */
+int hat_pack_get_info(const HatPack* pack, uint32_t record_id, HatPackRecordInfo* info);
+
+/**
+ * Find the latest record stored under a UUID
+ *
+ * @param pack: Pack handle
+ * @param uuid: HAT_PACK_UUID_SIZE byte key
+ * @param record_id: Receives the record ID
+ * @return: PARSE_OK or PARSE_ERROR_NOT_FOUND
+ */
+int hat_pack_find(const HatPack* pack, const uint8_t* uuid, uint32_t* record_id);
+
+/**
+ * Reconstruct a record's image
+ *
+ * @param pack: Pack handle
+ * @param record_id: Record to read
+ * @param out: Output buffer
+ * @param out_size: Size of out in bytes
+ * @param image_size: Optional pointer to receive the image size (also set when out is too small)
+ * @return: PARSE_OK, PARSE_ERROR_NOT_FOUND, PARSE_ERROR_BUFFER_TOO_SMALL, ARCHIVE_ERROR_IO or ARCHIVE_ERROR_FORMAT
+ */
+int hat_pack_read(HatPack* pack, uint32_t record_id, uint8_t* out, uint32_t out_size, uint32_t* image_size);
+
+/**
+ * Summarize records like archive_scan_files, one row per record
+ *
+ * Templates get rows too (check the record kind with hat_pack_get_info to
+ * tell them apart). Rows carry the record ID in source and the entry file
+ * offset in offset.
+ *
+ * @param pack: Pack handle
+ * @param first_record: First record to scan
+ * @param rows: Array of max_rows rows to fill
+ * @param max_rows: Number of records to scan at most
+ * @param num_rows: Receives the number of rows filled
+ * @param arena: Caller storage for string payloads
+ * @param arena_size: Size of arena in bytes
+ * @param arena_used: Optional pointer to receive the arena bytes needed
+ * @return: PARSE_OK, PARSE_ERROR_BUFFER_TOO_SMALL if some strings did not fit, or ARCHIVE_ERROR_NO_MEMORY
+ */
+int hat_pack_scan(HatPack* pack, uint32_t first_record, ArchiveRow* rows, uint32_t max_rows, uint32_t* num_rows,
+                  char* arena, uint32_t arena_size, uint32_t* arena_used);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RPI_HAT_PACK_H
@@ -0,0 +1,251 @@
+"""
+Python wrapper for the packed EEPROM image archive in rpi_hat_parser DLL
+"""
+
+import ctypes
+import os
+from typing import Iterator, List, Optional, Tuple, Union
+
+from .rpi_hat_parser_wrapper import dll_path, PARSE_OK, PARSE_ERROR_BUFFER_TOO_SMALL, DEFAULT_BATCH_ARENA_SIZE, _data_pointer, _grow_arena
+from .rpi_hat_archive_wrapper import ArchiveRow, row_to_dict, get_archive_error_message
+
+pack_lib = ctypes.cdll.LoadLibrary(dll_path)
+
+HAT_PACK_WRITE = 0x01
+HAT_PACK_CREATE = 0x02
+
+HAT_PACK_KIND_TEMPLATE = 1
+HAT_PACK_KIND_FULL = 2
+HAT_PACK_KIND_DELTA = 3
+HAT_PACK_KIND_DUPLICATE = 4
+
+HAT_PACK_NO_RECORD = 0xFFFFFFFF
+HAT_PACK_UUID_SIZE = 16
+
+KIND_NAMES = {
+	HAT_PACK_KIND_TEMPLATE: 'template',
+	HAT_PACK_KIND_FULL: 'full',
+	HAT_PACK_KIND_DELTA: 'delta',
+	HAT_PACK_KIND_DUPLICATE: 'duplicate',
+}
+
+class HatPackRecordInfo(ctypes.Structure):
+	_fields_ = [
+		('record_id', ctypes.c_uint32),
+		('kind', ctypes.c_uint16),
+		('image_size', ctypes.c_uint32),
+		('payload_size', ctypes.c_uint32),
+		('base', ctypes.c_uint32),
+		('uuid', ctypes.c_uint8 * HAT_PACK_UUID_SIZE),
+		('hash', ctypes.c_uint64),
+		('file_offset', ctypes.c_uint64)
+	]
+
+pack_lib.hat_pack_open.argtypes = [ctypes.c_char_p, ctypes.c_uint32, ctypes.POINTER(ctypes.c_void_p)]
+pack_lib.hat_pack_open.restype = ctypes.c_int
+
+pack_lib.hat_pack_close.argtypes = [ctypes.c_void_p]
+pack_lib.hat_pack_close.restype = None
+
+pack_lib.hat_pack_add_template.argtypes = [
+	ctypes.c_void_p,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+pack_lib.hat_pack_add_template.restype = ctypes.c_int
+
+pack_lib.hat_pack_append.argtypes = [
+	ctypes.c_void_p,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+pack_lib.hat_pack_append.restype = ctypes.c_int
+
+pack_lib.hat_pack_count.argtypes = [ctypes.c_void_p]
+pack_lib.hat_pack_count.restype = ctypes.c_uint32
+
+pack_lib.hat_pack_get_info.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.POINTER(HatPackRecordInfo)]
+pack_lib.hat_pack_get_info.restype = ctypes.c_int
+
+pack_lib.hat_pack_find.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint8), ctypes.POINTER(ctypes.c_uint32)]
+pack_lib.hat_pack_find.restype = ctypes.c_int
+
+pack_lib.hat_pack_read.argtypes = [
+	ctypes.c_void_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+pack_lib.hat_pack_read.restype = ctypes.c_int
+
+pack_lib.hat_pack_scan.argtypes = [
+	ctypes.c_void_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ArchiveRow),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+pack_lib.hat_pack_scan.restype = ctypes.c_int
+
+
+def _uuid_bytes(uuid: Union[bytes, str]) -> bytes:
+	if isinstance(uuid, str):
+		uuid = bytes.fromhex(uuid.replace('-', ''))
+	if len(uuid) != HAT_PACK_UUID_SIZE:
+		raise ValueError(f"UUID must be {HAT_PACK_UUID_SIZE} bytes")
+	return bytes(uuid)
+
+
+def info_to_dict(info: HatPackRecordInfo) -> dict:
+	"""Flatten a record description."""
+	return {
+		'record_id': info.record_id,
+		'kind': KIND_NAMES.get(info.kind, info.kind),
+		'image_size': info.image_size,
+		'payload_size': info.payload_size,
+		'base': None if info.base == HAT_PACK_NO_RECORD else info.base,
+		'uuid': bytes(info.uuid).hex(),
+		'hash': info.hash,
+		'file_offset': info.file_offset,
+	}
+
+
+class HatPack:
+	"""
+	Appendable pack of EEPROM images with template deltas and dedup.
+
+	Open the pack once for a whole production run; appends go straight to
+	the file, so a crash loses at most the record being written.
+	"""
+
+	def __init__(self, path: str, writable: bool = False, create: bool = False):
+		flags = (HAT_PACK_WRITE if writable else 0) | (HAT_PACK_CREATE if create else 0)
+		self._handle = ctypes.c_void_p()
+		status = pack_lib.hat_pack_open(os.fsencode(path), flags, ctypes.byref(self._handle))
+		if status != PARSE_OK:
+			raise IOError(f"Cannot open pack {path}: {get_archive_error_message(status)}")
+		self.path = path
+
+	def close(self):
+		if self._handle:
+			pack_lib.hat_pack_close(self._handle)
+			self._handle = ctypes.c_void_p()
+
+	def __enter__(self):
+		return self
+
+	def __exit__(self, *args):
+		self.close()
+
+	def __del__(self):
+		self.close()
+
+	def __len__(self) -> int:
+		return pack_lib.hat_pack_count(self._handle)
+
+	def add_template(self, image: bytes) -> Tuple[int, int]:
+		"""Store a template image. Returns (status, template record ID)."""
+		template_id = ctypes.c_uint32(HAT_PACK_NO_RECORD)
+		status = pack_lib.hat_pack_add_template(self._handle, _data_pointer(image), len(image), ctypes.byref(template_id))
+		return (status, template_id.value)
+
+	def append(self, image: bytes, uuid: Optional[Union[bytes, str]] = None,
+			   template: Optional[int] = None) -> Tuple[int, int]:
+		"""
+		Append a board image.
+
+		Args:
+			image: Image bytes
+			uuid: Key for find(); defaults to the vendor atom UUID
+			template: Template record ID to store the image as a delta against
+
+		Returns:
+			tuple: (status, record ID)
+		"""
+		# Bound to a local so the bytes outlive the call; the pointer does not keep them alive
+		key_bytes = _uuid_bytes(uuid) if uuid is not None else None
+		key = _data_pointer(key_bytes) if key_bytes is not None else None
+		record_id = ctypes.c_uint32(HAT_PACK_NO_RECORD)
+		status = pack_lib.hat_pack_append(self._handle, _data_pointer(image), len(image), key,
+										  HAT_PACK_NO_RECORD if template is None else template,
+										  ctypes.byref(record_id))
+		return (status, record_id.value)
+
+	def find(self, uuid: Union[bytes, str]) -> Optional[int]:
+		"""Latest record stored under uuid (bytes or hex string), or None."""
+		key_bytes = _uuid_bytes(uuid)
+		record_id = ctypes.c_uint32()
+		status = pack_lib.hat_pack_find(self._handle, _data_pointer(key_bytes), ctypes.byref(record_id))
+		return record_id.value if status == PARSE_OK else None
+
+	def read(self, record_id: int) -> Tuple[int, bytes]:
+		"""Reconstruct a record's image. Returns (status, image bytes)."""
+		image_size = ctypes.c_uint32()
+		status = pack_lib.hat_pack_read(self._handle, record_id, None, 0, ctypes.byref(image_size))
+		if status != PARSE_ERROR_BUFFER_TOO_SMALL:
+			return (status, b'')
+
+		out = (ctypes.c_uint8 * image_size.value)()
+		status = pack_lib.hat_pack_read(self._handle, record_id, out, len(out), ctypes.byref(image_size))
+		return (status, bytes(out) if status == PARSE_OK else b'')
+
+	def info(self, record_id: int) -> Optional[dict]:
+		"""Describe one record (see info_to_dict), or None if it does not exist."""
+		info = HatPackRecordInfo()
+		if pack_lib.hat_pack_get_info(self._handle, record_id, ctypes.byref(info)) != PARSE_OK:
+			return None
+		return info_to_dict(info)
+
+	def records(self) -> Iterator[dict]:
+		"""Describe every record in append order."""
+		for record_id in range(len(self)):
+			yield self.info(record_id)
+
+	def scan(self, first_record: int = 0, max_rows: Optional[int] = None,
+			 arena_size: int = DEFAULT_BATCH_ARENA_SIZE) -> List[dict]:
+		"""Summarize records like scan_files, adding 'record_id' and 'kind' to each dict."""
+		count = max(len(self) - first_record, 0)
+		if max_rows is not None:
+			count = min(count, max_rows)
+
+		rows = (ArchiveRow * count)()
+		num_rows = ctypes.c_uint32()
+		arena = ctypes.create_string_buffer(arena_size)
+		arena_used = ctypes.c_uint32()
+
+		while True:
+			status = pack_lib.hat_pack_scan(self._handle, first_record, rows, count, ctypes.byref(num_rows),
+											arena, len(arena), ctypes.byref(arena_used))
+			grown = _grow_arena(arena, arena_used.value) if status == PARSE_ERROR_BUFFER_TOO_SMALL else None
+			if grown is None:
+				break
+			arena = grown
+
+		results = []
+		for row in rows[:num_rows.value]:
+			summary = row_to_dict(row, arena)
+			summary['record_id'] = row.source
+			summary['kind'] = self.info(row.source)['kind']
+			results.append(summary)
+		return results
+
+
+if __name__ == '__main__':
+	import sys
+
+	if len(sys.argv) < 2:
+		print("Usage: python -m rpihatparser.rpi_hat_pack_wrapper <pack file>")
+		sys.exit(1)
+
+	with HatPack(sys.argv[1]) as pack:
+		for summary in pack.scan():
+			print(f"#{summary['record_id']} {summary['kind']}: uuid {summary['uuid']}, "
+				  f"{summary['vendor']} / {summary['product']}, CRC {'OK' if summary['crc_ok'] else 'MISMATCH'}")
@@ -1,17 +1,32 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "rpi_hat_parser.h"
+#include "thread_compat.h"
+#include "crc16_tables.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+// Custom data is ignored on boards from this vendor
+#define ADI_VENDOR_NAME "Analog Devices Inc."
+
+#define MIN_ATOM_SIZE      (ATOM_HEADER_SIZE + 2)   // Header and CRC with no data
+#define VENDOR_FIXED_SIZE  22                       // UUID + product ID/version + two string lengths
+
+#define LAYOUT_SIGNATURE_SIZE 512
+#define LAYOUT_MAX_RANGES     (1 + 2 * HAT_LAYOUT_MAX_ATOMS)
+
 static uint16_t read_le16(const uint8_t* data, uint32_t offset) {
 	return data[offset] | (data[offset + 1] << 8);
 }
 
 static uint32_t read_le32(const uint8_t* data, uint32_t offset) {
-	return data[offset] | 
-		   (data[offset + 1] << 8) | 
-		   (data[offset + 2] << 16) | 
-		   (data[offset + 3] << 24);
+	return (uint32_t)data[offset] |
+		   ((uint32_t)data[offset + 1] << 8) |
+		   ((uint32_t)data[offset + 2] << 16) |
+		   ((uint32_t)data[offset + 3] << 24);
 }
 
 static void safe_string_copy(char* dest, const uint8_t* src, uint32_t length, uint32_t max_length) {
@@ -20,102 +35,679 @@ static void safe_string_copy(char* dest, const uint8_t* src, uint32_t length, ui
 	dest[copy_len] = '\0';
 }
 
+static int parse_header(const uint8_t* eeprom_data, uint32_t data_size, RpiHatHeader* header) {
+	if (memcmp(eeprom_data, "R-Pi", 4) != 0) {
+		return PARSE_ERROR_INVALID_SIG;
+	}
+
+	memcpy(header->signature, eeprom_data, 4);
+	header->signature[4] = '\0';
+	header->version = eeprom_data[4];
+	if (header->version != EXPECTED_VERSION)
+		return PARSE_ERROR_UNSUPPORTED_VERSION;
+
+	header->reserved = eeprom_data[5];
+	header->numatoms = read_le16(eeprom_data, 6);
+	header->eeplen = read_le32(eeprom_data, 8);
+
+	// Every atom takes at least MIN_ATOM_SIZE bytes, so a count that cannot fit in eeplen is garbage
+	if (header->eeplen < FIRST_ATOM_OFFSET ||
+		header->numatoms > (header->eeplen - FIRST_ATOM_OFFSET) / MIN_ATOM_SIZE)
+		return PARSE_ERROR_INVALID_DATA;
+
+	if (header->eeplen > data_size)
+		return PARSE_ERROR_BUFFER_TOO_SMALL;
+
+	return PARSE_OK;
+}
+
+// Atom at curr_address must end within the first limit bytes (eeplen) and hold at least its CRC.
+// Written as subtractions from limit so no sum can wrap.
+static int read_atom_header(const uint8_t* eeprom_data, uint32_t limit, uint32_t curr_address, AtomHeader* atom_header) {
+	if (curr_address > limit || limit - curr_address < ATOM_HEADER_SIZE) {
+		return -1;
+	}
+
+	atom_header->atom_type = read_le16(eeprom_data, curr_address);
+	atom_header->atom_count = read_le16(eeprom_data, curr_address + 2);
+	atom_header->atom_dlen = read_le32(eeprom_data, curr_address + 4);
+
+	if (atom_header->atom_dlen < 2 || atom_header->atom_dlen > limit - curr_address - ATOM_HEADER_SIZE) {
+		return -1;
+	}
+
+	return 0;
+}
+
+// Fields decode_atom reads at fixed offsets must lie inside the atom data
+static int atom_fields_ok(const uint8_t* eeprom_data, const AtomHeader* atom_header, uint32_t data_start) {
+	if (atom_header->atom_type != ATOM_TYPE_VENDOR_INFO)
+		return 1;
+
+	uint32_t data_len = atom_header->atom_dlen - 2;
+	return data_len >= VENDOR_FIXED_SIZE &&
+		   (uint32_t)eeprom_data[data_start + 20] + eeprom_data[data_start + 21] <= data_len - VENDOR_FIXED_SIZE;
+}
+
+// Next atom of a fully buffered image: bounds and fixed fields, -1 if the chain is malformed
+static int walk_atom(const uint8_t* eeprom_data, uint32_t limit, uint32_t curr_address, AtomHeader* atom_header) {
+	if (read_atom_header(eeprom_data, limit, curr_address, atom_header) != 0 ||
+		!atom_fields_ok(eeprom_data, atom_header, curr_address + ATOM_HEADER_SIZE)) {
+		return -1;
+	}
+
+	return 0;
+}
+
+// The atom must have passed walk_atom. skip_custom: the vendor decoded so far is ADI_VENDOR_NAME (see vendor_skips_custom)
+static void decode_atom(const uint8_t* eeprom_data, const AtomHeader* atom_header, uint32_t data_start,
+						ParsedEeprom* result, int skip_custom) {
+	switch (atom_header->atom_type) {
+		case ATOM_TYPE_VENDOR_INFO: {
+			memcpy(result->vendor_info.uuid, &eeprom_data[data_start], 16);
+
+			result->vendor_info.product_id = read_le16(eeprom_data, data_start + 16);
+			result->vendor_info.product_version = read_le16(eeprom_data, data_start + 18);
+
+			uint8_t vendor_len = eeprom_data[data_start + 20];
+			uint8_t product_len = eeprom_data[data_start + 21];
+
+			uint32_t vendor_start = data_start + VENDOR_FIXED_SIZE;
+			safe_string_copy(result->vendor_info.vendor, 
+						   &eeprom_data[vendor_start], 
+						   vendor_len, 
+						   MAX_STRING_LENGTH);
+
+			uint32_t product_start = vendor_start + vendor_len;
+			safe_string_copy(result->vendor_info.product, 
+						   &eeprom_data[product_start], 
+						   product_len, 
+						   MAX_STRING_LENGTH);
+			
+			result->has_vendor_info = 1;
+			break;
+		}
+
+		case ATOM_TYPE_CUSTOM: {
+			if (skip_custom)
+				break;
+
+			result->has_custom_data = 1;
+			uint32_t custom_data_len = atom_header->atom_dlen - 2;
+
+			if (custom_data_len > MAX_CUSTOM_DATA_SIZE) {
+				custom_data_len = MAX_CUSTOM_DATA_SIZE;
+			}
+
+			result->custom_data.data_length = custom_data_len;
+			memcpy(result->custom_data.data, &eeprom_data[data_start], custom_data_len);
+
+			result->custom_data.is_json = (custom_data_len > 0 && 
+										 (result->custom_data.data[0] == '{' || 
+										  result->custom_data.data[0] == '['));
+			break;
+		}
+
+		case ATOM_TYPE_DT_OVERLAY: {
+			result->has_dt_overlay = 1;
+			uint32_t overlay_len = atom_header->atom_dlen - 2;
+			result->dt_overlay_length = overlay_len;
+
+			safe_string_copy(result->dt_overlay, 
+						   &eeprom_data[data_start], 
+						   overlay_len, 
+						   MAX_STRING_LENGTH);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+// Vendor string of length bytes, ending early at a NUL as decoded strings do
+static int vendor_name_is_adi(const uint8_t* vendor, uint32_t length) {
+	const uint32_t adi_len = sizeof(ADI_VENDOR_NAME) - 1;
+	return length >= adi_len && memcmp(vendor, ADI_VENDOR_NAME, adi_len) == 0 &&
+		   (length == adi_len || vendor[adi_len] == '\0');
+}
+
+static int vendor_skips_custom(const ParsedEeprom* result) {
+	return result->has_vendor_info &&
+		   vendor_name_is_adi((const uint8_t*)result->vendor_info.vendor, (uint32_t)strlen(result->vendor_info.vendor));
+}
+
+static int atom_crc_ok(const uint8_t* eeprom_data, const AtomHeader* atom_header, uint32_t data_start) {
+	if (atom_header->atom_dlen < 2)
+		return 0;
+
+	uint32_t data_len = atom_header->atom_dlen - 2;
+	uint16_t stored = read_le16(eeprom_data, data_start + data_len);
+	return crc16_update(CRC16_INIT, &eeprom_data[data_start], data_len) == stored;
+}
+
+static void record_atom_crc(ParseIntegrity* integrity, uint32_t atom_num, int crc_ok) {
+	if (crc_ok) {
+		if (atom_num < MAX_INTEGRITY_ATOMS)
+			integrity->crc_ok_mask |= (uint64_t)1 << atom_num;
+	} else {
+		if (integrity->atoms_failed == 0)
+			integrity->first_failed_atom = atom_num;
+		integrity->atoms_failed++;
+	}
+	integrity->atoms_checked++;
+}
+
+typedef struct {
+	AtomHeader header;
+	uint32_t data_start;
+	int skip_custom;        // Custom atoms: decided once from the sample's vendor string
+} LayoutAtom;
+
+// Bytes an image must match, compared in place
+typedef struct {
+	uint32_t offset;
+	uint32_t length;
+} LayoutRange;
+
+typedef struct {
+	RpiHatHeader header;
+	uint32_t min_size;      // Image size the generic walk needs: eeplen and the end of the last atom
+	uint32_t num_atoms;
+	LayoutAtom atoms[HAT_LAYOUT_MAX_ATOMS];
+	uint32_t num_ranges;
+	LayoutRange ranges[LAYOUT_MAX_RANGES];
+	uint32_t signature_size;
+	uint8_t signature[LAYOUT_SIGNATURE_SIZE];   // Expected bytes of every range, back to back
+} HatLayout;
+
+static HatLayout layouts[HAT_LAYOUT_MAX];
+static uint32_t num_layouts;
+
+static int layout_add_range(HatLayout* layout, const uint8_t* sample, uint32_t offset, uint32_t length) {
+	if (layout->num_ranges == LAYOUT_MAX_RANGES || layout->signature_size + length > LAYOUT_SIGNATURE_SIZE)
+		return -1;
+
+	layout->ranges[layout->num_ranges].offset = offset;
+	layout->ranges[layout->num_ranges].length = length;
+	layout->num_ranges++;
+	memcpy(&layout->signature[layout->signature_size], &sample[offset], length);
+	layout->signature_size += length;
+	return 0;
+}
+
+static const HatLayout* match_layout(const uint8_t* eeprom_data, uint32_t data_size) {
+	for (uint32_t i = 0; i < num_layouts; i++) {
+		const HatLayout* layout = &layouts[i];
+		if (data_size < layout->min_size)
+			continue;
+
+		const uint8_t* expected = layout->signature;
+		uint32_t r = 0;
+		for (; r < layout->num_ranges; r++) {
+			const LayoutRange* range = &layout->ranges[r];
+			if (memcmp(&eeprom_data[range->offset], expected, range->length) != 0)
+				break;
+			expected += range->length;
+		}
+
+		if (r == layout->num_ranges)
+			return layout;
+	}
+
+	return NULL;
+}
+
+int hat_layout_register(const uint8_t* sample, uint32_t size, uint32_t* layout_id) {
+	if (sample == NULL || layout_id == NULL || size < FIRST_ATOM_OFFSET) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	HatLayout layout;
+	ParsedEeprom decoded;
+	memset(&layout, 0, sizeof(layout));
+	memset(&decoded, 0, sizeof(decoded));
+
+	int ret = parse_header(sample, size, &layout.header);
+	if (ret != PARSE_OK)
+		return ret;
+
+	if (layout.header.numatoms > HAT_LAYOUT_MAX_ATOMS || layout_add_range(&layout, sample, 0, FIRST_ATOM_OFFSET) != 0)
+		return PARSE_ERROR_INVALID_DATA;
+
+	uint32_t curr_address = FIRST_ATOM_OFFSET;
+
+	// Decode the sample the way parse_rpi_hat_eeprom_ex does, to fix the custom-data rule per atom
+	for (uint16_t atom_num = 0; atom_num < layout.header.numatoms; atom_num++) {
+		LayoutAtom* atom = &layout.atoms[atom_num];
+
+		// Only a complete chain has a fixed layout
+		if (walk_atom(sample, layout.header.eeplen, curr_address, &atom->header) != 0 ||
+			layout_add_range(&layout, sample, curr_address, ATOM_HEADER_SIZE) != 0)
+			return PARSE_ERROR_INVALID_DATA;
+
+		atom->data_start = curr_address + ATOM_HEADER_SIZE;
+		atom->skip_custom = vendor_skips_custom(&decoded);
+
+		// Vendor and product lengths and the vendor string are part of the signature
+		if (atom->header.atom_type == ATOM_TYPE_VENDOR_INFO &&
+			layout_add_range(&layout, sample, atom->data_start + 20, 2 + sample[atom->data_start + 20]) != 0)
+			return PARSE_ERROR_INVALID_DATA;
+
+		decode_atom(sample, &atom->header, atom->data_start, &decoded, atom->skip_custom);
+		curr_address += ATOM_HEADER_SIZE + atom->header.atom_dlen;
+	}
+
+	// walk_atom keeps the chain within eeplen
+	layout.num_atoms = layout.header.numatoms;
+	layout.min_size = layout.header.eeplen;
+
+	for (uint32_t i = 0; i < num_layouts; i++) {
+		if (layouts[i].min_size == layout.min_size && layouts[i].num_ranges == layout.num_ranges &&
+			layouts[i].signature_size == layout.signature_size &&
+			memcmp(layouts[i].signature, layout.signature, layout.signature_size) == 0) {
+			*layout_id = i;
+			return PARSE_OK;
+		}
+	}
+
+	if (num_layouts == HAT_LAYOUT_MAX)
+		return PARSE_ERROR_BUFFER_TOO_SMALL;
+
+	layouts[num_layouts] = layout;
+	*layout_id = num_layouts++;
+	return PARSE_OK;
+}
+
+void hat_layout_clear(void) {
+	num_layouts = 0;
+}
+
+int hat_layout_identify(const uint8_t* eeprom_data, uint32_t data_size, uint32_t* layout_id) {
+	if (eeprom_data == NULL || layout_id == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	const HatLayout* layout = match_layout(eeprom_data, data_size);
+	if (layout == NULL)
+		return PARSE_ERROR_NOT_FOUND;
+
+	*layout_id = (uint32_t)(layout - layouts);
+	return PARSE_OK;
+}
+
+// Signature matched: every offset is known, so decode without reading any atom header
+static int parse_known_layout(const HatLayout* layout, const uint8_t* eeprom_data, uint32_t flags,
+							  ParsedEeprom* result, ParseIntegrity* integrity) {
+	result->header = layout->header;
+
+	for (uint32_t atom_num = 0; atom_num < layout->num_atoms; atom_num++) {
+		const LayoutAtom* atom = &layout->atoms[atom_num];
+
+		if (flags & PARSE_FLAG_VERIFY_CRC)
+			record_atom_crc(integrity, atom_num, atom_crc_ok(eeprom_data, &atom->header, atom->data_start));
+
+		decode_atom(eeprom_data, &atom->header, atom->data_start, result, atom->skip_custom);
+	}
+
+	return (integrity->atoms_failed > 0) ? PARSE_ERROR_CRC_MISMATCH : PARSE_OK;
+}
+
 int parse_rpi_hat_eeprom(const uint8_t* eeprom_data, uint32_t data_size, ParsedEeprom* result) {
+	return parse_rpi_hat_eeprom_ex(eeprom_data, data_size, 0, result, NULL);
+}
+
+int parse_rpi_hat_eeprom_ex(const uint8_t* eeprom_data, uint32_t data_size, uint32_t flags,
+							ParsedEeprom* result, ParseIntegrity* integrity) {
+	ParseIntegrity local_integrity;
+	if (integrity == NULL)
+		integrity = &local_integrity;
+
+	memset(integrity, 0, sizeof(ParseIntegrity));
+
 	if (eeprom_data == NULL || result == NULL || data_size < 12) {
 		return PARSE_ERROR_INVALID_DATA;
 	}
 
 	memset(result, 0, sizeof(ParsedEeprom));
 
-	if (memcmp(eeprom_data, "R-Pi", 4) != 0) {
-		return PARSE_ERROR_INVALID_SIG;
+	if (num_layouts > 0 && !(flags & PARSE_FLAG_GENERIC)) {
+		const HatLayout* layout = match_layout(eeprom_data, data_size);
+		if (layout != NULL)
+			return parse_known_layout(layout, eeprom_data, flags, result, integrity);
 	}
 
-	memcpy(result->header.signature, eeprom_data, 4);
-	result->header.signature[4] = '\0';
-	result->header.version = eeprom_data[4];
-	if (result->header.version != EXPECTED_VERSION)
-		return PARSE_ERROR_UNSUPPORTED_VERSION;
+	int ret = parse_header(eeprom_data, data_size, &result->header);
+	if (ret != PARSE_OK)
+		return ret;
 
-	result->header.reserved = eeprom_data[5];
-	result->header.numatoms = read_le16(eeprom_data, 6);
-	result->header.eeplen = read_le32(eeprom_data, 8);
+	uint32_t curr_address = FIRST_ATOM_OFFSET;
+	int skip_custom = 0;
 
-	if (result->header.eeplen > data_size)
-		return PARSE_ERROR_BUFFER_TOO_SMALL;
+	for (uint16_t atom_num = 0; atom_num < result->header.numatoms; atom_num++) {
+		AtomHeader atom_header;
+		if (walk_atom(eeprom_data, result->header.eeplen, curr_address, &atom_header) != 0) {
+			return PARSE_ERROR_INVALID_DATA;
+		}
+
+		if (flags & PARSE_FLAG_VERIFY_CRC)
+			record_atom_crc(integrity, atom_num, atom_crc_ok(eeprom_data, &atom_header, curr_address + ATOM_HEADER_SIZE));
+
+		decode_atom(eeprom_data, &atom_header, curr_address + ATOM_HEADER_SIZE, result, skip_custom);
+		if (atom_header.atom_type == ATOM_TYPE_VENDOR_INFO)
+			skip_custom = vendor_skips_custom(result);
+
+		curr_address += ATOM_HEADER_SIZE + atom_header.atom_dlen;
+	}
+
+	return (integrity->atoms_failed > 0) ? PARSE_ERROR_CRC_MISMATCH : PARSE_OK;
+}
+
+int index_rpi_hat_eeprom(const uint8_t* eeprom_data, uint32_t data_size, RpiHatHeader* header,
+						 AtomView* atoms, uint32_t max_atoms, uint32_t* num_atoms) {
+	if (eeprom_data == NULL || num_atoms == NULL || data_size < 12 || (atoms == NULL && max_atoms > 0)) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	*num_atoms = 0;
+
+	RpiHatHeader local_header;
+	if (header == NULL)
+		header = &local_header;
+
+	memset(header, 0, sizeof(RpiHatHeader));
+
+	int ret = parse_header(eeprom_data, data_size, header);
+	if (ret != PARSE_OK)
+		return ret;
 
 	uint32_t curr_address = FIRST_ATOM_OFFSET;
+	uint32_t found = 0;
 
-	for (uint16_t atom_num = 0; atom_num < result->header.numatoms; atom_num++) {
-		if (curr_address + ATOM_HEADER_SIZE > data_size) {
-			break;
+	for (uint16_t atom_num = 0; atom_num < header->numatoms; atom_num++) {
+		AtomHeader atom_header;
+		if (walk_atom(eeprom_data, header->eeplen, curr_address, &atom_header) != 0) {
+			*num_atoms = found;
+			return PARSE_ERROR_INVALID_DATA;
+		}
+
+		if (found < max_atoms) {
+			atoms[found].type = atom_header.atom_type;
+			atoms[found].count = atom_header.atom_count;
+			atoms[found].offset = curr_address + ATOM_HEADER_SIZE;
+			atoms[found].dlen = atom_header.atom_dlen;
 		}
+		found++;
+
+		curr_address += ATOM_HEADER_SIZE + atom_header.atom_dlen;
+	}
 
+	*num_atoms = found;
+	return PARSE_OK;
+}
+
+const AtomView* find_atom_view(const AtomView* atoms, uint32_t num_atoms, uint16_t atom_type) {
+	if (atoms == NULL)
+		return NULL;
+
+	for (uint32_t i = 0; i < num_atoms; i++) {
+		if (atoms[i].type == atom_type)
+			return &atoms[i];
+	}
+
+	return NULL;
+}
+
+#define LAST_CUSTOM_ATOM UINT32_MAX
+
+// Untrimmed payload of custom atom index (LAST_CUSTOM_ATOM = the one parse_rpi_hat_eeprom keeps)
+static int find_custom_atom(const uint8_t* eeprom_data, uint32_t data_size, uint32_t index, ByteView* view) {
+	view->data = NULL;
+	view->length = 0;
+
+	RpiHatHeader header;
+	int ret = parse_header(eeprom_data, data_size, &header);
+	if (ret != PARSE_OK)
+		return ret;
+
+	uint32_t curr_address = FIRST_ATOM_OFFSET;
+	uint32_t found = 0;
+
+	for (uint16_t atom_num = 0; atom_num < header.numatoms; atom_num++) {
 		AtomHeader atom_header;
-		atom_header.atom_type = read_le16(eeprom_data, curr_address);
-		atom_header.atom_count = read_le16(eeprom_data, curr_address + 2);
-		atom_header.atom_dlen = read_le32(eeprom_data, curr_address + 4);
+		if (walk_atom(eeprom_data, header.eeplen, curr_address, &atom_header) != 0) {
+			return PARSE_ERROR_INVALID_DATA;
+		}
 
-		uint32_t data_start = curr_address + ATOM_HEADER_SIZE;
+		if (atom_header.atom_type == ATOM_TYPE_CUSTOM) {
+			view->data = &eeprom_data[curr_address + ATOM_HEADER_SIZE];
+			view->length = atom_header.atom_dlen - 2;
+			if (found++ == index)
+				return PARSE_OK;
+		}
+
+		curr_address += ATOM_HEADER_SIZE + atom_header.atom_dlen;
+	}
+
+	if (index == LAST_CUSTOM_ATOM && found > 0)
+		return PARSE_OK;
+
+	view->data = NULL;
+	view->length = 0;
+	return PARSE_ERROR_NOT_FOUND;
+}
+
+static uint32_t trimmed_length(const uint8_t* data, uint32_t length) {
+	while (length > 0 && data[length - 1] == '\0')
+		length--;
+	return length;
+}
+
+int get_custom_atom_view(const uint8_t* eeprom_data, uint32_t data_size, uint32_t index, ByteView* view) {
+	if (eeprom_data == NULL || view == NULL || data_size < 12) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	int ret = find_custom_atom(eeprom_data, data_size, index, view);
+	if (ret == PARSE_OK)
+		view->length = trimmed_length(view->data, view->length);
+
+	return ret;
+}
+
+static uint32_t json_skip_ws(const uint8_t* json, uint32_t length, uint32_t pos) {
+	while (pos < length && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' || json[pos] == '\r'))
+		pos++;
+	return pos;
+}
+
+// Returns the position just past the string starting at pos (which must be '"'), or 0 if unterminated
+static uint32_t json_skip_string(const uint8_t* json, uint32_t length, uint32_t pos) {
+	for (pos++; pos < length; pos++) {
+		if (json[pos] == '\\')
+			pos++;
+		else if (json[pos] == '"')
+			return pos + 1;
+	}
+	return 0;
+}
+
+// Returns the position just past the value starting at pos, or 0 if malformed
+static uint32_t json_skip_value(const uint8_t* json, uint32_t length, uint32_t pos) {
+	if (pos >= length)
+		return 0;
+
+	if (json[pos] == '"')
+		return json_skip_string(json, length, pos);
+
+	if (json[pos] == '{' || json[pos] == '[') {
+		uint32_t depth = 0;
+		while (pos < length) {
+			uint8_t c = json[pos];
+			if (c == '"') {
+				pos = json_skip_string(json, length, pos);
+				if (pos == 0)
+					return 0;
+				continue;
+			}
+			if (c == '{' || c == '[')
+				depth++;
+			else if ((c == '}' || c == ']') && --depth == 0)
+				return pos + 1;
+			pos++;
+		}
+		return 0;
+	}
+
+	// Number, true, false or null
+	uint32_t start = pos;
+	while (pos < length && json[pos] != ',' && json[pos] != '}' && json[pos] != ']' &&
+		   json[pos] != ' ' && json[pos] != '\t' && json[pos] != '\n' && json[pos] != '\r')
+		pos++;
+	return (pos > start) ? pos : 0;
+}
+
+int json_find_value(const uint8_t* json, uint32_t length, const char* key, ByteView* value) {
+	if (json == NULL || key == NULL || value == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	value->data = NULL;
+	value->length = 0;
+
+	size_t key_len = strlen(key);
+	uint32_t pos = json_skip_ws(json, length, 0);
+	if (pos >= length || json[pos] != '{')
+		return PARSE_ERROR_INVALID_DATA;
+
+	pos = json_skip_ws(json, length, pos + 1);
+	if (pos < length && json[pos] == '}')
+		return PARSE_ERROR_NOT_FOUND;
+
+	while (pos < length) {
+		if (json[pos] != '"')
+			return PARSE_ERROR_INVALID_DATA;
+
+		uint32_t key_start = pos + 1;
+		pos = json_skip_string(json, length, pos);
+		if (pos == 0)
+			return PARSE_ERROR_INVALID_DATA;
+		uint32_t key_end = pos - 1;
 
-		if (data_start + atom_header.atom_dlen > data_size) {
+		pos = json_skip_ws(json, length, pos);
+		if (pos >= length || json[pos] != ':')
+			return PARSE_ERROR_INVALID_DATA;
+
+		uint32_t value_start = json_skip_ws(json, length, pos + 1);
+		uint32_t value_end = json_skip_value(json, length, value_start);
+		if (value_end == 0)
+			return PARSE_ERROR_INVALID_DATA;
+
+		if (key_end - key_start == key_len && memcmp(&json[key_start], key, key_len) == 0) {
+			value->data = &json[value_start];
+			value->length = value_end - value_start;
+			return PARSE_OK;
+		}
+
+		pos = json_skip_ws(json, length, value_end);
+		if (pos >= length)
 			break;
+		if (json[pos] == '}')
+			return PARSE_ERROR_NOT_FOUND;
+		if (json[pos] != ',')
+			return PARSE_ERROR_INVALID_DATA;
+		pos = json_skip_ws(json, length, pos + 1);
+	}
+
+	return PARSE_ERROR_INVALID_DATA;
+}
+
+typedef struct {
+	char* base;
+	uint32_t size;
+	uint32_t used;      // Bytes needed so far, may exceed size
+	uint32_t origin;    // Offset of base within the caller's arena
+} StringArena;
+
+static uint32_t arena_add_string(StringArena* arena, const uint8_t* src, uint32_t length) {
+	uint32_t copy_len = (length < MAX_STRING_LENGTH - 1) ? length : MAX_STRING_LENGTH - 1;
+	const uint8_t* nul = (const uint8_t*)memchr(src, '\0', copy_len);
+	if (nul != NULL)
+		copy_len = (uint32_t)(nul - src);
+
+	// Saturates instead of wrapping, so a huge batch still reports that it did not fit
+	uint32_t offset = arena->used;
+	arena->used = (copy_len + 1 > ARENA_SIZE_OVERFLOW - offset) ? ARENA_SIZE_OVERFLOW : offset + copy_len + 1;
+
+	if (arena->base == NULL || arena->used > arena->size)
+		return ARENA_OFFSET_NONE;
+
+	memcpy(arena->base + offset, src, copy_len);
+	arena->base[offset + copy_len] = '\0';
+	return arena->origin + offset;
+}
+
+static void summarize_eeprom(const uint8_t* eeprom_data, uint32_t data_size, EepromSummary* summary, StringArena* arena) {
+	memset(summary, 0, sizeof(EepromSummary));
+	summary->vendor_offset = ARENA_OFFSET_NONE;
+	summary->product_offset = ARENA_OFFSET_NONE;
+	summary->dt_overlay_offset = ARENA_OFFSET_NONE;
+
+	if (eeprom_data == NULL || data_size < 12) {
+		summary->status = PARSE_ERROR_INVALID_DATA;
+		return;
+	}
+
+	summary->status = parse_header(eeprom_data, data_size, &summary->header);
+	if (summary->status != PARSE_OK)
+		return;
+
+	// Same rule as decode_atom: custom data is ignored on Analog Devices boards
+	int skip_custom = 0;
+	uint32_t curr_address = FIRST_ATOM_OFFSET;
+
+	for (uint16_t atom_num = 0; atom_num < summary->header.numatoms; atom_num++) {
+		AtomHeader atom_header;
+		if (walk_atom(eeprom_data, summary->header.eeplen, curr_address, &atom_header) != 0) {
+			summary->status = PARSE_ERROR_INVALID_DATA;
+			return;
 		}
 
+		uint32_t data_start = curr_address + ATOM_HEADER_SIZE;
+
 		switch (atom_header.atom_type) {
 			case ATOM_TYPE_VENDOR_INFO: {
-				memcpy(result->vendor_info.uuid, &eeprom_data[data_start], 16);
-
-				result->vendor_info.product_id = read_le16(eeprom_data, data_start + 16);
-				result->vendor_info.product_version = read_le16(eeprom_data, data_start + 18);
+				memcpy(summary->uuid, &eeprom_data[data_start], 16);
+				summary->product_id = read_le16(eeprom_data, data_start + 16);
+				summary->product_version = read_le16(eeprom_data, data_start + 18);
 
 				uint8_t vendor_len = eeprom_data[data_start + 20];
 				uint8_t product_len = eeprom_data[data_start + 21];
+				const uint8_t* vendor = &eeprom_data[data_start + VENDOR_FIXED_SIZE];
 
-				uint32_t vendor_start = data_start + 22;
-				safe_string_copy(result->vendor_info.vendor, 
-							   &eeprom_data[vendor_start], 
-							   vendor_len, 
-							   MAX_STRING_LENGTH);
-
-				uint32_t product_start = vendor_start + vendor_len;
-				safe_string_copy(result->vendor_info.product, 
-							   &eeprom_data[product_start], 
-							   product_len, 
-							   MAX_STRING_LENGTH);
-				
-				result->has_vendor_info = 1;
+				summary->vendor_offset = arena_add_string(arena, vendor, vendor_len);
+				summary->product_offset = arena_add_string(arena, vendor + vendor_len, product_len);
+
+				skip_custom = vendor_name_is_adi(vendor, vendor_len);
+				summary->has_vendor_info = 1;
 				break;
 			}
 
 			case ATOM_TYPE_CUSTOM: {
-				if (strcmp(result->vendor_info.vendor, "Analog Devices Inc.") == 0)
+				if (skip_custom)
 					break;
 
-				result->has_custom_data = 1;
-				uint32_t custom_data_len = atom_header.atom_dlen - 2;
-
-				if (custom_data_len > MAX_CUSTOM_DATA_SIZE) {
-					custom_data_len = MAX_CUSTOM_DATA_SIZE;
-				}
-
-				result->custom_data.data_length = custom_data_len;
-				memcpy(result->custom_data.data, &eeprom_data[data_start], custom_data_len);
-
-				result->custom_data.is_json = (custom_data_len > 0 && 
-											 (result->custom_data.data[0] == '{' || 
-											  result->custom_data.data[0] == '['));
+				summary->has_custom_data = 1;
+				summary->custom_data_offset = data_start;
+				summary->custom_data_length = atom_header.atom_dlen - 2;
+				summary->custom_is_json = (summary->custom_data_length > 0 &&
+										   (eeprom_data[data_start] == '{' || eeprom_data[data_start] == '['));
 				break;
 			}
 
 			case ATOM_TYPE_DT_OVERLAY: {
-				result->has_dt_overlay = 1;
-				uint32_t overlay_len = atom_header.atom_dlen - 2;
-
-				safe_string_copy(result->dt_overlay, 
-							   &eeprom_data[data_start], 
-							   overlay_len, 
-							   MAX_STRING_LENGTH);
+				summary->has_dt_overlay = 1;
+				summary->dt_overlay_offset = arena_add_string(arena, &eeprom_data[data_start], atom_header.atom_dlen - 2);
 				break;
 			}
 
@@ -125,10 +717,232 @@ int parse_rpi_hat_eeprom(const uint8_t* eeprom_data, uint32_t data_size, ParsedE
 
 		curr_address += ATOM_HEADER_SIZE + atom_header.atom_dlen;
 	}
+}
+
+int parse_rpi_hat_eeprom_batch(const EepromImage* images, uint32_t count, EepromSummary* results,
+							   char* arena, uint32_t arena_size, uint32_t* arena_used) {
+	if ((images == NULL || results == NULL) && count > 0) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	StringArena strings = { arena, arena_size, 0, 0 };
+
+	for (uint32_t i = 0; i < count; i++) {
+		summarize_eeprom(images[i].data, images[i].size, &results[i], &strings);
+	}
+
+	if (arena_used)
+		*arena_used = strings.used;
+
+	return (strings.used > arena_size) ? PARSE_ERROR_BUFFER_TOO_SMALL : PARSE_OK;
+}
+
+typedef struct {
+	const EepromImage* images;
+	EepromSummary* results;
+	uint32_t count;
+	StringArena strings;
+} BatchSlice;
+
+static void batch_worker(void* arg) {
+	BatchSlice* slice = (BatchSlice*)arg;
+
+	for (uint32_t i = 0; i < slice->count; i++) {
+		summarize_eeprom(slice->images[i].data, slice->images[i].size, &slice->results[i], &slice->strings);
+	}
+}
+
+int parse_rpi_hat_eeprom_batch_mt(const EepromImage* images, uint32_t count, EepromSummary* results,
+								  char* arena, uint32_t arena_size, uint32_t* arena_used, uint32_t num_threads) {
+	if ((images == NULL || results == NULL) && count > 0) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (num_threads == 0)
+		num_threads = thread_cpu_count();
+	if (num_threads > BATCH_MAX_THREADS)
+		num_threads = BATCH_MAX_THREADS;
+	if (num_threads > count)
+		num_threads = count;
+
+	if (num_threads <= 1)
+		return parse_rpi_hat_eeprom_batch(images, count, results, arena, arena_size, arena_used);
+
+	// Each worker owns a contiguous run of images and an equal slice of the arena
+	BatchSlice slices[BATCH_MAX_THREADS];
+	thread_t threads[BATCH_MAX_THREADS];
+	uint32_t slice_size = arena_size / num_threads;
+	uint32_t per_thread = count / num_threads;
+	uint32_t extra = count % num_threads;
+	uint32_t first = 0;
+	uint32_t started = 0;
+
+	for (uint32_t t = 0; t < num_threads; t++) {
+		slices[t].images = &images[first];
+		slices[t].results = &results[first];
+		slices[t].count = per_thread + (t < extra ? 1 : 0);
+		slices[t].strings.base = arena ? arena + (size_t)t * slice_size : NULL;
+		slices[t].strings.size = slice_size;
+		slices[t].strings.used = 0;
+		slices[t].strings.origin = t * slice_size;
+		first += slices[t].count;
+
+		// Slice 0 runs on the calling thread; so does any slice whose thread fails to start
+		if (t > 0 && thread_start(&threads[t], batch_worker, &slices[t]) == 0)
+			started |= 1u << t;
+	}
+
+	batch_worker(&slices[0]);
+
+	for (uint32_t t = 1; t < num_threads; t++) {
+		if (started & (1u << t))
+			thread_join(&threads[t]);
+		else
+			batch_worker(&slices[t]);
+	}
+
+	// Report the arena size at which the fullest slice would fit
+	uint32_t max_used = 0;
+	for (uint32_t t = 0; t < num_threads; t++) {
+		if (slices[t].strings.used > max_used)
+			max_used = slices[t].strings.used;
+	}
+
+	if (arena_used) {
+		uint64_t needed = (uint64_t)max_used * num_threads;
+		*arena_used = (needed > ARENA_SIZE_OVERFLOW) ? ARENA_SIZE_OVERFLOW : (uint32_t)needed;
+	}
+
+	return (max_used > slice_size) ? PARSE_ERROR_BUFFER_TOO_SMALL : PARSE_OK;
+}
+
+int stream_parser_init(StreamParser* ctx, uint8_t* buffer, uint32_t capacity, uint32_t want_mask, ParsedEeprom* result) {
+	return stream_parser_init_ex(ctx, buffer, capacity, want_mask, 0, result);
+}
+
+int stream_parser_init_ex(StreamParser* ctx, uint8_t* buffer, uint32_t capacity, uint32_t want_mask,
+						  uint32_t flags, ParsedEeprom* result) {
+	if (ctx == NULL || buffer == NULL || result == NULL || capacity < 12) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	memset(ctx, 0, sizeof(StreamParser));
+	memset(result, 0, sizeof(ParsedEeprom));
+
+	ctx->buffer = buffer;
+	ctx->capacity = capacity;
+	ctx->want_mask = want_mask;
+	ctx->flags = flags;
+	ctx->next_atom = FIRST_ATOM_OFFSET;
+	ctx->status = STREAM_NEED_MORE;
+	ctx->result = result;
 
 	return PARSE_OK;
 }
 
+static int stream_parser_advance(StreamParser* ctx) {
+	if (!ctx->header_done) {
+		if (ctx->length >= 4 && memcmp(ctx->buffer, "R-Pi", 4) != 0)
+			return PARSE_ERROR_INVALID_SIG;
+
+		if (ctx->length >= 5 && ctx->buffer[4] != EXPECTED_VERSION)
+			return PARSE_ERROR_UNSUPPORTED_VERSION;
+
+		if (ctx->length < FIRST_ATOM_OFFSET)
+			return STREAM_NEED_MORE;
+
+		int ret = parse_header(ctx->buffer, ctx->capacity, &ctx->result->header);
+		if (ret != PARSE_OK)
+			return ret;
+
+		ctx->header_done = 1;
+	}
+
+	uint32_t limit = ctx->result->header.eeplen;
+
+	while (ctx->atoms_done < ctx->result->header.numatoms) {
+		// Same bounds as parse_rpi_hat_eeprom: the chain must end within eeplen (at most capacity)
+		if (ctx->next_atom + ATOM_HEADER_SIZE > ctx->length) {
+			if (ctx->next_atom + ATOM_HEADER_SIZE > limit)
+				return PARSE_ERROR_INVALID_DATA;
+			return STREAM_NEED_MORE;
+		}
+
+		AtomHeader atom_header;
+		if (read_atom_header(ctx->buffer, limit, ctx->next_atom, &atom_header) != 0)
+			return PARSE_ERROR_INVALID_DATA;
+
+		uint32_t atom_end = ctx->next_atom + ATOM_HEADER_SIZE + atom_header.atom_dlen;
+		if (atom_end > ctx->length)
+			return STREAM_NEED_MORE;
+
+		if (!atom_fields_ok(ctx->buffer, &atom_header, ctx->next_atom + ATOM_HEADER_SIZE))
+			return PARSE_ERROR_INVALID_DATA;
+
+		if (ctx->flags & PARSE_FLAG_VERIFY_CRC)
+			record_atom_crc(&ctx->integrity, ctx->atoms_done,
+							atom_crc_ok(ctx->buffer, &atom_header, ctx->next_atom + ATOM_HEADER_SIZE));
+
+		decode_atom(ctx->buffer, &atom_header, ctx->next_atom + ATOM_HEADER_SIZE, ctx->result,
+					atom_header.atom_type == ATOM_TYPE_CUSTOM && vendor_skips_custom(ctx->result));
+
+		if (atom_header.atom_type < 32)
+			ctx->seen_mask |= 1u << atom_header.atom_type;
+		ctx->atoms_done++;
+		ctx->next_atom = atom_end;
+
+		if (ctx->want_mask != STREAM_WANT_ALL && (ctx->seen_mask & ctx->want_mask) == ctx->want_mask)
+			return STREAM_COMPLETE;
+	}
+
+	return STREAM_COMPLETE;
+}
+
+int stream_parser_feed(StreamParser* ctx, const uint8_t* chunk, uint32_t chunk_len) {
+	if (ctx == NULL || (chunk == NULL && chunk_len > 0)) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (ctx->status != STREAM_NEED_MORE)
+		return ctx->status;
+
+	uint32_t space = ctx->capacity - ctx->length;
+	uint32_t copy_len = (chunk_len < space) ? chunk_len : space;
+	memcpy(ctx->buffer + ctx->length, chunk, copy_len);
+	ctx->length += copy_len;
+
+	ctx->status = stream_parser_advance(ctx);
+	return ctx->status;
+}
+
+uint32_t stream_parser_bytes_needed(const StreamParser* ctx) {
+	if (ctx == NULL || ctx->status != STREAM_NEED_MORE)
+		return 0;
+
+	if (!ctx->header_done)
+		return FIRST_ATOM_OFFSET - ctx->length;
+
+	if (ctx->next_atom + ATOM_HEADER_SIZE > ctx->length)
+		return ctx->next_atom + ATOM_HEADER_SIZE - ctx->length;
+
+	uint32_t atom_dlen = read_le32(ctx->buffer, ctx->next_atom + 4);
+	return ctx->next_atom + ATOM_HEADER_SIZE + atom_dlen - ctx->length;
+}
+
+int stream_parser_finish(StreamParser* ctx) {
+	if (ctx == NULL) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	if (ctx->status < 0)
+		return ctx->status;
+
+	if (!ctx->header_done)
+		return PARSE_ERROR_INVALID_DATA;
+
+	return (ctx->integrity.atoms_failed > 0) ? PARSE_ERROR_CRC_MISMATCH : PARSE_OK;
+}
+
 int parse_and_print_eeprom(const uint8_t* eeprom_data, uint32_t data_size, OutputCallback callback) {
 	ParsedEeprom result;
 	int ret = parse_rpi_hat_eeprom(eeprom_data, data_size, &result);
@@ -188,22 +1002,15 @@ int parse_and_print_eeprom(const uint8_t* eeprom_data, uint32_t data_size, Outpu
 		if (callback) callback(buffer); else printf("%s\n", buffer);
 
 		if (result.custom_data.is_json) {
-			char* json_str = (char*)malloc(result.custom_data.data_length + 1);
-			if (json_str) {
-				memcpy(json_str, result.custom_data.data, result.custom_data.data_length);
-				json_str[result.custom_data.data_length] = '\0';
-				
-				int len = result.custom_data.data_length;
-				while (len > 0 && json_str[len - 1] == '\0') {
-					len--;
-				}
-				json_str[len] = '\0';
-				
-				snprintf(buffer, sizeof(buffer), "  JSON: %s", json_str);
-				if (callback) callback(buffer); else printf("%s\n", buffer);
-				
-				free(json_str);
+			// Sized for the whole custom data payload so large JSON is not truncated
+			char json_line[MAX_CUSTOM_DATA_SIZE + 16];
+			int len = (int)result.custom_data.data_length;
+			while (len > 0 && result.custom_data.data[len - 1] == '\0') {
+				len--;
 			}
+
+			snprintf(json_line, sizeof(json_line), "  JSON: %.*s", len, (const char*)result.custom_data.data);
+			if (callback) callback(json_line); else printf("%s\n", json_line);
 		} else {
 			snprintf(buffer, sizeof(buffer), "  Hex data (first 64 bytes):");
 			if (callback) callback(buffer); else printf("%s\n", buffer);
@@ -233,6 +1040,325 @@ int parse_and_print_eeprom(const uint8_t* eeprom_data, uint32_t data_size, Outpu
 	return PARSE_OK;
 }
 
+// Appends to a caller buffer and counts what did not fit, so one pass gives the needed size
+typedef struct {
+	char* out;
+	uint32_t size;
+	uint32_t used;
+} ReportWriter;
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static void report_put(ReportWriter* w, const char* text, uint32_t length) {
+	if (w->used < w->size) {
+		uint32_t room = w->size - w->used;
+		memcpy(w->out + w->used, text, (length < room) ? length : room);
+	}
+	w->used += length;
+}
+
+static void report_str(ReportWriter* w, const char* text) {
+	report_put(w, text, (uint32_t)strlen(text));
+}
+
+static void report_char(ReportWriter* w, char c) {
+	report_put(w, &c, 1);
+}
+
+static void report_uint(ReportWriter* w, uint32_t value) {
+	char digits[10];
+	uint32_t n = 0;
+	do {
+		digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	report_put(w, &digits[sizeof(digits) - n], n);
+}
+
+static void report_hex_byte(ReportWriter* w, uint8_t value) {
+	char hex[2] = { hex_digits[value >> 4], hex_digits[value & 0x0F] };
+	report_put(w, hex, 2);
+}
+
+// Hex digits of a byte run, appended in chunks
+static void report_hex_run(ReportWriter* w, const uint8_t* data, uint32_t length) {
+	char chunk[128];
+
+	for (uint32_t i = 0; i < length; i += sizeof(chunk) / 2) {
+		uint32_t count = (length - i < sizeof(chunk) / 2) ? length - i : (uint32_t)(sizeof(chunk) / 2);
+		for (uint32_t j = 0; j < count; j++) {
+			chunk[2 * j] = hex_digits[data[i + j] >> 4];
+			chunk[2 * j + 1] = hex_digits[data[i + j] & 0x0F];
+		}
+		report_put(w, chunk, 2 * count);
+	}
+}
+
+// Writes a JSON string literal, escaping quotes, backslashes, control bytes and bytes
+// 0x80 and above (the payload need not be UTF-8, so each byte maps to U+0000-U+00FF)
+static void report_json_string(ReportWriter* w, const char* text, uint32_t length) {
+	report_char(w, '"');
+
+	uint32_t run = 0;
+	for (uint32_t i = 0; i < length; i++) {
+		uint8_t c = (uint8_t)text[i];
+		if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\')
+			continue;
+
+		report_put(w, text + run, i - run);
+		run = i + 1;
+
+		if (c == '"' || c == '\\') {
+			char escaped[2] = { '\\', (char)c };
+			report_put(w, escaped, 2);
+		} else if (c == '\n') {
+			report_put(w, "\\n", 2);
+		} else {
+			report_put(w, "\\u00", 4);
+			report_hex_byte(w, c);
+		}
+	}
+
+	report_put(w, text + run, length - run);
+	report_char(w, '"');
+}
+
+// Whole payload, 16 bytes per line: offset, hex bytes, ASCII; each line is built locally and appended once
+static void report_hexdump(ReportWriter* w, const uint8_t* data, uint32_t length) {
+	char line[88];
+
+	for (uint32_t i = 0; i < length; i += 16) {
+		uint32_t count = (length - i < 16) ? length - i : 16;
+		char* p = line;
+
+		memset(p, ' ', 4);
+		p += 4;
+		*p++ = hex_digits[(i >> 12) & 0x0F];
+		*p++ = hex_digits[(i >> 8) & 0x0F];
+		*p++ = hex_digits[(i >> 4) & 0x0F];
+		*p++ = hex_digits[i & 0x0F];
+		*p++ = ' ';
+		*p++ = ' ';
+
+		for (uint32_t j = 0; j < 16; j++) {
+			if (j < count) {
+				*p++ = hex_digits[data[i + j] >> 4];
+				*p++ = hex_digits[data[i + j] & 0x0F];
+			} else {
+				*p++ = ' ';
+				*p++ = ' ';
+			}
+			*p++ = ' ';
+		}
+
+		*p++ = ' ';
+		*p++ = '|';
+		for (uint32_t j = 0; j < count; j++)
+			*p++ = (data[i + j] >= 0x20 && data[i + j] < 0x7F) ? (char)data[i + j] : '.';
+		*p++ = '|';
+		*p++ = '\n';
+
+		report_put(w, line, (uint32_t)(p - line));
+	}
+}
+
+// custom is the full payload from the image; result->custom_data stops at MAX_CUSTOM_DATA_SIZE
+static void report_text(ReportWriter* w, const ParsedEeprom* result, const ByteView* custom) {
+	report_str(w, "EEPROM Signature: ");
+	report_str(w, result->header.signature);
+	report_str(w, "\nValid Raspberry Pi HAT EEPROM detected!\n\nHeader Info:\n  Signature: ");
+	report_str(w, result->header.signature);
+	report_str(w, "\n  Version: 0x");
+	report_hex_byte(w, result->header.version);
+	report_str(w, "\n  Number of Atoms: ");
+	report_uint(w, result->header.numatoms);
+	report_str(w, "\n  EEPROM Length: ");
+	report_uint(w, result->header.eeplen);
+	report_str(w, " bytes\n");
+
+	if (result->has_vendor_info) {
+		report_str(w, "\nVendor Information:\n  Product ID: ");
+		report_uint(w, result->vendor_info.product_id);
+		report_str(w, "\n  Product Version: ");
+		report_uint(w, result->vendor_info.product_version);
+		report_str(w, "\n  Vendor: ");
+		report_str(w, result->vendor_info.vendor);
+		report_str(w, "\n  Board: ");
+		report_str(w, result->vendor_info.product);
+		report_char(w, '\n');
+	}
+
+	if (result->has_custom_data) {
+		report_str(w, "\nCustom Data (");
+		report_uint(w, custom->length);
+		report_str(w, " bytes):\n");
+
+		if (result->custom_data.is_json) {
+			report_str(w, "  JSON: ");
+			report_put(w, (const char*)custom->data, trimmed_length(custom->data, custom->length));
+			report_char(w, '\n');
+		} else {
+			report_str(w, "  Hex data:\n");
+			report_hexdump(w, custom->data, custom->length);
+		}
+	}
+
+	if (result->has_dt_overlay) {
+		report_str(w, "  Overlay: ");
+		report_str(w, result->dt_overlay);
+		report_char(w, '\n');
+	}
+}
+
+static void report_json(ReportWriter* w, const ParsedEeprom* result, const ByteView* custom) {
+	report_str(w, "{\"status\":0,\"header\":{\"signature\":");
+	report_json_string(w, result->header.signature, (uint32_t)strlen(result->header.signature));
+	report_str(w, ",\"version\":");
+	report_uint(w, result->header.version);
+	report_str(w, ",\"numatoms\":");
+	report_uint(w, result->header.numatoms);
+	report_str(w, ",\"eeplen\":");
+	report_uint(w, result->header.eeplen);
+	report_char(w, '}');
+
+	if (result->has_vendor_info) {
+		report_str(w, ",\"vendor_info\":{\"uuid\":\"");
+		report_hex_run(w, result->vendor_info.uuid, 16);
+		report_str(w, "\",\"product_id\":");
+		report_uint(w, result->vendor_info.product_id);
+		report_str(w, ",\"product_version\":");
+		report_uint(w, result->vendor_info.product_version);
+		report_str(w, ",\"vendor\":");
+		report_json_string(w, result->vendor_info.vendor, (uint32_t)strlen(result->vendor_info.vendor));
+		report_str(w, ",\"product\":");
+		report_json_string(w, result->vendor_info.product, (uint32_t)strlen(result->vendor_info.product));
+		report_char(w, '}');
+	}
+
+	if (result->has_custom_data) {
+		report_str(w, ",\"custom_data\":{\"length\":");
+		report_uint(w, custom->length);
+		if (result->custom_data.is_json) {
+			// Kept as a string: the payload is not validated as JSON
+			report_str(w, ",\"json\":");
+			report_json_string(w, (const char*)custom->data, trimmed_length(custom->data, custom->length));
+		} else {
+			report_str(w, ",\"hex\":\"");
+			report_hex_run(w, custom->data, custom->length);
+			report_char(w, '"');
+		}
+		report_char(w, '}');
+	}
+
+	if (result->has_dt_overlay) {
+		report_str(w, ",\"dt_overlay\":");
+		report_json_string(w, result->dt_overlay, (uint32_t)strlen(result->dt_overlay));
+	}
+
+	report_str(w, "}\n");
+}
+
+int format_rpi_hat_eeprom(const uint8_t* eeprom_data, uint32_t data_size, uint32_t report_format,
+						  char* out, uint32_t out_size, uint32_t* out_length, int* parse_status) {
+	if ((out == NULL && out_size > 0) || out_length == NULL ||
+		(report_format != REPORT_TEXT && report_format != REPORT_JSON)) {
+		return PARSE_ERROR_INVALID_DATA;
+	}
+
+	ReportWriter writer = { out, out_size, 0 };
+	ParsedEeprom result;
+	int ret = parse_rpi_hat_eeprom(eeprom_data, data_size, &result);
+
+	if (parse_status)
+		*parse_status = ret;
+
+	if (ret != PARSE_OK) {
+		const char* error_msg = get_parse_error_message(ret);
+		if (report_format == REPORT_JSON) {
+			report_str(&writer, "{\"status\":");
+			report_char(&writer, '-');
+			report_uint(&writer, (uint32_t)-ret);
+			report_str(&writer, ",\"error\":");
+			report_json_string(&writer, error_msg, (uint32_t)strlen(error_msg));
+			report_str(&writer, "}\n");
+		} else {
+			report_str(&writer, error_msg);
+			report_char(&writer, '\n');
+		}
+	} else {
+		ByteView custom = { result.custom_data.data, result.custom_data.data_length };
+		if (result.has_custom_data)
+			find_custom_atom(eeprom_data, data_size, LAST_CUSTOM_ATOM, &custom);
+
+		if (report_format == REPORT_JSON)
+			report_json(&writer, &result, &custom);
+		else
+			report_text(&writer, &result, &custom);
+	}
+
+	*out_length = writer.used;
+	if (out_size > 0)
+		out[(writer.used < out_size) ? writer.used : out_size - 1] = '\0';
+
+	return (writer.used < out_size) ? PARSE_OK : PARSE_ERROR_BUFFER_TOO_SMALL;
+}
+
+uint16_t crc16_update_bitwise(uint16_t crc, const uint8_t* data, uint32_t length) {
+	for (uint32_t i = 0; i < length; i++) {
+		crc ^= data[i];
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ CRC16_POLY_REFLECTED) : (uint16_t)(crc >> 1);
+	}
+
+	return crc;
+}
+
+uint16_t crc16_update_table(uint16_t crc, const uint8_t* data, uint32_t length) {
+	for (uint32_t i = 0; i < length; i++)
+		crc = (uint16_t)((crc >> 8) ^ crc16_lookup[0][(crc ^ data[i]) & 0xFF]);
+
+	return crc;
+}
+
+uint16_t crc16_update_slice4(uint16_t crc, const uint8_t* data, uint32_t length) {
+	uint32_t i = 0;
+
+	for (; i + 4 <= length; i += 4) {
+		crc ^= (uint16_t)(data[i] | (data[i + 1] << 8));
+		crc = crc16_lookup[3][crc & 0xFF] ^
+			  crc16_lookup[2][crc >> 8] ^
+			  crc16_lookup[1][data[i + 2]] ^
+			  crc16_lookup[0][data[i + 3]];
+	}
+
+	return crc16_update_table(crc, data + i, length - i);
+}
+
+uint16_t crc16_update_slice8(uint16_t crc, const uint8_t* data, uint32_t length) {
+	uint32_t i = 0;
+
+	for (; i + 8 <= length; i += 8) {
+		crc ^= (uint16_t)(data[i] | (data[i + 1] << 8));
+		crc = crc16_lookup[7][crc & 0xFF] ^
+			  crc16_lookup[6][crc >> 8] ^
+			  crc16_lookup[5][data[i + 2]] ^
+			  crc16_lookup[4][data[i + 3]] ^
+			  crc16_lookup[3][data[i + 4]] ^
+			  crc16_lookup[2][data[i + 5]] ^
+			  crc16_lookup[1][data[i + 6]] ^
+			  crc16_lookup[0][data[i + 7]];
+	}
+
+	return crc16_update_table(crc, data + i, length - i);
+}
+
+uint16_t crc16_update(uint16_t crc, const uint8_t* data, uint32_t length) {
+	if (data == NULL)
+		return crc;
+
+	return crc16_update_slice8(crc, data, length);
+}
+
 const char* get_parse_error_message(int error_code) {
 	switch (error_code) {
 		case PARSE_OK:
@@ -245,6 +1371,10 @@ const char* get_parse_error_message(int error_code) {
 			return "Error: Buffer too small for specified EEPROM length";
 		case PARSE_ERROR_UNSUPPORTED_VERSION:
 			return "Error: Unsupported version (expected 0x02)";
+		case PARSE_ERROR_CRC_MISMATCH:
+			return "Error: Atom CRC mismatch";
+		case PARSE_ERROR_NOT_FOUND:
+			return "Error: Requested atom or key not found";
 		default:
 			return "Error: Unknown error code";
 	}
@@ -24,12 +24,44 @@ extern "C" {
 #define MAX_STRING_LENGTH      256
 #define MAX_CUSTOM_DATA_SIZE   4096
 #define EXPECTED_VERSION       0x02
+#define ARENA_OFFSET_NONE      0xFFFFFFFFu
+#define ARENA_SIZE_OVERFLOW    0xFFFFFFFFu   // arena_used when the strings would not fit in any arena
+#define BATCH_MAX_THREADS      32
+
+// Atom CRC: CRC-16 poly 0x8005, reflected, init 0 (same as eepmake)
+#define CRC16_POLY_REFLECTED   0xA001
+#define CRC16_INIT             0x0000
 
 #define PARSE_OK                     0
 #define PARSE_ERROR_INVALID_SIG      -1
 #define PARSE_ERROR_INVALID_DATA     -2
 #define PARSE_ERROR_BUFFER_TOO_SMALL -3
 #define PARSE_ERROR_UNSUPPORTED_VERSION -4
+#define PARSE_ERROR_CRC_MISMATCH     -5
+#define PARSE_ERROR_NOT_FOUND        -6
+
+// Parse flags for parse_rpi_hat_eeprom_ex
+#define PARSE_FLAG_VERIFY_CRC        0x01
+#define PARSE_FLAG_GENERIC           0x02  // Ignore registered layouts and always walk the atom chain
+
+// Report formats for format_rpi_hat_eeprom
+#define REPORT_TEXT                  0
+#define REPORT_JSON                  1
+
+// Known layouts for hat_layout_register
+#define HAT_LAYOUT_MAX               16
+#define HAT_LAYOUT_MAX_ATOMS         16
+
+#define MAX_INTEGRITY_ATOMS          64
+
+#define STREAM_NEED_MORE             1
+#define STREAM_COMPLETE              2
+
+#define STREAM_WANT_ALL              0
+#define STREAM_WANT_VENDOR_INFO      (1u << ATOM_TYPE_VENDOR_INFO)
+#define STREAM_WANT_GPIO_MAP         (1u << ATOM_TYPE_GPIO_MAP)
+#define STREAM_WANT_DT_OVERLAY       (1u << ATOM_TYPE_DT_OVERLAY)
+#define STREAM_WANT_CUSTOM           (1u << ATOM_TYPE_CUSTOM)
 
 typedef struct {
     char signature[5];
@@ -45,6 +77,14 @@ typedef struct {
     uint32_t atom_dlen;
 } AtomHeader;
 
+// View of one atom inside the caller's EEPROM buffer (no payload copy)
+typedef struct {
+    uint16_t type;
+    uint16_t count;
+    uint32_t offset;    // Offset of the atom data, just past its 8-byte header
+    uint32_t dlen;      // Data length as stored in the atom header, including the 2-byte CRC
+} AtomView;
+
 typedef struct {
     uint8_t uuid[16];
     uint16_t product_id;
@@ -66,9 +106,64 @@ typedef struct {
     int has_custom_data;
     CustomData custom_data;
     int has_dt_overlay;
+    uint32_t dt_overlay_length;
     char dt_overlay[MAX_STRING_LENGTH];
 } ParsedEeprom;
 
+// Read-only view into caller memory (not NUL-terminated)
+typedef struct {
+    const uint8_t* data;
+    uint32_t length;
+} ByteView;
+
+// Per-atom CRC results from parse_rpi_hat_eeprom_ex
+typedef struct {
+    uint32_t atoms_checked;
+    uint32_t atoms_failed;
+    uint64_t crc_ok_mask;       // Bit i set if atom i's CRC matched (first MAX_INTEGRITY_ATOMS atoms)
+    uint32_t first_failed_atom; // Index of the first failing atom, valid if atoms_failed > 0
+} ParseIntegrity;
+
+// One image in a batch parse
+typedef struct {
+    const uint8_t* data;
+    uint32_t size;
+} EepromImage;
+
+// Compact per-image batch result; strings live in the caller's arena
+typedef struct {
+    int status;                     // PARSE_OK or PARSE_ERROR_* for this image
+    RpiHatHeader header;
+    uint8_t uuid[16];
+    uint16_t product_id;
+    uint16_t product_version;
+    int has_vendor_info;
+    int has_custom_data;
+    int has_dt_overlay;
+    uint32_t vendor_offset;         // NUL-terminated strings in the arena, or ARENA_OFFSET_NONE
+    uint32_t product_offset;
+    uint32_t dt_overlay_offset;
+    uint32_t custom_data_offset;    // Custom payload offset within the source image (not copied)
+    uint32_t custom_data_length;
+    int custom_is_json;
+} EepromSummary;
+
+// Resumable parser state for EEPROM bytes that arrive in chunks
+typedef struct {
+    uint8_t* buffer;        // Caller storage that accumulates the fed bytes
+    uint32_t capacity;
+    uint32_t length;        // Bytes fed so far
+    uint32_t want_mask;     // STREAM_WANT_* atoms that end the parse early
+    uint32_t seen_mask;     // Bit (1 << atom_type) set for every atom decoded so far
+    int header_done;
+    uint16_t atoms_done;
+    uint32_t next_atom;     // Offset of the next atom header
+    int status;             // STREAM_NEED_MORE, STREAM_COMPLETE or a PARSE_ERROR_* code
+    ParsedEeprom* result;
+    uint32_t flags;         // PARSE_FLAG_* options
+    ParseIntegrity integrity;   // Per-atom CRC results (PARSE_FLAG_VERIFY_CRC)
+} StreamParser;
+
 // Callback function type for formatted output
 typedef void (*OutputCallback)(const char* message);
 
@@ -82,6 +177,221 @@ typedef void (*OutputCallback)(const char* message);
  */
 int parse_rpi_hat_eeprom(const uint8_t* eeprom_data, uint32_t data_size, ParsedEeprom* result);
 
+/**
+ * Parse RPi HAT EEPROM data with optional integrity checking
+ * 
+ * With PARSE_FLAG_VERIFY_CRC every atom's CRC16 is checked against the two
+ * bytes that follow its data. Atoms are still decoded when their CRC fails,
+ * so the caller can inspect a damaged image. An image that matches a
+ * registered layout (see hat_layout_register) is decoded from the layout's
+ * fixed offsets unless PARSE_FLAG_GENERIC is set.
+ * 
+ * @param eeprom_data: Pointer to raw EEPROM data buffer
+ * @param data_size: Size of the EEPROM data in bytes
+ * @param flags: PARSE_FLAG_* bits
+ * @param result: Pointer to ParsedEeprom structure to fill
+ * @param integrity: Optional pointer to receive per-atom CRC results
+ * @return: PARSE_OK, PARSE_ERROR_CRC_MISMATCH if any atom failed its CRC, or another error code
+ */
+int parse_rpi_hat_eeprom_ex(const uint8_t* eeprom_data, uint32_t data_size, uint32_t flags,
+                            ParsedEeprom* result, ParseIntegrity* integrity);
+
+/**
+ * Index the atom chain of RPi HAT EEPROM data without copying payloads
+ * 
+ * Walks the atom chain once and stores one AtomView per atom. Views point
+ * into eeprom_data, so the buffer must outlive the returned table.
+ * 
+ * @param eeprom_data: Pointer to raw EEPROM data buffer
+ * @param data_size: Size of the EEPROM data in bytes
+ * @param header: Optional pointer to receive the decoded header (NULL to skip)
+ * @param atoms: Array to receive atom views (may be NULL when max_atoms is 0)
+ * @param max_atoms: Number of entries available in atoms
+ * @param num_atoms: Receives the number of atoms in the chain, which may exceed max_atoms
+ * @return: PARSE_OK on success, error code on failure
+ */
+int index_rpi_hat_eeprom(const uint8_t* eeprom_data, uint32_t data_size, RpiHatHeader* header,
+                         AtomView* atoms, uint32_t max_atoms, uint32_t* num_atoms);
+
+/**
+ * Find the first atom of a given type in an atom index
+ * 
+ * @param atoms: Atom views returned by index_rpi_hat_eeprom
+ * @param num_atoms: Number of valid entries in atoms
+ * @param atom_type: ATOM_TYPE_* value to look for
+ * @return: Pointer to the matching view, or NULL if not present
+ */
+const AtomView* find_atom_view(const AtomView* atoms, uint32_t num_atoms, uint16_t atom_type);
+
+/**
+ * Register a known image layout, such as one of the standard board templates
+ *
+ * The sample's atom chain is walked once. Its header, every atom header and
+ * the vendor string become the layout signature, and the atom offsets are
+ * stored. Images with the same signature then parse without a chain walk,
+ * with results identical to the generic parser; boards that differ only in
+ * UUID, product ID/version or payload bytes share a layout. Register layouts
+ * before parsing from several threads; the table is not locked.
+ *
+ * @param sample: Image with the layout
+ * @param size: Size of sample in bytes
+ * @param layout_id: Receives the layout ID (an identical layout already registered is reused)
+ * @return: PARSE_OK, a parse error if the sample is invalid, PARSE_ERROR_INVALID_DATA if its
+ *          chain is truncated or has more than HAT_LAYOUT_MAX_ATOMS atoms, or
+ *          PARSE_ERROR_BUFFER_TOO_SMALL if HAT_LAYOUT_MAX layouts are registered
+ */
+int hat_layout_register(const uint8_t* sample, uint32_t size, uint32_t* layout_id);
+
+/**
+ * Remove every registered layout
+ */
+void hat_layout_clear(void);
+
+/**
+ * Find the registered layout an image matches
+ *
+ * @param eeprom_data: Pointer to raw EEPROM data buffer
+ * @param data_size: Size of the EEPROM data in bytes
+ * @param layout_id: Receives the layout ID
+ * @return: PARSE_OK, or PARSE_ERROR_NOT_FOUND if no layout matches
+ */
+int hat_layout_identify(const uint8_t* eeprom_data, uint32_t data_size, uint32_t* layout_id);
+
+/**
+ * Get a view of a custom data atom without copying it
+ * 
+ * Unlike parse_rpi_hat_eeprom, the payload is not capped at
+ * MAX_CUSTOM_DATA_SIZE and trailing NUL padding is trimmed. Custom atoms
+ * are returned for every vendor.
+ * 
+ * @param eeprom_data: Pointer to raw EEPROM data buffer
+ * @param data_size: Size of the EEPROM data in bytes
+ * @param index: Which custom atom to return (0 = first)
+ * @param view: Receives a view of the atom data into eeprom_data (CRC excluded)
+ * @return: PARSE_OK, PARSE_ERROR_NOT_FOUND if there is no such atom, or another error code
+ */
+int get_custom_atom_view(const uint8_t* eeprom_data, uint32_t data_size, uint32_t index, ByteView* view);
+
+/**
+ * Find the value of a top-level key in a JSON object, scanning in place
+ * 
+ * Only the top level of the object is searched, and keys are compared
+ * byte for byte (escape sequences are not decoded). Nested values are
+ * skipped without being parsed.
+ * 
+ * @param json: JSON text (e.g. a custom atom view)
+ * @param length: Length of json in bytes
+ * @param key: NUL-terminated key to look up
+ * @param value: Receives the raw JSON text of the value (strings keep their quotes)
+ * @return: PARSE_OK, PARSE_ERROR_NOT_FOUND if the key is absent, PARSE_ERROR_INVALID_DATA if json is malformed
+ */
+int json_find_value(const uint8_t* json, uint32_t length, const char* key, ByteView* value);
+
+/**
+ * Parse many RPi HAT EEPROM images in one call
+ * 
+ * Fills one EepromSummary per image. Vendor, product and overlay strings
+ * are copied into the caller's arena with no per-image allocation; custom
+ * data stays in the source image and is referenced by offset. The arena is
+ * reused from offset 0 on every call.
+ * 
+ * @param images: Array of images to parse
+ * @param count: Number of images
+ * @param results: Array of count summaries to fill
+ * @param arena: Caller storage for string payloads
+ * @param arena_size: Size of arena in bytes
+ * @param arena_used: Optional pointer to receive the arena bytes needed for all strings
+ * @return: PARSE_OK, or PARSE_ERROR_BUFFER_TOO_SMALL if some strings did not fit
+ *          (their offsets are ARENA_OFFSET_NONE); per-image status is in results
+ */
+int parse_rpi_hat_eeprom_batch(const EepromImage* images, uint32_t count, EepromSummary* results,
+                               char* arena, uint32_t arena_size, uint32_t* arena_used);
+
+/**
+ * Parse many RPi HAT EEPROM images on a pool of worker threads
+ * 
+ * Same results as parse_rpi_hat_eeprom_batch. The images are split into
+ * contiguous runs, one per thread, and the arena into equal per-thread
+ * slices, so workers share no state. Arena offsets in the results are
+ * relative to the start of arena.
+ * 
+ * @param images: Array of images to parse
+ * @param count: Number of images
+ * @param results: Array of count summaries to fill
+ * @param arena: Caller storage for string payloads
+ * @param arena_size: Size of arena in bytes
+ * @param arena_used: Optional pointer to receive an arena size that fits every slice,
+ *                    or ARENA_SIZE_OVERFLOW if none does (split the batch)
+ * @param num_threads: Worker count (0 = one per CPU, capped at BATCH_MAX_THREADS and count)
+ * @return: PARSE_OK, or PARSE_ERROR_BUFFER_TOO_SMALL if a slice ran out of arena
+ */
+int parse_rpi_hat_eeprom_batch_mt(const EepromImage* images, uint32_t count, EepromSummary* results,
+                                  char* arena, uint32_t arena_size, uint32_t* arena_used, uint32_t num_threads);
+
+/**
+ * Initialize a streaming parser
+ * 
+ * Atoms are decoded into result as soon as their last byte has been fed,
+ * so result fields for completed atoms are valid before the image ends.
+ * 
+ * @param ctx: Parser state to initialize
+ * @param buffer: Storage for the fed bytes (at least the EEPROM size)
+ * @param capacity: Size of buffer in bytes
+ * @param want_mask: STREAM_WANT_* bits to stop at, or STREAM_WANT_ALL to walk the whole chain
+ * @param result: ParsedEeprom structure that receives decoded atoms
+ * @return: PARSE_OK on success, error code on failure
+ */
+int stream_parser_init(StreamParser* ctx, uint8_t* buffer, uint32_t capacity, uint32_t want_mask, ParsedEeprom* result);
+
+/**
+ * Initialize a streaming parser with options
+ * 
+ * With PARSE_FLAG_VERIFY_CRC each atom's CRC is checked as soon as the atom
+ * is complete and recorded in ctx->integrity; stream_parser_finish then
+ * reports PARSE_ERROR_CRC_MISMATCH if any atom failed.
+ * 
+ * @param ctx: Parser state to initialize
+ * @param buffer: Storage for the fed bytes (at least the EEPROM size)
+ * @param capacity: Size of buffer in bytes
+ * @param want_mask: STREAM_WANT_* bits to stop at, or STREAM_WANT_ALL to walk the whole chain
+ * @param flags: PARSE_FLAG_* bits
+ * @param result: ParsedEeprom structure that receives decoded atoms
+ * @return: PARSE_OK on success, error code on failure
+ */
+int stream_parser_init_ex(StreamParser* ctx, uint8_t* buffer, uint32_t capacity, uint32_t want_mask,
+                          uint32_t flags, ParsedEeprom* result);
+
+/**
+ * Feed the next chunk of EEPROM bytes to a streaming parser
+ * 
+ * @param ctx: Parser state from stream_parser_init
+ * @param chunk: Bytes that follow the previously fed data
+ * @param chunk_len: Number of bytes in chunk
+ * @return: STREAM_NEED_MORE, STREAM_COMPLETE once the wanted atoms (or the
+ *          whole chain) are decoded, or a PARSE_ERROR_* code
+ */
+int stream_parser_feed(StreamParser* ctx, const uint8_t* chunk, uint32_t chunk_len);
+
+/**
+ * Get the number of bytes needed to complete the next header or atom
+ * 
+ * @param ctx: Parser state from stream_parser_init
+ * @return: Byte count to read next, or 0 once the parser is complete or failed
+ */
+uint32_t stream_parser_bytes_needed(const StreamParser* ctx);
+
+/**
+ * Finish a streaming parse
+ * 
+ * A stream that stops early is still valid as long as the header was read;
+ * result then holds every atom completed so far.
+ * 
+ * @param ctx: Parser state from stream_parser_init
+ * @return: PARSE_OK on success, PARSE_ERROR_CRC_MISMATCH if CRC checking was
+ *          requested and an atom failed, or another error code
+ */
+int stream_parser_finish(StreamParser* ctx);
+
 /**
  * Parse and print RPi HAT EEPROM data with formatted output
  * 
@@ -92,6 +402,56 @@ int parse_rpi_hat_eeprom(const uint8_t* eeprom_data, uint32_t data_size, ParsedE
  */
 int parse_and_print_eeprom(const uint8_t* eeprom_data, uint32_t data_size, OutputCallback callback);
 
+/**
+ * Parse RPi HAT EEPROM data and write the whole report into one buffer
+ * 
+ * REPORT_TEXT gives the lines of parse_and_print_eeprom, each ending in
+ * '\n', except that non-JSON custom data is hexdumped in full (offset, hex,
+ * ASCII). REPORT_JSON gives one JSON object with the same fields plus the
+ * vendor UUID and, for non-JSON custom data, the whole payload as hex.
+ * Custom data is taken from the image, so it is not capped at
+ * MAX_CUSTOM_DATA_SIZE; JSON strings escape bytes 0x80 and above as \u00XX.
+ * A failed parse still produces a report carrying the error message.
+ * The output is always NUL-terminated when out_size > 0.
+ * 
+ * @param eeprom_data: Pointer to raw EEPROM data buffer
+ * @param data_size: Size of the EEPROM data in bytes
+ * @param report_format: REPORT_TEXT or REPORT_JSON
+ * @param out: Output buffer (may be NULL when out_size is 0, to size the report)
+ * @param out_size: Size of out in bytes
+ * @param out_length: Receives the report length excluding the NUL, even when it did not fit
+ * @param parse_status: Optional pointer to receive the parse status of the image
+ * @return: PARSE_OK, PARSE_ERROR_BUFFER_TOO_SMALL if the report was truncated, or
+ *          PARSE_ERROR_INVALID_DATA for bad arguments
+ */
+int format_rpi_hat_eeprom(const uint8_t* eeprom_data, uint32_t data_size, uint32_t report_format,
+                          char* out, uint32_t out_size, uint32_t* out_length, int* parse_status);
+
+/**
+ * Update an atom CRC16 over a block of bytes (fastest variant)
+ * 
+ * Start with CRC16_INIT; the atom CRC covers the atom data only and is
+ * stored little-endian after it.
+ * 
+ * @param crc: Running CRC
+ * @param data: Bytes to add
+ * @param length: Number of bytes
+ * @return: Updated CRC
+ */
+uint16_t crc16_update(uint16_t crc, const uint8_t* data, uint32_t length);
+
+/**
+ * Reference CRC16 variants, all returning the same value as crc16_update
+ * 
+ * bitwise: one bit per step, no table
+ * table: one 256-entry lookup per byte
+ * slice4/slice8: 4 or 8 bytes per step using 4 or 8 lookup tables
+ */
+uint16_t crc16_update_bitwise(uint16_t crc, const uint8_t* data, uint32_t length);
+uint16_t crc16_update_table(uint16_t crc, const uint8_t* data, uint32_t length);
+uint16_t crc16_update_slice4(uint16_t crc, const uint8_t* data, uint32_t length);
+uint16_t crc16_update_slice8(uint16_t crc, const uint8_t* data, uint32_t length);
+
 /**
  * Get a human-readable error message for a parse error code
  * 
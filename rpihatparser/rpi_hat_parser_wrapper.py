@@ -4,13 +4,22 @@ Python wrapper for rpi_hat_parser DLL
 
 import ctypes
 import os
-from typing import Optional, Callable, Tuple
+import sys
+from typing import Optional, Callable, Tuple, List
+
+# The same sources build rpi_hat_parser.dll, .so or .dylib (see Makefile); load the one for this platform
+if sys.platform == 'win32':
+	LIBRARY_NAME = 'rpi_hat_parser.dll'
+elif sys.platform == 'darwin':
+	LIBRARY_NAME = 'rpi_hat_parser.dylib'
+else:
+	LIBRARY_NAME = 'rpi_hat_parser.so'
 
 script_dir = os.path.dirname(os.path.abspath(__file__))
-dll_path = os.path.join(script_dir, 'rpi_hat_parser.dll')
+dll_path = os.path.join(script_dir, LIBRARY_NAME)
 
 if not os.path.exists(dll_path):
-	raise FileNotFoundError(f"DLL not found: {dll_path}\nPlease compile the C code first.")
+	raise FileNotFoundError(f"Native library not found: {dll_path}\nPlease compile the C code first (make, or build_dll.bat on Windows).")
 
 parser_lib = ctypes.cdll.LoadLibrary(dll_path)
 
@@ -24,10 +33,38 @@ PARSE_ERROR_INVALID_SIG = -1
 PARSE_ERROR_INVALID_DATA = -2
 PARSE_ERROR_BUFFER_TOO_SMALL = -3
 PARSE_ERROR_UNSUPPORTED_VERSION = -4
+PARSE_ERROR_CRC_MISMATCH = -5
+PARSE_ERROR_NOT_FOUND = -6
+
+PARSE_FLAG_VERIFY_CRC = 0x01
+PARSE_FLAG_GENERIC = 0x02
+
+REPORT_TEXT = 0
+REPORT_JSON = 1
+
+HAT_LAYOUT_MAX = 16
+HAT_LAYOUT_MAX_ATOMS = 16
+
+MAX_INTEGRITY_ATOMS = 64
+
+STREAM_NEED_MORE = 1
+STREAM_COMPLETE = 2
+
+STREAM_WANT_ALL = 0
+STREAM_WANT_VENDOR_INFO = 1 << ATOM_TYPE_VENDOR_INFO
+STREAM_WANT_GPIO_MAP = 1 << ATOM_TYPE_GPIO_MAP
+STREAM_WANT_DT_OVERLAY = 1 << ATOM_TYPE_DT_OVERLAY
+STREAM_WANT_CUSTOM = 1 << ATOM_TYPE_CUSTOM
 
 MAX_STRING_LENGTH = 256
 MAX_CUSTOM_DATA_SIZE = 4096
 
+DEFAULT_MAX_INDEXED_ATOMS = 32
+DEFAULT_BATCH_ARENA_SIZE = 64 * 1024
+DEFAULT_REPORT_SIZE = 32 * 1024  # Fits a text report with a full MAX_CUSTOM_DATA_SIZE hexdump
+ARENA_OFFSET_NONE = 0xFFFFFFFF
+ARENA_SIZE_OVERFLOW = 0xFFFFFFFF
+
 class RpiHatHeader(ctypes.Structure):
 	_fields_ = [
 		('signature', ctypes.c_char * 5),
@@ -37,6 +74,14 @@ class RpiHatHeader(ctypes.Structure):
 		('eeplen', ctypes.c_uint32)
 	]
 
+class AtomView(ctypes.Structure):
+	_fields_ = [
+		('type', ctypes.c_uint16),
+		('count', ctypes.c_uint16),
+		('offset', ctypes.c_uint32),
+		('dlen', ctypes.c_uint32)
+	]
+
 class VendorInfo(ctypes.Structure):
 	_fields_ = [
 		('uuid', ctypes.c_uint8 * 16),
@@ -65,6 +110,64 @@ class ParsedEeprom(ctypes.Structure):
 		('dt_overlay', ctypes.c_char * MAX_STRING_LENGTH)
 	]
 
+class ByteView(ctypes.Structure):
+	_fields_ = [
+		('data', ctypes.c_void_p),
+		('length', ctypes.c_uint32)
+	]
+
+class ParseIntegrity(ctypes.Structure):
+	_fields_ = [
+		('atoms_checked', ctypes.c_uint32),
+		('atoms_failed', ctypes.c_uint32),
+		('crc_ok_mask', ctypes.c_uint64),
+		('first_failed_atom', ctypes.c_uint32)
+	]
+
+	def atom_ok(self, index: int) -> bool:
+		"""True if atom index passed its CRC check."""
+		return index < MAX_INTEGRITY_ATOMS and bool(self.crc_ok_mask & (1 << index))
+
+class EepromImage(ctypes.Structure):
+	_fields_ = [
+		('data', ctypes.POINTER(ctypes.c_uint8)),
+		('size', ctypes.c_uint32)
+	]
+
+class EepromSummary(ctypes.Structure):
+	_fields_ = [
+		('status', ctypes.c_int),
+		('header', RpiHatHeader),
+		('uuid', ctypes.c_uint8 * 16),
+		('product_id', ctypes.c_uint16),
+		('product_version', ctypes.c_uint16),
+		('has_vendor_info', ctypes.c_int),
+		('has_custom_data', ctypes.c_int),
+		('has_dt_overlay', ctypes.c_int),
+		('vendor_offset', ctypes.c_uint32),
+		('product_offset', ctypes.c_uint32),
+		('dt_overlay_offset', ctypes.c_uint32),
+		('custom_data_offset', ctypes.c_uint32),
+		('custom_data_length', ctypes.c_uint32),
+		('custom_is_json', ctypes.c_int)
+	]
+
+class StreamParser(ctypes.Structure):
+	_fields_ = [
+		('buffer', ctypes.POINTER(ctypes.c_uint8)),
+		('capacity', ctypes.c_uint32),
+		('length', ctypes.c_uint32),
+		('want_mask', ctypes.c_uint32),
+		('seen_mask', ctypes.c_uint32),
+		('header_done', ctypes.c_int),
+		('atoms_done', ctypes.c_uint16),
+		('next_atom', ctypes.c_uint32),
+		('status', ctypes.c_int),
+		('result', ctypes.POINTER(ParsedEeprom)),
+		('flags', ctypes.c_uint32),
+		('integrity', ParseIntegrity)
+	]
+
 parser_lib.parse_rpi_hat_eeprom.argtypes = [
 	ctypes.POINTER(ctypes.c_uint8),
 	ctypes.c_uint32,
@@ -72,6 +175,15 @@ parser_lib.parse_rpi_hat_eeprom.argtypes = [
 ]
 parser_lib.parse_rpi_hat_eeprom.restype = ctypes.c_int
 
+parser_lib.parse_rpi_hat_eeprom_ex.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ParsedEeprom),
+	ctypes.POINTER(ParseIntegrity)
+]
+parser_lib.parse_rpi_hat_eeprom_ex.restype = ctypes.c_int
+
 OutputCallback = ctypes.CFUNCTYPE(None, ctypes.c_char_p)
 parser_lib.parse_and_print_eeprom.argtypes = [
 	ctypes.POINTER(ctypes.c_uint8),
@@ -80,28 +192,188 @@ parser_lib.parse_and_print_eeprom.argtypes = [
 ]
 parser_lib.parse_and_print_eeprom.restype = ctypes.c_int
 
+parser_lib.format_rpi_hat_eeprom.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.POINTER(ctypes.c_int)
+]
+parser_lib.format_rpi_hat_eeprom.restype = ctypes.c_int
+
+parser_lib.index_rpi_hat_eeprom.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(RpiHatHeader),
+	ctypes.POINTER(AtomView),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+parser_lib.index_rpi_hat_eeprom.restype = ctypes.c_int
+
+parser_lib.hat_layout_register.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+parser_lib.hat_layout_register.restype = ctypes.c_int
+
+parser_lib.hat_layout_clear.argtypes = []
+parser_lib.hat_layout_clear.restype = None
+
+parser_lib.hat_layout_identify.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+parser_lib.hat_layout_identify.restype = ctypes.c_int
+
+parser_lib.get_custom_atom_view.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ByteView)
+]
+parser_lib.get_custom_atom_view.restype = ctypes.c_int
+
+parser_lib.json_find_value.argtypes = [
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_char_p,
+	ctypes.POINTER(ByteView)
+]
+parser_lib.json_find_value.restype = ctypes.c_int
+
+parser_lib.parse_rpi_hat_eeprom_batch.argtypes = [
+	ctypes.POINTER(EepromImage),
+	ctypes.c_uint32,
+	ctypes.POINTER(EepromSummary),
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32)
+]
+parser_lib.parse_rpi_hat_eeprom_batch.restype = ctypes.c_int
+
+parser_lib.parse_rpi_hat_eeprom_batch_mt.argtypes = [
+	ctypes.POINTER(EepromImage),
+	ctypes.c_uint32,
+	ctypes.POINTER(EepromSummary),
+	ctypes.c_char_p,
+	ctypes.c_uint32,
+	ctypes.POINTER(ctypes.c_uint32),
+	ctypes.c_uint32
+]
+parser_lib.parse_rpi_hat_eeprom_batch_mt.restype = ctypes.c_int
+
+parser_lib.stream_parser_init.argtypes = [
+	ctypes.POINTER(StreamParser),
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ParsedEeprom)
+]
+parser_lib.stream_parser_init.restype = ctypes.c_int
+
+parser_lib.stream_parser_init_ex.argtypes = [
+	ctypes.POINTER(StreamParser),
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.c_uint32,
+	ctypes.POINTER(ParsedEeprom)
+]
+parser_lib.stream_parser_init_ex.restype = ctypes.c_int
+
+parser_lib.stream_parser_feed.argtypes = [
+	ctypes.POINTER(StreamParser),
+	ctypes.POINTER(ctypes.c_uint8),
+	ctypes.c_uint32
+]
+parser_lib.stream_parser_feed.restype = ctypes.c_int
+
+parser_lib.stream_parser_bytes_needed.argtypes = [ctypes.POINTER(StreamParser)]
+parser_lib.stream_parser_bytes_needed.restype = ctypes.c_uint32
+
+parser_lib.stream_parser_finish.argtypes = [ctypes.POINTER(StreamParser)]
+parser_lib.stream_parser_finish.restype = ctypes.c_int
+
+for _crc_func in ('crc16_update', 'crc16_update_bitwise', 'crc16_update_table',
+				  'crc16_update_slice4', 'crc16_update_slice8'):
+	getattr(parser_lib, _crc_func).argtypes = [ctypes.c_uint16, ctypes.c_char_p, ctypes.c_uint32]
+	getattr(parser_lib, _crc_func).restype = ctypes.c_uint16
+
 parser_lib.get_parse_error_message.argtypes = [ctypes.c_int]
 parser_lib.get_parse_error_message.restype = ctypes.c_char_p
 
-def parse_rpi_hat_eeprom(eeprom_data: bytes) -> Tuple[int, Optional[ParsedEeprom]]:
+_uint8_p = ctypes.POINTER(ctypes.c_uint8)
+
+
+def _data_buffer(data) -> Tuple[ctypes.POINTER(ctypes.c_uint8), int]:
+	"""
+	Pointer to and size of the bytes of data, without copying where possible.
+	
+	bytes and writable C-contiguous buffers (bytearray, memoryview, numpy
+	arrays, ctypes arrays) are passed in place. Other read-only or strided
+	buffers are copied once in C; lists of integers are converted.
+	The caller must keep a bytes argument alive while the pointer is used;
+	for every other input the pointer owns what it points to.
+	"""
+	if isinstance(data, bytes):
+		return (ctypes.cast(data, _uint8_p), len(data))
+	if isinstance(data, list):
+		# cast() does not keep a bytes object alive, so copy into an array that the pointer owns
+		return (ctypes.cast((ctypes.c_uint8 * len(data)).from_buffer_copy(bytes(data)), _uint8_p), len(data))
+
+	try:
+		view = memoryview(data)
+	except TypeError:
+		raise TypeError("data must be bytes, a buffer object, or list of integers") from None
+
+	size = view.nbytes
+	if not view.c_contiguous:
+		view = memoryview(view.tobytes())
+	elif not view.readonly:
+		return (ctypes.cast((ctypes.c_uint8 * size).from_buffer(view), _uint8_p), size)
+	return (ctypes.cast((ctypes.c_uint8 * size).from_buffer_copy(view), _uint8_p), size)
+
+
+def _data_pointer(data):
+	"""Pointer to the bytes of data (see _data_buffer)."""
+	return _data_buffer(data)[0]
+
+
+def _grow_arena(arena, arena_used: int):
+	"""
+	Arena for retrying a call that returned PARSE_ERROR_BUFFER_TOO_SMALL.
+
+	Returns None when growing cannot help (ARENA_SIZE_OVERFLOW, or no larger
+	than the current arena), so retry loops keep the partial result instead
+	of spinning.
+	"""
+	if arena_used == ARENA_SIZE_OVERFLOW or arena_used <= len(arena):
+		return None
+	return ctypes.create_string_buffer(arena_used)
+
+
+def parse_rpi_hat_eeprom(eeprom_data, result: Optional[ParsedEeprom] = None) -> Tuple[int, Optional[ParsedEeprom]]:
 	"""
 	Parse RPi HAT EEPROM data using the C DLL.
 	
 	Args:
-		eeprom_data: Raw EEPROM data as bytes
+		eeprom_data: Raw EEPROM data as bytes, any buffer object (bytearray, memoryview,
+			numpy array), or list of integers; buffers are passed without copying
+		result: Optional ParsedEeprom to fill in, reused across calls to avoid an allocation
 		
 	Returns:
 		Tuple: (status_code, ParsedEeprom object or None)
 	"""
-	if not isinstance(eeprom_data, (bytes, bytearray, list)):
-		raise TypeError("eeprom_data must be bytes, bytearray, or list of integers")
-	
-	# Convert to ctypes array
-	data_array = (ctypes.c_uint8 * len(eeprom_data))(*eeprom_data)
-	result = ParsedEeprom()
+	pointer, size = _data_buffer(eeprom_data)
+	if result is None:
+		result = ParsedEeprom()
 	
-	# Call the DLL function
-	status = parser_lib.parse_rpi_hat_eeprom(data_array, len(eeprom_data), ctypes.byref(result))
+	status = parser_lib.parse_rpi_hat_eeprom(pointer, size, ctypes.byref(result))
 	
 	if status == PARSE_OK:
 		return (status, result)
@@ -109,36 +381,392 @@ def parse_rpi_hat_eeprom(eeprom_data: bytes) -> Tuple[int, Optional[ParsedEeprom
 		return (status, None)
 
 
+def _view_slice(data, pointer, view: ByteView) -> memoryview:
+	offset = view.data - ctypes.cast(pointer, ctypes.c_void_p).value
+	return memoryview(data)[offset:offset + view.length]
+
+
+def get_custom_atom_view(eeprom_data, index: int = 0) -> Optional[memoryview]:
+	"""
+	Zero-copy view of a custom data atom (CRC and NUL padding excluded).
+	
+	Args:
+		eeprom_data: Raw EEPROM data as bytes or bytearray
+		index: Which custom atom to return (0 = first)
+		
+	Returns:
+		memoryview into eeprom_data, or None if there is no such atom
+	"""
+	pointer, size = _data_buffer(eeprom_data)
+	view = ByteView()
+	status = parser_lib.get_custom_atom_view(pointer, size, index, ctypes.byref(view))
+	if status != PARSE_OK:
+		return None
+	return _view_slice(eeprom_data, pointer, view)
+
+
+def find_json_value_span(json_data, key: str) -> Optional[Tuple[int, int]]:
+	"""
+	Location of a top-level key's value, found by scanning in place.
+	
+	Args:
+		json_data: JSON object text as bytes or bytearray
+		key: Top-level key to look up
+		
+	Returns:
+		tuple: (offset, length) of the value text in json_data, or None if absent or malformed
+	"""
+	pointer, size = _data_buffer(json_data)
+	view = ByteView()
+	status = parser_lib.json_find_value(pointer, size, key.encode('utf-8'), ctypes.byref(view))
+	if status != PARSE_OK:
+		return None
+	return (view.data - ctypes.cast(pointer, ctypes.c_void_p).value, view.length)
+
+
+def find_json_value(json_data, key: str) -> Optional[memoryview]:
+	"""
+	Raw JSON text of a top-level key's value, found by scanning in place.
+	
+	Args:
+		json_data: JSON object text as bytes or bytearray (e.g. bytes(get_custom_atom_view(...)))
+		key: Top-level key to look up
+		
+	Returns:
+		memoryview of the value text (strings keep their quotes), or None if absent or malformed
+	"""
+	span = find_json_value_span(json_data, key)
+	if span is None:
+		return None
+	return memoryview(json_data)[span[0]:span[0] + span[1]]
+
+
+def get_custom_json_value(eeprom_data, key: str, index: int = 0):
+	"""
+	Look up one top-level key of a JSON custom atom without decoding the rest.
+	
+	Args:
+		eeprom_data: Raw EEPROM data as bytes or bytearray
+		key: Top-level key to look up
+		index: Which custom atom to search (0 = first)
+		
+	Returns:
+		The decoded value, or None if the atom or key is absent
+	"""
+	pointer, size = _data_buffer(eeprom_data)
+	atom = ByteView()
+	if parser_lib.get_custom_atom_view(pointer, size, index, ctypes.byref(atom)) != PARSE_OK:
+		return None
+
+	value = ByteView()
+	if parser_lib.json_find_value(ctypes.cast(atom.data, ctypes.POINTER(ctypes.c_uint8)), atom.length,
+								  key.encode('utf-8'), ctypes.byref(value)) != PARSE_OK:
+		return None
+
+	import json
+	return json.loads(ctypes.string_at(value.data, value.length))
+
+
+def parse_rpi_hat_eeprom_ex(eeprom_data, flags: int = PARSE_FLAG_VERIFY_CRC, result: Optional[ParsedEeprom] = None,
+							integrity: Optional[ParseIntegrity] = None) -> Tuple[int, Optional[ParsedEeprom], ParseIntegrity]:
+	"""
+	Parse RPi HAT EEPROM data and check each atom's CRC16.
+	
+	Args:
+		eeprom_data: Raw EEPROM data (see parse_rpi_hat_eeprom)
+		flags: PARSE_FLAG_* bits (PARSE_FLAG_VERIFY_CRC by default)
+		result: Optional ParsedEeprom to reuse
+		integrity: Optional ParseIntegrity to reuse
+		
+	Returns:
+		Tuple: (status_code, ParsedEeprom or None, ParseIntegrity).
+		The ParsedEeprom is also returned on PARSE_ERROR_CRC_MISMATCH.
+	"""
+	pointer, size = _data_buffer(eeprom_data)
+	if result is None:
+		result = ParsedEeprom()
+	if integrity is None:
+		integrity = ParseIntegrity()
+	
+	status = parser_lib.parse_rpi_hat_eeprom_ex(pointer, size, flags,
+												ctypes.byref(result), ctypes.byref(integrity))
+	
+	if status in (PARSE_OK, PARSE_ERROR_CRC_MISMATCH):
+		return (status, result, integrity)
+	else:
+		return (status, None, integrity)
+
+
+def index_rpi_hat_eeprom(eeprom_data: bytes, max_atoms: int = DEFAULT_MAX_INDEXED_ATOMS) -> Tuple[int, Optional[RpiHatHeader], List[AtomView]]:
+	"""
+	Index the atom chain of RPi HAT EEPROM data without copying payloads.
+	
+	Each AtomView holds the atom type, count, data offset and data length
+	(including CRC); slice eeprom_data with offset/dlen to read a payload.
+	
+	Args:
+		eeprom_data: Raw EEPROM data (see parse_rpi_hat_eeprom)
+		max_atoms: Initial size of the view table (grown automatically if needed)
+		
+	Returns:
+		Tuple: (status_code, RpiHatHeader or None, list of AtomView)
+	"""
+	pointer, size = _data_buffer(eeprom_data)
+	header = RpiHatHeader()
+	num_atoms = ctypes.c_uint32()
+	
+	while True:
+		atoms = (AtomView * max_atoms)()
+		status = parser_lib.index_rpi_hat_eeprom(pointer, size, ctypes.byref(header),
+												 atoms, max_atoms, ctypes.byref(num_atoms))
+		if status != PARSE_OK:
+			return (status, None, [])
+		if num_atoms.value <= max_atoms:
+			return (status, header, atoms[:num_atoms.value])
+		max_atoms = num_atoms.value
+
+
 def parse_and_print_eeprom(eeprom_data: bytes, output_callback: Optional[Callable[[str], None]] = None) -> int:
 	"""
 	Parse and print RPi HAT EEPROM data with formatted output.
 	
 	Args:
-		eeprom_data: Raw EEPROM data as bytes
+		eeprom_data: Raw EEPROM data (see parse_rpi_hat_eeprom)
 		output_callback: Optional callback function for output lines (receives string)
 		
 	Returns:
 		int: Status code (PARSE_OK on success)
 	"""
-	if not isinstance(eeprom_data, (bytes, bytearray, list)):
-		raise TypeError("eeprom_data must be bytes, bytearray, or list of integers")
-	
-	# Convert to ctypes array
-	data_array = (ctypes.c_uint8 * len(eeprom_data))(*eeprom_data)
+	pointer, size = _data_buffer(eeprom_data)
 	
 	# Create callback wrapper if provided
 	if output_callback:
 		def c_callback(msg):
 			output_callback(msg.decode('utf-8'))
 		callback_func = OutputCallback(c_callback)
-		status = parser_lib.parse_and_print_eeprom(data_array, len(eeprom_data), callback_func)
+		status = parser_lib.parse_and_print_eeprom(pointer, size, callback_func)
 	else:
 		# Pass NULL (None cast to the callback type)
-		status = parser_lib.parse_and_print_eeprom(data_array, len(eeprom_data), ctypes.cast(None, OutputCallback))
+		status = parser_lib.parse_and_print_eeprom(pointer, size, ctypes.cast(None, OutputCallback))
 	
 	return status
 
 
+class ReportFormatter:
+	"""
+	Format whole EEPROM reports with one foreign call each.
+	
+	Keeps one output buffer across calls and grows it when a report does
+	not fit, so formatting many images allocates once.
+	"""
+	
+	def __init__(self, buffer_size: int = DEFAULT_REPORT_SIZE):
+		self._buffer = ctypes.create_string_buffer(buffer_size)
+		self._length = ctypes.c_uint32()
+		self._status = ctypes.c_int()
+	
+	def format(self, eeprom_data, report_format: int = REPORT_TEXT) -> Tuple[int, str]:
+		"""
+		Format one image.
+		
+		Args:
+			eeprom_data: Raw EEPROM data (see parse_rpi_hat_eeprom)
+			report_format: REPORT_TEXT or REPORT_JSON
+			
+		Returns:
+			tuple: (parse status of the image, report text)
+		"""
+		pointer, size = _data_buffer(eeprom_data)
+		
+		while True:
+			ret = parser_lib.format_rpi_hat_eeprom(pointer, size, report_format, self._buffer, len(self._buffer),
+												   ctypes.byref(self._length), ctypes.byref(self._status))
+			if ret != PARSE_ERROR_BUFFER_TOO_SMALL:
+				break
+			self._buffer = ctypes.create_string_buffer(self._length.value + 1)
+		
+		if ret != PARSE_OK:
+			raise ValueError(f"Cannot format report: {get_parse_error_message(ret)}")
+		
+		return (self._status.value, self._buffer.raw[:self._length.value].decode('utf-8', 'replace'))
+
+
+def format_rpi_hat_eeprom(eeprom_data, report_format: int = REPORT_TEXT) -> Tuple[int, str]:
+	"""
+	Format an EEPROM report as text (the parse_and_print_eeprom lines with a
+	full custom data hexdump) or JSON, in one call.
+	
+	Returns:
+		tuple: (parse status of the image, report text)
+	"""
+	return ReportFormatter().format(eeprom_data, report_format)
+
+
+class BatchParser:
+	"""
+	Parse many EEPROM images with one foreign call per batch.
+	
+	The string arena and result table are kept between calls and only
+	grown when a batch needs more room. Images are passed by pointer, so
+	bytes and writable buffer inputs are not copied; keep them alive while
+	using the returned summaries' custom data offsets.
+	"""
+
+	def __init__(self, arena_size: int = DEFAULT_BATCH_ARENA_SIZE):
+		self._arena = ctypes.create_string_buffer(arena_size)
+		self._results = (EepromSummary * 0)()
+		self._pointers = []
+
+	def parse(self, images: List[bytes], num_threads: int = 1) -> List[EepromSummary]:
+		"""
+		Parse a list of EEPROM images.
+		
+		The DLL call releases the GIL, so num_threads > 1 spreads the batch
+		across cores.
+		
+		Args:
+			images: List of raw EEPROM images (bytes or any buffer object)
+			num_threads: Worker threads in the DLL (0 = one per CPU)
+			
+		Returns:
+			list: One EepromSummary per image; check each summary's status
+		"""
+		count = len(images)
+		image_table = (EepromImage * count)()
+		self._pointers = [_data_buffer(data) for data in images]
+		for i, (pointer, size) in enumerate(self._pointers):
+			image_table[i].data = pointer
+			image_table[i].size = size
+
+		if len(self._results) < count:
+			self._results = (EepromSummary * count)()
+
+		arena_used = ctypes.c_uint32()
+		while True:
+			status = parser_lib.parse_rpi_hat_eeprom_batch_mt(image_table, count, self._results, self._arena,
+															  len(self._arena), ctypes.byref(arena_used), num_threads)
+			grown = _grow_arena(self._arena, arena_used.value) if status == PARSE_ERROR_BUFFER_TOO_SMALL else None
+			if grown is None:
+				break
+			self._arena = grown
+
+		return self._results[:count]
+
+	def string_at(self, offset: int) -> Optional[str]:
+		"""Decode a NUL-terminated arena string (vendor_offset, product_offset, dt_overlay_offset)."""
+		if offset == ARENA_OFFSET_NONE or offset >= len(self._arena):
+			return None
+		return ctypes.string_at(ctypes.addressof(self._arena) + offset).decode('utf-8', errors='replace')
+
+	def custom_data(self, index: int) -> bytes:
+		"""Custom data payload of image index from the last parse() call."""
+		summary = self._results[index]
+		if not summary.has_custom_data:
+			return b''
+		start = summary.custom_data_offset
+		return ctypes.string_at(ctypes.addressof(self._pointers[index][0].contents) + start, summary.custom_data_length)
+
+
+class IncrementalParser:
+	"""
+	Resumable parser for EEPROM bytes that arrive in chunks (e.g. over I2C).
+	
+	Feed chunks in order; feed() returns STREAM_COMPLETE as soon as the atoms
+	selected by want_mask are decoded, so the caller can stop reading early.
+	With flags=PARSE_FLAG_VERIFY_CRC each atom's CRC is checked as it completes.
+	"""
+
+	def __init__(self, capacity: int, want_mask: int = STREAM_WANT_ALL, flags: int = 0):
+		self._buffer = (ctypes.c_uint8 * capacity)()
+		self._ctx = StreamParser()
+		self.result = ParsedEeprom()
+		status = parser_lib.stream_parser_init_ex(ctypes.byref(self._ctx), self._buffer, capacity,
+												  want_mask, flags, ctypes.byref(self.result))
+		if status != PARSE_OK:
+			raise ValueError(get_parse_error_message(status))
+
+	def feed(self, chunk) -> int:
+		"""Feed the next chunk; returns STREAM_NEED_MORE, STREAM_COMPLETE or a PARSE_ERROR_* code."""
+		pointer, size = _data_buffer(chunk)
+		return parser_lib.stream_parser_feed(ctypes.byref(self._ctx), pointer, size)
+
+	def bytes_needed(self) -> int:
+		"""Number of bytes that completes the next header or atom (0 when done)."""
+		return parser_lib.stream_parser_bytes_needed(ctypes.byref(self._ctx))
+
+	def finish(self) -> int:
+		"""Returns PARSE_OK if the header was read and no error occurred."""
+		return parser_lib.stream_parser_finish(ctypes.byref(self._ctx))
+
+	@property
+	def bytes_fed(self) -> int:
+		return self._ctx.length
+
+	@property
+	def integrity(self) -> 'ParseIntegrity':
+		"""CRC results for the atoms completed so far (with PARSE_FLAG_VERIFY_CRC)."""
+		return self._ctx.integrity
+
+
+def register_layout(sample) -> Tuple[int, int]:
+	"""
+	Register a known image layout (e.g. a standard board template) for the fast parse path.
+	
+	Images whose header, atom headers and vendor string match the sample are
+	decoded from fixed offsets; results are the same as the generic parser.
+	
+	Args:
+		sample: Image with the layout (bytes or any buffer object)
+		
+	Returns:
+		tuple: (status, layout ID)
+	"""
+	pointer, size = _data_buffer(sample)
+	layout_id = ctypes.c_uint32()
+	status = parser_lib.hat_layout_register(pointer, size, ctypes.byref(layout_id))
+	return (status, layout_id.value)
+
+
+def register_layout_files(paths: List[str]) -> List[Tuple[int, int]]:
+	"""Register the layout of each image file; returns one (status, layout ID) per path."""
+	results = []
+	for path in paths:
+		with open(path, 'rb') as f:
+			results.append(register_layout(f.read()))
+	return results
+
+
+def clear_layouts():
+	"""Remove every registered layout."""
+	parser_lib.hat_layout_clear()
+
+
+def identify_layout(eeprom_data) -> Optional[int]:
+	"""ID of the registered layout eeprom_data matches, or None."""
+	pointer, size = _data_buffer(eeprom_data)
+	layout_id = ctypes.c_uint32()
+	if parser_lib.hat_layout_identify(pointer, size, ctypes.byref(layout_id)) != PARSE_OK:
+		return None
+	return layout_id.value
+
+
+def crc16(data, crc: int = 0) -> int:
+	"""
+	Atom CRC16 (poly 0x8005, reflected, init 0) computed in the DLL.
+	
+	Args:
+		data: Bytes to checksum (bytes or any buffer object)
+		crc: Running CRC to continue from
+		
+	Returns:
+		int: CRC16 value
+	"""
+	if isinstance(data, bytes):
+		return parser_lib.crc16_update(crc, data, len(data))
+	pointer, size = _data_buffer(data)
+	return parser_lib.crc16_update(crc, ctypes.cast(pointer, ctypes.c_char_p), size)
+
+
 def get_parse_error_message(error_code: int) -> str:
 	"""
 	Get human-readable error message for a parse error code.
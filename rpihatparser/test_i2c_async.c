@@ -0,0 +1,141 @@
+/**
+ * test_i2c_async.c
+ *
+ * Regression test for freeing an asynchronous transfer from its own completion callback
+ * Usage: test_i2c_async <mpsse_stub library> [-n iterations]
+ *
+ * Against the failing stub in mpsse_stub.c every job finishes as soon as its
+ * worker starts, so the callback races i2c_async_submit for the operation. Each
+ * callback calls i2c_async_free on the handle submit returned; built with
+ * -fsanitize=address (or run under valgrind) any access to the freed operation
+ * is reported. Exit status is 0 only if every job completed with the expected
+ * status and every callback ran exactly once.
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "i2c_transfer.h"
+#include "thread_compat.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_ITERATIONS  2000
+#define JOB_TIMEOUT_MS      5000
+#define STUB_FT_IO_ERROR    4       // What every mpsse_stub call returns
+
+typedef struct {
+	I2cAsyncOp* op;             // Written by i2c_async_submit before the worker starts
+	int status;
+	int calls;
+	thread_mutex_t lock;
+	thread_cond_t changed;
+} CallbackState;
+
+static void free_on_complete(ChannelJob* job, void* user_data) {
+	CallbackState* state = (CallbackState*)user_data;
+
+	i2c_async_free(state->op);
+
+	thread_mutex_lock(&state->lock);
+	state->status = job->status;
+	state->calls++;
+	thread_cond_broadcast(&state->changed);
+	thread_mutex_unlock(&state->lock);
+}
+
+// Submit one job whose callback frees it, wait for the callback, and check its status
+static int run_case(const char* name, I2cEepromDevice* dev, ChannelJob* job, int expected, uint32_t iterations) {
+	CallbackState state;
+	memset(&state, 0, sizeof(state));
+	thread_mutex_init(&state.lock);
+	thread_cond_init(&state.changed);
+
+	uint32_t failures = 0;
+
+	for (uint32_t i = 0; i < iterations; i++) {
+		thread_mutex_lock(&state.lock);
+		state.calls = 0;
+		state.status = XFER_OK;
+		thread_mutex_unlock(&state.lock);
+
+		int ret = i2c_async_submit(dev, job, 0, free_on_complete, &state, &state.op);
+		if (ret != XFER_OK) {
+			printf("%s: submit %u returned %d\n", name, i, ret);
+			failures++;
+			break;
+		}
+
+		thread_mutex_lock(&state.lock);
+		int timed_out = 0;
+		while (state.calls == 0 && !timed_out)
+			timed_out = thread_cond_timedwait(&state.changed, &state.lock, JOB_TIMEOUT_MS) != 0;
+		int calls = state.calls;
+		int status = state.status;
+		thread_mutex_unlock(&state.lock);
+
+		if (calls != 1 || status != expected) {
+			printf("%s: job %u ran its callback %d times with status %d (expected %d)\n",
+				   name, i, calls, status, expected);
+			failures++;
+			break;
+		}
+	}
+
+	thread_cond_destroy(&state.changed);
+	thread_mutex_destroy(&state.lock);
+
+	printf("%-28s %s\n", name, failures ? "FAILED" : "ok");
+	return failures == 0;
+}
+
+int main(int argc, char** argv) {
+	const char* stub_path = NULL;
+	uint32_t iterations = DEFAULT_ITERATIONS;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			iterations = (uint32_t)strtoul(argv[++i], NULL, 0);
+		else
+			stub_path = argv[i];
+	}
+
+	if (stub_path == NULL) {
+		fprintf(stderr, "Usage: %s <mpsse_stub library> [-n iterations]\n", argv[0]);
+		return 2;
+	}
+
+	int ret = i2c_transfer_load(stub_path);
+	if (ret != XFER_OK) {
+		fprintf(stderr, "Cannot load %s: %d\n", stub_path, ret);
+		return 2;
+	}
+
+	I2cEepromDevice dev;
+	i2c_eeprom_init(&dev, NULL, 0x50);
+	if (i2c_eeprom_set_geometry(&dev, eeprom_geometry_get(0)) != XFER_OK) {
+		fprintf(stderr, "No EEPROM geometry to test with\n");
+		return 2;
+	}
+
+	uint8_t buffer[64];
+	ChannelJob job;
+	int ok = 1;
+
+	// Rejected by the range check before any I2C traffic
+	memset(&job, 0, sizeof(job));
+	job.operations = MULTI_OP_READ;
+	job.start_addr = dev.capacity;
+	job.read_buffer = buffer;
+	job.length = sizeof(buffer);
+	ok &= run_case("out-of-range read", &dev, &job, XFER_ERROR_INVALID_ARG, iterations);
+
+	// The first libMPSSE call fails
+	job.start_addr = 0;
+	ok &= run_case("failing device read", &dev, &job, STUB_FT_IO_ERROR, iterations);
+
+	printf("%s\n", ok ? "PASSED" : "FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+/**
+ * thread_compat.h
+ *
+ * Minimal threading shim (Win32 threads or pthreads) used inside the DLL
+ * Internal header, not part of the DLL interface
+ */
+
+#ifndef THREAD_COMPAT_H
+#define THREAD_COMPAT_H
+
+#include <stdint.h>
+
+#ifdef _WIN32
+// Condition variables need Vista or later
+#if !defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600
+#undef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+typedef void (*thread_func_t)(void* arg);
+
+typedef struct {
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    thread_func_t func;
+    void* arg;
+} thread_t;
+
+#ifdef _WIN32
+typedef CRITICAL_SECTION thread_mutex_t;
+typedef CONDITION_VARIABLE thread_cond_t;
+#else
+typedef pthread_mutex_t thread_mutex_t;
+typedef pthread_cond_t thread_cond_t;
+#endif
+
+#ifdef _WIN32
+static DWORD WINAPI thread_trampoline(LPVOID param) {
+    thread_t* thread = (thread_t*)param;
+    thread->func(thread->arg);
+    return 0;
+}
+#else
+static void* thread_trampoline(void* param) {
+    thread_t* thread = (thread_t*)param;
+    thread->func(thread->arg);
+    return NULL;
+}
+#endif
+
+/**
+ * Start a thread running func(arg)
+ *
+ * @param thread: Thread object; must stay valid until thread_join returns or func, once detached, returns
+ * @return: 0 on success, -1 on failure
+ */
+static inline int thread_start(thread_t* thread, thread_func_t func, void* arg) {
+    thread->func = func;
+    thread->arg = arg;
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, thread_trampoline, thread, 0, NULL);
+    return (thread->handle != NULL) ? 0 : -1;
+#else
+    return (pthread_create(&thread->handle, NULL, thread_trampoline, thread) == 0) ? 0 : -1;
+#endif
+}
+
+static inline void thread_join(thread_t* thread) {
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+}
+
+// Nonzero when called on thread itself
+static inline int thread_is_current(const thread_t* thread) {
+#ifdef _WIN32
+    return GetThreadId(thread->handle) == GetCurrentThreadId();
+#else
+    return pthread_equal(thread->handle, pthread_self());
+#endif
+}
+
+// Release a thread without waiting for it; it must no longer use the thread object
+static inline void thread_detach(thread_t* thread) {
+#ifdef _WIN32
+    CloseHandle(thread->handle);
+#else
+    pthread_detach(thread->handle);
+#endif
+}
+
+static inline void thread_mutex_init(thread_mutex_t* mutex) {
+#ifdef _WIN32
+    InitializeCriticalSection(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+static inline void thread_mutex_destroy(thread_mutex_t* mutex) {
+#ifdef _WIN32
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+static inline void thread_mutex_lock(thread_mutex_t* mutex) {
+#ifdef _WIN32
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+static inline void thread_mutex_unlock(thread_mutex_t* mutex) {
+#ifdef _WIN32
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+static inline void thread_cond_init(thread_cond_t* cond) {
+#ifdef _WIN32
+    InitializeConditionVariable(cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+static inline void thread_cond_destroy(thread_cond_t* cond) {
+#ifdef _WIN32
+    (void)cond;  // Win32 condition variables need no cleanup
+#else
+    pthread_cond_destroy(cond);
+#endif
+}
+
+// Wait on cond; mutex must be held and is held again on return
+static inline void thread_cond_wait(thread_cond_t* cond, thread_mutex_t* mutex) {
+#ifdef _WIN32
+    SleepConditionVariableCS(cond, mutex, INFINITE);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+// Like thread_cond_wait, giving up after timeout_ms; returns 0 when woken, -1 on timeout
+static inline int thread_cond_timedwait(thread_cond_t* cond, thread_mutex_t* mutex, uint32_t timeout_ms) {
+#ifdef _WIN32
+    return SleepConditionVariableCS(cond, mutex, timeout_ms) ? 0 : -1;
+#else
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return (pthread_cond_timedwait(cond, mutex, &deadline) == 0) ? 0 : -1;
+#endif
+}
+
+static inline void thread_cond_broadcast(thread_cond_t* cond) {
+#ifdef _WIN32
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+static inline uint32_t thread_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (uint32_t)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (uint32_t)count : 1;
+#endif
+}
+
+#endif // THREAD_COMPAT_H
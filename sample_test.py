@@ -1,4 +1,4 @@
-from MaxUsbTool import MaxUsbTool
+from MaxUsbTool import MaxUsbTool, VERIFY_MISMATCH_STATUS
 import os
 
 def generate_eeprom_binary_from_txt(txt_file, custom_data_json=None, output_dir="."):
@@ -115,15 +115,13 @@ while 1:
 		confirm = input('Are you sure? Type YES to confirm: ').strip()
 		
 		if confirm == 'YES':
-			ret, bytes_written = maxUsbTool.write_eeprom_from_file(0x00, eeprom_file)
+			ret, bytes_written = maxUsbTool.write_eeprom_from_file(0x00, eeprom_file, verify=True)
 			
 			if ret == 0:
 				print(f'\n[OK] Successfully wrote {bytes_written} bytes to EEPROM')
-				
-				if maxUsbTool.verify_eeprom_write(0x00, eeprom_file):
-					print('\n[SUCCESS] EEPROM write and verification completed successfully!')
-				else:
-					print('\n[ERROR] Verification failed. EEPROM data does not match file.')
+				print('\n[SUCCESS] EEPROM write and verification completed successfully!')
+			elif ret == VERIFY_MISMATCH_STATUS:
+				print('\n[ERROR] Verification failed. EEPROM data does not match file.')
 			else:
 				print('\n[ERROR] Write failed.')
 		else: